@@ -0,0 +1,158 @@
+/** \file CompressedColumn.cxx
+    \brief Implementation of CompressedColumn class.
+*/
+#include <cstring>
+#include <stdexcept>
+
+#include "st_graph/CompressedSequence.h"
+
+namespace {
+
+  const std::uint64_t s_sign_bit = std::uint64_t(1) << 63;
+
+  // Return the number of bits needed to represent the given value.
+  unsigned int bitWidth(std::uint64_t value) {
+    unsigned int width = 0;
+    for (; 0 != value; value >>= 1) ++width;
+    return width;
+  }
+
+}
+
+namespace st_graph {
+
+  CompressedColumn::CompressedColumn(): m_data(new Data) {}
+
+  CompressedColumn::CompressedColumn(const std::vector<double> & data): m_data() {
+    *this = CompressedColumn(data.begin(), data.end());
+  }
+
+  CompressedColumn::size_type CompressedColumn::getMemoryUsage() const {
+    return sizeof(CompressedColumn) + sizeof(Data) + m_data->m_block.capacity() * sizeof(Block) +
+      m_data->m_word.capacity() * sizeof(std::uint64_t);
+  }
+
+  double CompressedColumn::operator [](size_type index) const {
+    const Block & block(m_data->m_block[index / s_block_size]);
+    std::uint64_t key = block.m_base;
+    size_type num_deltas = index % s_block_size;
+    if (0 == block.m_width) return fromKey(key + num_deltas * block.m_min_delta);
+    const std::uint64_t * word = &m_data->m_word[block.m_word];
+    const std::uint64_t mask = 64 == block.m_width ? ~std::uint64_t(0) : (std::uint64_t(1) << block.m_width) - 1;
+    for (size_type bit = 0; 0 != num_deltas; --num_deltas, bit += block.m_width) {
+      size_type word_index = bit / 64;
+      unsigned int shift = bit % 64;
+      std::uint64_t delta = word[word_index] >> shift;
+      if (64 < shift + block.m_width) delta |= word[word_index + 1] << (64 - shift);
+      key += block.m_min_delta + (delta & mask);
+    }
+    return fromKey(key);
+  }
+
+  CompressedColumn::size_type CompressedColumn::decodeBlock(size_type block_index, double * out) const {
+    const Block & block(m_data->m_block[block_index]);
+    size_type count = s_block_size * (block_index + 1) <= m_data->m_size ? s_block_size :
+      m_data->m_size - s_block_size * block_index;
+    std::uint64_t key = block.m_base;
+    out[0] = fromKey(key);
+    if (0 == block.m_width) {
+      // All differences are equal, so nothing was packed.
+      for (size_type ii = 1; ii != count; ++ii) out[ii] = fromKey(key += block.m_min_delta);
+    } else {
+      const std::uint64_t * word = &m_data->m_word[block.m_word];
+      const unsigned int width = block.m_width;
+      const std::uint64_t mask = 64 == width ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+      size_type bit = 0;
+      for (size_type ii = 1; ii != count; ++ii, bit += width) {
+        size_type word_index = bit / 64;
+        unsigned int shift = bit % 64;
+        std::uint64_t delta = word[word_index] >> shift;
+        if (64 < shift + width) delta |= word[word_index + 1] << (64 - shift);
+        key += block.m_min_delta + (delta & mask);
+        out[ii] = fromKey(key);
+      }
+    }
+    return count;
+  }
+
+  void CompressedColumn::decode(size_type offset, size_type count, double * out) const {
+    if (offset > size() || count > size() - offset)
+      throw std::out_of_range("CompressedColumn::decode: range extends past the end of the column");
+    double buffer[s_block_size];
+    for (size_type index = offset, end = offset + count; index != end; ) {
+      size_type block = index / s_block_size;
+      size_type begin = block * s_block_size;
+      size_type block_end = begin + s_block_size < end ? begin + s_block_size : end;
+      if (begin == index && block_end - begin == s_block_size) {
+        // Whole blocks are decoded straight into the output.
+        decodeBlock(block, out);
+      } else {
+        decodeBlock(block, buffer);
+        std::memcpy(out, buffer + (index - begin), (block_end - index) * sizeof(double));
+      }
+      out += block_end - index;
+      index = block_end;
+    }
+  }
+
+  std::uint64_t CompressedColumn::toKey(double value) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    // Negative doubles are ordered in reverse by their bit patterns, and below all positive ones.
+    return 0 != (bits & s_sign_bit) ? ~bits : bits | s_sign_bit;
+  }
+
+  double CompressedColumn::fromKey(std::uint64_t key) {
+    std::uint64_t bits = 0 != (key & s_sign_bit) ? key & ~s_sign_bit : ~key;
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  void CompressedColumn::appendBlock(Data & data, const double * value, size_type count) {
+    if (0 == count) return;
+
+    // Compute the differences between successive keys, checking that they increase.
+    std::uint64_t key[s_block_size];
+    for (size_type ii = 0; ii != count; ++ii) {
+      if (value[ii] != value[ii]) throw std::logic_error("CompressedColumn: data contain NaN");
+      key[ii] = toKey(value[ii]);
+    }
+    if (0 != data.m_size && key[0] < data.m_last_key)
+      throw std::logic_error("CompressedColumn: data are not monotone non-decreasing");
+    std::uint64_t min_delta = ~std::uint64_t(0);
+    std::uint64_t max_delta = 0;
+    for (size_type ii = 1; ii != count; ++ii) {
+      if (key[ii] < key[ii - 1]) throw std::logic_error("CompressedColumn: data are not monotone non-decreasing");
+      std::uint64_t delta = key[ii] - key[ii - 1];
+      if (delta < min_delta) min_delta = delta;
+      if (delta > max_delta) max_delta = delta;
+    }
+    if (1 == count) min_delta = max_delta = 0;
+
+    Block block;
+    block.m_base = key[0];
+    block.m_min_delta = min_delta;
+    block.m_word = data.m_word.size();
+    block.m_width = bitWidth(max_delta - min_delta);
+
+    // Pack the differences relative to the smallest one.
+    if (0 != block.m_width) {
+      data.m_word.resize(block.m_word + ((count - 1) * block.m_width + 63) / 64, 0);
+      std::uint64_t * word = &data.m_word[block.m_word];
+      size_type bit = 0;
+      for (size_type ii = 1; ii != count; ++ii, bit += block.m_width) {
+        std::uint64_t delta = key[ii] - key[ii - 1] - min_delta;
+        size_type word_index = bit / 64;
+        unsigned int shift = bit % 64;
+        word[word_index] |= delta << shift;
+        if (64 < shift + block.m_width) word[word_index + 1] |= delta >> (64 - shift);
+      }
+    }
+
+    data.m_block.push_back(block);
+    data.m_size += count;
+    data.m_last_key = key[count - 1];
+  }
+
+}
@@ -0,0 +1,371 @@
+/** \file DecimatedSequence.cxx
+    \brief Implementation of DecimatedSequence class.
+*/
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+#include "st_graph/DecimatedSequence.h"
+#include "st_graph/ThreadPool.h"
+
+namespace {
+
+  using namespace st_graph;
+
+  typedef ISequence::size_type size_type;
+
+  // Marks a bucket slot which holds no selected element.
+  const size_type s_none = size_type(-1);
+
+  // Pairs are decimated for display when they have more than this many points per pixel.
+  const size_type s_points_per_pixel = 10;
+
+  // Return the index of the first element of the given bucket, when num_points elements starting at first are split
+  // into num_buckets buckets of (nearly) equal count. Integer arithmetic keeps the boundaries exact.
+  size_type bucketBegin(size_type first, size_type num_points, size_type num_buckets, size_type bucket) {
+    return first + static_cast<size_type>((unsigned long long)(bucket) * num_points / num_buckets);
+  }
+
+  // ThreadPool task which calls task(begin, end) for the index-th of num_parts contiguous sub-ranges of [0, num_items).
+  template <typename Task_t>
+  class RangeTask : public ThreadPool::ITask {
+    public:
+      RangeTask(size_type num_items, size_type num_parts, const Task_t & task): m_num_items(num_items),
+        m_num_parts(num_parts), m_task(task) {}
+
+      virtual void operator ()(ThreadPool::size_type index) const {
+        m_task(bucketBegin(0, m_num_items, m_num_parts, index), bucketBegin(0, m_num_items, m_num_parts, index + 1));
+      }
+
+    private:
+      size_type m_num_items;
+      size_type m_num_parts;
+      const Task_t & m_task;
+  };
+
+  // Call task(begin, end) for num_parts contiguous sub-ranges of [0, num_items) on the shared thread pool, and wait
+  // for all of them to finish.
+  template <typename Task_t>
+  void runInThreads(unsigned int num_parts, size_type num_items, const Task_t & task) {
+    if (num_parts > num_items) num_parts = num_items;
+    if (2 > num_parts) {
+      task(0, num_items);
+      return;
+    }
+    ThreadPool::instance().run(num_parts, RangeTask<Task_t>(num_items, num_parts, task));
+  }
+
+  // Find the elements with the smallest and largest finite y value in each of a range of buckets, and store their
+  // indices in the two slots of each bucket, in increasing order.
+  class MinMaxTask {
+    public:
+      MinMaxTask(const double * y, size_type num_points, size_type num_buckets, size_type * slot): m_y(y),
+        m_num_points(num_points), m_num_buckets(num_buckets), m_slot(slot) {}
+
+      void operator ()(size_type begin, size_type end) const {
+        for (size_type bucket = begin; bucket != end; ++bucket) {
+          size_type min_index = s_none;
+          size_type max_index = s_none;
+          size_type last = bucketBegin(0, m_num_points, m_num_buckets, bucket + 1);
+          for (size_type ii = bucketBegin(0, m_num_points, m_num_buckets, bucket); ii != last; ++ii) {
+            if (!std::isfinite(m_y[ii])) continue;
+            if (s_none == min_index || m_y[ii] < m_y[min_index]) min_index = ii;
+            if (s_none == max_index || m_y[ii] > m_y[max_index]) max_index = ii;
+          }
+          m_slot[2 * bucket] = std::min(min_index, max_index);
+          m_slot[2 * bucket + 1] = min_index == max_index ? s_none : std::max(min_index, max_index);
+        }
+      }
+
+    private:
+      const double * m_y;
+      size_type m_num_points;
+      size_type m_num_buckets;
+      size_type * m_slot;
+  };
+
+  // Compute the average position of the finite points in each of a range of buckets. Buckets with no finite points
+  // have an average of NaN.
+  class AverageTask {
+    public:
+      AverageTask(const double * x, const double * y, size_type first, size_type num_points, size_type num_buckets,
+        double * avg_x, double * avg_y): m_x(x), m_y(y), m_first(first), m_num_points(num_points),
+        m_num_buckets(num_buckets), m_avg_x(avg_x), m_avg_y(avg_y) {}
+
+      void operator ()(size_type begin, size_type end) const {
+        for (size_type bucket = begin; bucket != end; ++bucket) {
+          double sum_x = 0.;
+          double sum_y = 0.;
+          size_type count = 0;
+          size_type last = bucketBegin(m_first, m_num_points, m_num_buckets, bucket + 1);
+          for (size_type ii = bucketBegin(m_first, m_num_points, m_num_buckets, bucket); ii != last; ++ii) {
+            if (!std::isfinite(m_x[ii]) || !std::isfinite(m_y[ii])) continue;
+            sum_x += m_x[ii];
+            sum_y += m_y[ii];
+            ++count;
+          }
+          m_avg_x[bucket] = 0 != count ? sum_x / count : std::numeric_limits<double>::quiet_NaN();
+          m_avg_y[bucket] = 0 != count ? sum_y / count : std::numeric_limits<double>::quiet_NaN();
+        }
+      }
+
+    private:
+      const double * m_x;
+      const double * m_y;
+      size_type m_first;
+      size_type m_num_points;
+      size_type m_num_buckets;
+      double * m_avg_x;
+      double * m_avg_y;
+  };
+
+  // The elements with the smallest and largest finite y value among a run of elements in the same pixel column.
+  struct ColumnExtent {
+    size_type column;
+    size_type min_index;
+    size_type max_index;
+  };
+
+  // Find the extent of each run of elements in the same pixel column in each of a range of parts of (nearly) equal
+  // count of a pair of sequences, in order. Elements whose x or y value is not finite lie in no column. When x is in
+  // non-decreasing order, each part holds at most one run per column.
+  class PixelColumnTask {
+    public:
+      PixelColumnTask(const double * x, const double * y, size_type num_points, double x_min, double scale,
+        size_type num_columns, size_type num_parts, std::vector<ColumnExtent> * extent): m_x(x), m_y(y),
+        m_num_points(num_points), m_x_min(x_min), m_scale(scale), m_num_columns(num_columns), m_num_parts(num_parts),
+        m_extent(extent) {}
+
+      void operator ()(size_type begin, size_type end) const {
+        for (size_type part = begin; part != end; ++part) {
+          std::vector<ColumnExtent> & extent(m_extent[part]);
+          size_type last = bucketBegin(0, m_num_points, m_num_parts, part + 1);
+          for (size_type ii = bucketBegin(0, m_num_points, m_num_parts, part); ii != last; ++ii) {
+            if (!std::isfinite(m_x[ii]) || !std::isfinite(m_y[ii])) continue;
+            double position = (m_x[ii] - m_x_min) * m_scale;
+            if (position > m_num_columns - 1.) position = m_num_columns - 1.;
+            size_type column = 0. < position ? static_cast<size_type>(position) : 0;
+            if (extent.empty() || extent.back().column != column) {
+              ColumnExtent run = { column, ii, ii };
+              extent.push_back(run);
+            } else {
+              ColumnExtent & run(extent.back());
+              if (m_y[ii] < m_y[run.min_index]) run.min_index = ii;
+              if (m_y[ii] > m_y[run.max_index]) run.max_index = ii;
+            }
+          }
+        }
+      }
+
+    private:
+      const double * m_x;
+      const double * m_y;
+      size_type m_num_points;
+      double m_x_min;
+      double m_scale;
+      size_type m_num_columns;
+      size_type m_num_parts;
+      std::vector<ColumnExtent> * m_extent;
+  };
+
+  void selectPixelColumns(const double * x, const double * y, size_type num_points, double x_min, double x_max,
+    size_type num_columns, std::vector<size_type> & selected, unsigned int num_threads) {
+    double scale = x_max > x_min ? num_columns / (x_max - x_min) : 0.;
+    size_type num_parts = std::max(1u, num_threads);
+    std::vector<std::vector<ColumnExtent> > extent(num_parts);
+    runInThreads(num_parts, num_parts, PixelColumnTask(x, y, num_points, x_min, scale, num_columns, num_parts,
+      &extent[0]));
+
+    // Runs of the same column which were split between parts are joined. Ties go to the earlier element, as they
+    // do within a part, so the selection does not depend on the number of parts.
+    std::vector<ColumnExtent> merged;
+    for (size_type part = 0; part != num_parts; ++part) {
+      for (std::vector<ColumnExtent>::const_iterator itor = extent[part].begin(); itor != extent[part].end(); ++itor) {
+        if (merged.empty() || merged.back().column != itor->column) {
+          merged.push_back(*itor);
+        } else {
+          ColumnExtent & run(merged.back());
+          if (y[itor->min_index] < y[run.min_index]) run.min_index = itor->min_index;
+          if (y[itor->max_index] > y[run.max_index]) run.max_index = itor->max_index;
+        }
+      }
+    }
+    for (std::vector<ColumnExtent>::const_iterator itor = merged.begin(); itor != merged.end(); ++itor) {
+      selected.push_back(std::min(itor->min_index, itor->max_index));
+      if (itor->min_index != itor->max_index) selected.push_back(std::max(itor->min_index, itor->max_index));
+    }
+  }
+
+  void selectMinMax(const double * y, size_type num_points, size_type max_points, std::vector<size_type> & selected,
+    unsigned int num_threads) {
+    size_type num_buckets = max_points / 2;
+    std::vector<size_type> slot(2 * num_buckets);
+    runInThreads(num_threads, num_buckets, MinMaxTask(y, num_points, num_buckets, &slot[0]));
+    for (std::vector<size_type>::iterator itor = slot.begin(); itor != slot.end(); ++itor) {
+      if (s_none != *itor) selected.push_back(*itor);
+    }
+  }
+
+  void selectLargestTriangle(const double * x, const double * y, size_type num_points, size_type max_points,
+    std::vector<size_type> & selected, unsigned int num_threads) {
+    // The first and last finite points are always selected.
+    size_type first = 0;
+    while (first != num_points && (!std::isfinite(x[first]) || !std::isfinite(y[first]))) ++first;
+    if (num_points == first) return;
+    size_type last = num_points - 1;
+    while (!std::isfinite(x[last]) || !std::isfinite(y[last])) --last;
+
+    // Points between the first and last are split into buckets, from each of which one point is selected.
+    size_type num_inner = last > first ? last - first - 1 : 0;
+    size_type num_buckets = max_points - 2;
+    if (num_inner <= num_buckets) {
+      for (size_type ii = first; ii <= last; ++ii) {
+        if (std::isfinite(x[ii]) && std::isfinite(y[ii])) selected.push_back(ii);
+      }
+      return;
+    }
+
+    std::vector<double> avg_x(num_buckets);
+    std::vector<double> avg_y(num_buckets);
+    if (0 != num_buckets)
+      runInThreads(num_threads, num_buckets, AverageTask(x, y, first + 1, num_inner, num_buckets, &avg_x[0], &avg_y[0]));
+
+    // Each selection depends on the previous one, so this loop is sequential.
+    selected.push_back(first);
+    size_type prev = first;
+    for (size_type bucket = 0; bucket != num_buckets; ++bucket) {
+      // The third vertex of the triangle is the average of the next bucket, or the last point after the last bucket.
+      double next_x = x[last];
+      double next_y = y[last];
+      if (bucket + 1 != num_buckets && std::isfinite(avg_x[bucket + 1])) {
+        next_x = avg_x[bucket + 1];
+        next_y = avg_y[bucket + 1];
+      }
+      size_type best = s_none;
+      double best_area = -1.;
+      size_type end = bucketBegin(first + 1, num_inner, num_buckets, bucket + 1);
+      for (size_type ii = bucketBegin(first + 1, num_inner, num_buckets, bucket); ii != end; ++ii) {
+        if (!std::isfinite(x[ii]) || !std::isfinite(y[ii])) continue;
+        // Twice the area of the triangle; the factor does not affect the comparison.
+        double area = std::fabs((x[prev] - next_x) * (y[ii] - y[prev]) - (x[prev] - x[ii]) * (next_y - y[prev]));
+        if (area > best_area) {
+          best_area = area;
+          best = ii;
+        }
+      }
+      if (s_none != best) {
+        selected.push_back(best);
+        prev = best;
+      }
+    }
+    selected.push_back(last);
+  }
+
+}
+
+namespace st_graph {
+
+  void DecimatedSequence::selectElements(const ISequence & x, const ISequence & y, size_type max_points, Mode_e mode,
+    std::vector<size_type> & selected, unsigned int num_threads) {
+    if (x.size() != y.size())
+      throw std::logic_error("DecimatedSequence::selectElements: x and y sequences do not have the same size");
+    if (2 > max_points) throw std::logic_error("DecimatedSequence::selectElements: cannot select fewer than 2 points");
+
+    selected.clear();
+    size_type num_points = y.size();
+    if (num_points <= max_points) {
+      for (size_type ii = 0; ii != num_points; ++ii) selected.push_back(ii);
+      return;
+    }
+
+    // Extract values once, reading them in place where possible, so that the threads only read memory.
+    std::vector<double> y_buf;
+    const double * y_val = y.getValueData(y_buf);
+    if (eMinMax == mode) {
+      selectMinMax(y_val, num_points, max_points, selected, num_threads);
+    } else {
+      std::vector<double> x_buf;
+      const double * x_val = x.getValueData(x_buf);
+      selectLargestTriangle(x_val, y_val, num_points, max_points, selected, num_threads);
+    }
+  }
+
+  bool DecimatedSequence::selectForDisplay(const ISequence & x, const ISequence & y, size_type num_pixels,
+    std::vector<size_type> & selected) {
+    if (x.size() != y.size())
+      throw std::logic_error("DecimatedSequence::selectForDisplay: x and y sequences do not have the same size");
+    if (0 == num_pixels || x.size() <= s_points_per_pixel * num_pixels) return false;
+    SequenceStatistics x_stats(x.getStatistics());
+    if (!x_stats.isNonDecreasing() || 0 == x_stats.getNumFinite()) return false;
+
+    // Two points per pixel column, found from the cached range of x, draw the vertical extent of the data in that
+    // column, however unevenly the points are spread along the x axis.
+    selected.clear();
+    std::vector<double> x_buf;
+    std::vector<double> y_buf;
+    selectPixelColumns(x.getValueData(x_buf), y.getValueData(y_buf), x.size(), x_stats.getMinValue(),
+      x_stats.getMaxValue(), num_pixels, selected, ThreadPool::instance().getNumThreads());
+    return true;
+  }
+
+  DecimatedSequence::DecimatedSequence(const ISequence & source, const std::vector<size_type> & selected):
+    ISequence(selected.size()), m_source(source.clone()), m_selected(new std::vector<size_type>(selected)) {
+    for (std::vector<size_type>::const_iterator itor = selected.begin(); itor != selected.end(); ++itor) {
+      if (*itor >= source.size())
+        throw std::out_of_range("DecimatedSequence: selected element is past the end of the source sequence");
+    }
+  }
+
+  void DecimatedSequence::getValues(std::vector<double> & val) const {
+    val.resize(size());
+    if (!val.empty()) getRange(0, size(), &val[0], 0, 0, 0, 0);
+  }
+
+  void DecimatedSequence::getIntervals(std::vector<double> & lower, std::vector<double> & upper) const {
+    lower.resize(size());
+    upper.resize(size());
+    if (!lower.empty()) getRange(0, size(), 0, &lower[0], &upper[0], 0, 0);
+  }
+
+  void DecimatedSequence::getSpreads(std::vector<double> & lower, std::vector<double> & upper) const {
+    lower.resize(size());
+    upper.resize(size());
+    if (!lower.empty()) getRange(0, size(), 0, 0, 0, &lower[0], &upper[0]);
+  }
+
+  void DecimatedSequence::fillRange(size_type offset, size_type count, double * out_val, double * out_low,
+    double * out_high, double * out_low_spread, double * out_high_spread) const {
+    const std::vector<size_type> & selected(*m_selected);
+    if (!m_source->hasEfficientRanges()) {
+      // Each run would extract the whole source, so extract the requested columns of the source once and gather
+      // the selected elements from them.
+      double * out[] = { out_val, out_low, out_high, out_low_spread, out_high_spread };
+      const SequenceColumns::Column_e column[] = { SequenceColumns::eValue, SequenceColumns::eLowerBound,
+        SequenceColumns::eUpperBound, SequenceColumns::eLowerSpread, SequenceColumns::eUpperSpread };
+      unsigned int mask = 0;
+      for (int ii = 0; ii != 5; ++ii) if (0 != out[ii]) mask |= column[ii];
+      SequenceColumns columns;
+      m_source->getColumnData(mask, columns);
+      for (int ii = 0; ii != 5; ++ii) {
+        if (0 == out[ii]) continue;
+        const double * in = columns.data(column[ii]);
+        for (size_type jj = 0; jj != count; ++jj) out[ii][jj] = in[selected[offset + jj]];
+      }
+      return;
+    }
+
+    // Runs of consecutive selected elements are extracted from the source together, directly into the output.
+    for (size_type done = 0; done != count; ) {
+      size_type first = selected[offset + done];
+      size_type run = 1;
+      while (done + run != count && selected[offset + done + run] == first + run) ++run;
+      m_source->getRange(first, run, 0 != out_val ? out_val + done : 0, 0 != out_low ? out_low + done : 0,
+        0 != out_high ? out_high + done : 0, 0 != out_low_spread ? out_low_spread + done : 0,
+        0 != out_high_spread ? out_high_spread + done : 0);
+      done += run;
+    }
+  }
+
+}
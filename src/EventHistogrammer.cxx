@@ -0,0 +1,472 @@
+/** \file EventHistogrammer.cxx
+    \brief Implementation of EventHistogrammer and EventHistogrammer2D classes.
+*/
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "st_graph/EventHistogrammer.h"
+#include "st_graph/ThreadPool.h"
+
+namespace {
+
+  using namespace st_graph;
+
+  typedef EventHistogrammer::size_type size_type;
+
+  // Number of events binned at a time into a buffer of bin numbers.
+  const size_type s_block_size = 512;
+
+  // Event arrays are split into slices of at least this many events, and only if they have at least
+  // s_parallel_threshold events.
+  const size_type s_slice_size = 65536;
+  const size_type s_parallel_threshold = 262144;
+
+  // Limits on the number of slices, and on the total number of private bins of all slices.
+  const size_type s_max_slices = 64;
+  const size_type s_max_private_bins = size_type(1) << 24;
+
+  // Number of bins added together by each task of the reduction.
+  const size_type s_tile_size = 4096;
+
+  // Grids with more than this many cells are split into tiles of whole x rows with no more cells than this, small
+  // enough to stay in cache, and are counted one tile per task instead of into private grids.
+  const size_type s_max_tile_cells = 65536;
+
+  // Number of events sorted by tile at a time when counting into tiles.
+  const size_type s_chunk_size = size_type(1) << 20;
+
+  // Return the first event of the given slice, when num_events events are split into num_slices slices.
+  size_type sliceBegin(size_type num_events, size_type num_slices, size_type slice) {
+    return static_cast<size_type>((unsigned long long)(slice) * num_events / num_slices);
+  }
+
+  // Return the number of slices into which to split num_events events, each with num_bins private bins. This depends
+  // only on its arguments, so that results do not depend on the number of threads.
+  size_type countSlices(size_type num_events, size_type num_bins) {
+    if (num_events < s_parallel_threshold) return 1;
+    size_type num_slices = num_events / s_slice_size;
+    if (s_max_slices < num_slices) num_slices = s_max_slices;
+    if (s_max_private_bins / num_bins < num_slices) num_slices = s_max_private_bins / num_bins;
+    return 0 != num_slices ? num_slices : 1;
+  }
+
+  // ThreadPool task which counts the events of one slice into the private bins of the slice. Each slice has one bin
+  // more than the histogram, which receives the events outside the bins, so that no event needs a test.
+  class CountTask : public ThreadPool::ITask {
+    public:
+      CountTask(const EventHistogrammer & hist, const double * event, size_type num_events, size_type num_slices,
+        unsigned long long * count): m_hist(hist), m_event(event), m_num_events(num_events), m_num_slices(num_slices),
+        m_count(count) {}
+
+      virtual void operator ()(ThreadPool::size_type index) const {
+        unsigned long long * count = m_count + index * (m_hist.getNumBins() + 1);
+        size_type bin[s_block_size];
+        size_type end = sliceBegin(m_num_events, m_num_slices, index + 1);
+        for (size_type begin = sliceBegin(m_num_events, m_num_slices, index); begin != end; ) {
+          size_type num = end - begin < s_block_size ? end - begin : s_block_size;
+          m_hist.findBins(m_event + begin, num, bin);
+          for (size_type ii = 0; ii != num; ++ii) ++count[bin[ii]];
+          begin += num;
+        }
+      }
+
+    private:
+      const EventHistogrammer & m_hist;
+      const double * m_event;
+      size_type m_num_events;
+      size_type m_num_slices;
+      unsigned long long * m_count;
+  };
+
+  // ThreadPool task which accumulates the weights of the events of one slice, and their squares, into the private
+  // bins of the slice. The two sums of each bin are adjacent, and the extra bin receives the events outside the bins.
+  class WeightTask : public ThreadPool::ITask {
+    public:
+      WeightTask(const EventHistogrammer & hist, const double * event, const double * weight, size_type num_events,
+        size_type num_slices, double * sum): m_hist(hist), m_event(event), m_weight(weight), m_num_events(num_events),
+        m_num_slices(num_slices), m_sum(sum) {}
+
+      virtual void operator ()(ThreadPool::size_type index) const {
+        double * sum = m_sum + 2 * index * (m_hist.getNumBins() + 1);
+        size_type bin[s_block_size];
+        size_type end = sliceBegin(m_num_events, m_num_slices, index + 1);
+        for (size_type begin = sliceBegin(m_num_events, m_num_slices, index); begin != end; ) {
+          size_type num = end - begin < s_block_size ? end - begin : s_block_size;
+          m_hist.findBins(m_event + begin, num, bin);
+          const double * weight = m_weight + begin;
+          for (size_type ii = 0; ii != num; ++ii) {
+            sum[2 * bin[ii]] += weight[ii];
+            sum[2 * bin[ii] + 1] += weight[ii] * weight[ii];
+          }
+          begin += num;
+        }
+      }
+
+    private:
+      const EventHistogrammer & m_hist;
+      const double * m_event;
+      const double * m_weight;
+      size_type m_num_events;
+      size_type m_num_slices;
+      double * m_sum;
+  };
+
+  // ThreadPool task which counts the events of one slice into the private grid of the slice, stored one x bin after
+  // another. As for CountTask, each grid has one extra cell, for events outside the bins.
+  class GridCountTask : public ThreadPool::ITask {
+    public:
+      GridCountTask(const EventHistogrammer2D & hist, const double * x, const double * y, size_type num_events,
+        size_type num_slices, unsigned long long * count): m_hist(hist), m_x(x), m_y(y), m_num_events(num_events),
+        m_num_slices(num_slices), m_count(count) {}
+
+      virtual void operator ()(ThreadPool::size_type index) const {
+        const size_type num_x_bins = m_hist.getXBins().getNumBins();
+        const size_type num_y_bins = m_hist.getYBins().getNumBins();
+        const size_type num_cells = num_x_bins * num_y_bins;
+        unsigned long long * count = m_count + index * (num_cells + 1);
+        size_type x_bin[s_block_size];
+        size_type y_bin[s_block_size];
+        size_type end = sliceBegin(m_num_events, m_num_slices, index + 1);
+        for (size_type begin = sliceBegin(m_num_events, m_num_slices, index); begin != end; ) {
+          size_type num = end - begin < s_block_size ? end - begin : s_block_size;
+          m_hist.getXBins().findBins(m_x + begin, num, x_bin);
+          m_hist.getYBins().findBins(m_y + begin, num, y_bin);
+          for (size_type ii = 0; ii != num; ++ii) {
+            bool outside = num_x_bins == x_bin[ii] || num_y_bins == y_bin[ii];
+            ++count[outside ? num_cells : x_bin[ii] * num_y_bins + y_bin[ii]];
+          }
+          begin += num;
+        }
+      }
+
+    private:
+      const EventHistogrammer2D & m_hist;
+      const double * m_x;
+      const double * m_y;
+      size_type m_num_events;
+      size_type m_num_slices;
+      unsigned long long * m_count;
+  };
+
+  // ThreadPool task which finds the cell of each event of one slice of a chunk of events, storing the number of cells
+  // for events outside the grid, and counts the events of the slice which fall in each tile of the grid.
+  class TileCellTask : public ThreadPool::ITask {
+    public:
+      TileCellTask(const EventHistogrammer2D & hist, const double * x, const double * y, size_type num_events,
+        size_type num_slices, size_type tile_cells, size_type num_tiles, size_type * cell, size_type * tile_count):
+        m_hist(hist), m_x(x), m_y(y), m_num_events(num_events), m_num_slices(num_slices), m_tile_cells(tile_cells),
+        m_num_tiles(num_tiles), m_cell(cell), m_tile_count(tile_count) {}
+
+      virtual void operator ()(ThreadPool::size_type index) const {
+        const size_type num_x_bins = m_hist.getXBins().getNumBins();
+        const size_type num_y_bins = m_hist.getYBins().getNumBins();
+        const size_type num_cells = num_x_bins * num_y_bins;
+        size_type * tile_count = m_tile_count + index * m_num_tiles;
+        size_type x_bin[s_block_size];
+        size_type y_bin[s_block_size];
+        size_type end = sliceBegin(m_num_events, m_num_slices, index + 1);
+        for (size_type begin = sliceBegin(m_num_events, m_num_slices, index); begin != end; ) {
+          size_type num = end - begin < s_block_size ? end - begin : s_block_size;
+          m_hist.getXBins().findBins(m_x + begin, num, x_bin);
+          m_hist.getYBins().findBins(m_y + begin, num, y_bin);
+          size_type * cell = m_cell + begin;
+          for (size_type ii = 0; ii != num; ++ii) {
+            if (num_x_bins == x_bin[ii] || num_y_bins == y_bin[ii]) {
+              cell[ii] = num_cells;
+            } else {
+              cell[ii] = x_bin[ii] * num_y_bins + y_bin[ii];
+              ++tile_count[cell[ii] / m_tile_cells];
+            }
+          }
+          begin += num;
+        }
+      }
+
+    private:
+      const EventHistogrammer2D & m_hist;
+      const double * m_x;
+      const double * m_y;
+      size_type m_num_events;
+      size_type m_num_slices;
+      size_type m_tile_cells;
+      size_type m_num_tiles;
+      size_type * m_cell;
+      size_type * m_tile_count;
+  };
+
+  // ThreadPool task which copies the cells of the events of one slice of a chunk, other than those outside the grid,
+  // to the part of the sorted array reserved for the slice in the tile containing each cell.
+  class TileSortTask : public ThreadPool::ITask {
+    public:
+      TileSortTask(const size_type * cell, size_type num_events, size_type num_slices, size_type num_cells,
+        size_type tile_cells, size_type num_tiles, size_type * position, size_type * sorted): m_cell(cell),
+        m_num_events(num_events), m_num_slices(num_slices), m_num_cells(num_cells), m_tile_cells(tile_cells),
+        m_num_tiles(num_tiles), m_position(position), m_sorted(sorted) {}
+
+      virtual void operator ()(ThreadPool::size_type index) const {
+        size_type * position = m_position + index * m_num_tiles;
+        size_type end = sliceBegin(m_num_events, m_num_slices, index + 1);
+        for (size_type ii = sliceBegin(m_num_events, m_num_slices, index); ii != end; ++ii) {
+          if (m_num_cells != m_cell[ii]) m_sorted[position[m_cell[ii] / m_tile_cells]++] = m_cell[ii];
+        }
+      }
+
+    private:
+      const size_type * m_cell;
+      size_type m_num_events;
+      size_type m_num_slices;
+      size_type m_num_cells;
+      size_type m_tile_cells;
+      size_type m_num_tiles;
+      size_type * m_position;
+      size_type * m_sorted;
+  };
+
+  // ThreadPool task which counts the sorted events of one tile into the grid. Tiles do not overlap, so tasks never
+  // write the same cell.
+  class TileCountTask : public ThreadPool::ITask {
+    public:
+      TileCountTask(const size_type * sorted, const size_type * tile_begin, double * out): m_sorted(sorted),
+        m_tile_begin(tile_begin), m_out(out) {}
+
+      virtual void operator ()(ThreadPool::size_type index) const {
+        for (size_type ii = m_tile_begin[index]; ii != m_tile_begin[index + 1]; ++ii) ++m_out[m_sorted[ii]];
+      }
+
+    private:
+      const size_type * m_sorted;
+      const size_type * m_tile_begin;
+      double * m_out;
+  };
+
+  // ThreadPool task which adds together the private bins of all slices for one tile of bins, in slice order.
+  class ReduceTask : public ThreadPool::ITask {
+    public:
+      ReduceTask(const unsigned long long * count, size_type num_bins, size_type num_slices, double * out):
+        m_count(count), m_num_bins(num_bins), m_num_slices(num_slices), m_out(out) {}
+
+      virtual void operator ()(ThreadPool::size_type index) const {
+        size_type begin = index * s_tile_size;
+        size_type end = m_num_bins - begin > s_tile_size ? begin + s_tile_size : m_num_bins;
+        for (size_type bin = begin; bin != end; ++bin) m_out[bin] = 0.;
+        for (size_type slice = 0; slice != m_num_slices; ++slice) {
+          const unsigned long long * count = m_count + slice * (m_num_bins + 1);
+          for (size_type bin = begin; bin != end; ++bin) m_out[bin] += count[bin];
+        }
+      }
+
+    private:
+      const unsigned long long * m_count;
+      size_type m_num_bins;
+      size_type m_num_slices;
+      double * m_out;
+  };
+
+
+  // ThreadPool task which adds together the private sums of weights of all slices for one tile of bins, in slice
+  // order, and takes the square root of the sums of squares.
+  class WeightReduceTask : public ThreadPool::ITask {
+    public:
+      WeightReduceTask(const double * sum, size_type num_bins, size_type num_slices, double * out_sum,
+        double * out_error): m_sum(sum), m_num_bins(num_bins), m_num_slices(num_slices), m_out_sum(out_sum),
+        m_out_error(out_error) {}
+
+      virtual void operator ()(ThreadPool::size_type index) const {
+        size_type begin = index * s_tile_size;
+        size_type end = m_num_bins - begin > s_tile_size ? begin + s_tile_size : m_num_bins;
+        for (size_type bin = begin; bin != end; ++bin) m_out_sum[bin] = m_out_error[bin] = 0.;
+        for (size_type slice = 0; slice != m_num_slices; ++slice) {
+          const double * sum = m_sum + 2 * slice * (m_num_bins + 1);
+          for (size_type bin = begin; bin != end; ++bin) {
+            m_out_sum[bin] += sum[2 * bin];
+            m_out_error[bin] += sum[2 * bin + 1];
+          }
+        }
+        for (size_type bin = begin; bin != end; ++bin) m_out_error[bin] = std::sqrt(m_out_error[bin]);
+      }
+
+    private:
+      const double * m_sum;
+      size_type m_num_bins;
+      size_type m_num_slices;
+      double * m_out_sum;
+      double * m_out_error;
+  };
+
+}
+
+namespace st_graph {
+
+  EventHistogrammer::EventHistogrammer(double low, double high, size_type num_bins): m_edges(), m_lower(), m_upper(),
+    m_low(low), m_high(high), m_inverse_width(0.), m_uniform(true) {
+    if (0 == num_bins) throw std::logic_error("EventHistogrammer: number of bins must not be 0");
+    if (!(low < high) || !std::isfinite(low) || !std::isfinite(high))
+      throw std::logic_error("EventHistogrammer: range of bins must be finite and increasing");
+    std::vector<double> edges(num_bins + 1);
+    double width = (high - low) / num_bins;
+    for (size_type ii = 0; ii != num_bins; ++ii) edges[ii] = low + ii * width;
+    edges[num_bins] = high;
+    m_inverse_width = num_bins / (high - low);
+    setEdges(edges);
+  }
+
+  EventHistogrammer::EventHistogrammer(const std::vector<double> & edges): m_edges(), m_lower(), m_upper(), m_low(0.),
+    m_high(0.), m_inverse_width(0.), m_uniform(false) {
+    if (2 > edges.size()) throw std::logic_error("EventHistogrammer: at least two bin edges are needed");
+    for (std::vector<double>::size_type ii = 0; ii != edges.size(); ++ii) {
+      if (!std::isfinite(edges[ii])) throw std::logic_error("EventHistogrammer: bin edges must be finite");
+      if (0 != ii && !(edges[ii - 1] < edges[ii]))
+        throw std::logic_error("EventHistogrammer: bin edges must be strictly increasing");
+    }
+    m_low = edges.front();
+    m_high = edges.back();
+    setEdges(edges);
+  }
+
+  EventHistogrammer::size_type EventHistogrammer::findBin(double event) const {
+    size_type bin = 0;
+    findBins(&event, 1, &bin);
+    return bin;
+  }
+
+  void EventHistogrammer::findBins(const double * event, size_type num_events, size_type * bin) const {
+    const size_type num_bins = getNumBins();
+    const double * edge = m_edges.begin();
+    if (m_uniform) {
+      for (size_type ii = 0; ii != num_events; ++ii) {
+        double value = event[ii];
+        // Comparisons fail for NaN, so it is never converted to an integer.
+        if (!(m_low <= value && value <= m_high)) {
+          bin[ii] = num_bins;
+          continue;
+        }
+        size_type index = static_cast<size_type>((value - m_low) * m_inverse_width);
+        if (num_bins <= index) index = num_bins - 1;
+        // Rounding may put values within an ulp of an edge in the neighboring bin. Correct it to agree with the edges.
+        if (value < edge[index]) --index;
+        else if (num_bins != index + 1 && edge[index + 1] <= value) ++index;
+        bin[ii] = index;
+      }
+    } else {
+      for (size_type ii = 0; ii != num_events; ++ii) {
+        double value = event[ii];
+        if (!(m_low <= value && value <= m_high)) {
+          bin[ii] = num_bins;
+          continue;
+        }
+        // Find the last lower edge not above the value. The step taken depends on the comparison only through
+        // arithmetic, so the loop has no branches which depend on the data.
+        const double * base = edge;
+        for (size_type length = num_bins; 1 < length; ) {
+          size_type half = length / 2;
+          base += half * size_type(base[half] <= value);
+          length -= half;
+        }
+        bin[ii] = base - edge;
+      }
+    }
+  }
+
+  SharedColumn EventHistogrammer::fill(const double * event, size_type num_events) const {
+    const size_type num_bins = getNumBins();
+    std::vector<double> out(num_bins, 0.);
+    size_type num_slices = countSlices(num_events, num_bins);
+    std::vector<unsigned long long> count(num_slices * (num_bins + 1), 0);
+    ThreadPool & pool(ThreadPool::instance());
+    pool.run(num_slices, CountTask(*this, event, num_events, num_slices, &count[0]));
+    pool.run((num_bins - 1) / s_tile_size + 1, ReduceTask(&count[0], num_bins, num_slices, &out[0]));
+    return SharedColumn(std::move(out));
+  }
+
+  OwningValueSpreadSequence EventHistogrammer::fillWeighted(const double * event, const double * weight,
+    size_type num_events) const {
+    const size_type num_bins = getNumBins();
+    std::vector<double> out_sum(num_bins, 0.);
+    std::vector<double> out_error(num_bins, 0.);
+    size_type num_slices = countSlices(num_events, 2 * num_bins);
+    std::vector<double> sum(2 * num_slices * (num_bins + 1), 0.);
+    ThreadPool & pool(ThreadPool::instance());
+    pool.run(num_slices, WeightTask(*this, event, weight, num_events, num_slices, &sum[0]));
+    pool.run((num_bins - 1) / s_tile_size + 1, WeightReduceTask(&sum[0], num_bins, num_slices, &out_sum[0],
+      &out_error[0]));
+    return OwningValueSpreadSequence(SharedColumn(std::move(out_sum)), SharedColumn(std::move(out_error)));
+  }
+
+  OwningValueSpreadSequence EventHistogrammer::fillWeighted(const std::vector<double> & event,
+    const std::vector<double> & weight) const {
+    if (event.size() != weight.size())
+      throw std::logic_error("EventHistogrammer::fillWeighted: events and weights have different sizes");
+    return fillWeighted(event.empty() ? 0 : &event[0], weight.empty() ? 0 : &weight[0], event.size());
+  }
+
+  void EventHistogrammer2D::fill(const double * x, const double * y, size_type num_events,
+    std::vector<std::vector<double> > & z) const {
+    const size_type num_x_bins = m_x_bins.getNumBins();
+    const size_type num_y_bins = m_y_bins.getNumBins();
+    const size_type num_cells = num_x_bins * num_y_bins;
+    std::vector<double> out(num_cells, 0.);
+    ThreadPool & pool(ThreadPool::instance());
+    if (num_cells <= s_max_tile_cells) {
+      // Small grids stay in cache, so each slice counts into a private grid.
+      size_type num_slices = countSlices(num_events, num_cells);
+      std::vector<unsigned long long> count(num_slices * (num_cells + 1), 0);
+      pool.run(num_slices, GridCountTask(*this, x, y, num_events, num_slices, &count[0]));
+      pool.run((num_cells - 1) / s_tile_size + 1, ReduceTask(&count[0], num_cells, num_slices, &out[0]));
+    } else {
+      // Large grids are split into tiles of whole x rows. Each chunk of events is sorted by tile, in parallel slices,
+      // after which each tile is counted by one task, so memory does not grow with the size of the grid and large
+      // grids are still counted in parallel. Counts are integers, so the order in which they are added is immaterial.
+      size_type rows_per_tile = num_y_bins < s_max_tile_cells ? s_max_tile_cells / num_y_bins : 1;
+      size_type tile_cells = rows_per_tile * num_y_bins;
+      size_type num_tiles = (num_cells - 1) / tile_cells + 1;
+      size_type chunk_size = num_events < s_chunk_size ? num_events : s_chunk_size;
+      std::vector<size_type> cell(chunk_size);
+      std::vector<size_type> sorted(chunk_size);
+      std::vector<size_type> tile_count;
+      std::vector<size_type> tile_begin(num_tiles + 1);
+      for (size_type begin = 0; begin != num_events; ) {
+        size_type num = num_events - begin < chunk_size ? num_events - begin : chunk_size;
+        size_type num_slices = 0 != num / s_slice_size ? num / s_slice_size : 1;
+        tile_count.assign(num_slices * num_tiles, 0);
+        pool.run(num_slices, TileCellTask(*this, x + begin, y + begin, num, num_slices, tile_cells, num_tiles, &cell[0],
+          &tile_count[0]));
+
+        // Replace the counts by the position of the first event of each slice in each tile, tile by tile.
+        size_type position = 0;
+        for (size_type tile = 0; tile != num_tiles; ++tile) {
+          tile_begin[tile] = position;
+          for (size_type slice = 0; slice != num_slices; ++slice) {
+            size_type num_in_tile = tile_count[slice * num_tiles + tile];
+            tile_count[slice * num_tiles + tile] = position;
+            position += num_in_tile;
+          }
+        }
+        tile_begin[num_tiles] = position;
+
+        pool.run(num_slices, TileSortTask(&cell[0], num, num_slices, num_cells, tile_cells, num_tiles, &tile_count[0],
+          &sorted[0]));
+        pool.run(num_tiles, TileCountTask(&sorted[0], &tile_begin[0], &out[0]));
+        begin += num;
+      }
+    }
+
+    z.resize(num_x_bins);
+    for (size_type ii = 0; ii != num_x_bins; ++ii)
+      z[ii].assign(out.begin() + ii * num_y_bins, out.begin() + (ii + 1) * num_y_bins);
+  }
+
+  void EventHistogrammer2D::fill(const std::vector<double> & x, const std::vector<double> & y,
+    std::vector<std::vector<double> > & z) const {
+    if (x.size() != y.size())
+      throw std::logic_error("EventHistogrammer2D::fill: coordinates of events have different sizes");
+    fill(x.empty() ? 0 : &x[0], y.empty() ? 0 : &y[0], x.size(), z);
+  }
+
+  void EventHistogrammer::setEdges(const std::vector<double> & edges) {
+    m_edges = SharedColumn(edges);
+    m_lower = SharedColumn(edges.begin(), edges.end() - 1);
+    m_upper = SharedColumn(edges.begin() + 1, edges.end());
+  }
+
+}
@@ -0,0 +1,190 @@
+/** \file FitsColumnSequence.cxx
+    \brief Implementation of FitsColumnSequence class.
+*/
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+#include "fitsio.h"
+
+#include "st_graph/FitsColumnSequence.h"
+
+namespace st_graph {
+
+  /** \class FitsTable
+      \brief An open binary table, with the positions of the columns read by a FitsColumnSequence. The table is shared
+             by all copies of a sequence, which may read it from different threads; reads are serialized by a mutex,
+             because cfitsio does not allow one open file to be used by several threads at once.
+  */
+  class FitsTable {
+    public:
+      typedef ISequence::size_type size_type;
+
+      FitsTable(const std::string & file_name, const std::string & ext_name, const std::string & value_column,
+        const std::string & error_column);
+
+      ~FitsTable();
+
+      size_type getNumRows() const { return m_num_rows; }
+
+      size_type getBlockSize() const { return m_block_size; }
+
+      bool hasErrorColumn() const { return 0 != m_error_col; }
+
+      /** \brief Read a block of rows of the value and error columns into caller-supplied buffers.
+          \param first_row The index of the first row to read, starting from 0.
+          \param count The number of rows to read.
+          \param value The output values, with room for count rows.
+          \param error The output errors, with room for count rows, or 0 if the errors are not needed.
+      */
+      void read(size_type first_row, size_type count, double * value, double * error);
+
+    private:
+      // Tables are shared by reference, never copied.
+      FitsTable(const FitsTable &);
+      FitsTable & operator =(const FitsTable &);
+
+      int findColumn(const std::string & column);
+      void readColumn(int col_num, size_type first_row, size_type count, double * buffer);
+      void checkStatus(int status, const std::string & context) const;
+
+      std::string m_file_name;
+      fitsfile * m_fptr;
+      int m_value_col;
+      int m_error_col;
+      size_type m_num_rows;
+      size_type m_block_size;
+      std::mutex m_mutex;
+  };
+
+  FitsTable::FitsTable(const std::string & file_name, const std::string & ext_name, const std::string & value_column,
+    const std::string & error_column): m_file_name(file_name), m_fptr(0), m_value_col(0), m_error_col(0),
+    m_num_rows(0), m_block_size(1), m_mutex() {
+    int status = 0;
+    fits_open_file(&m_fptr, file_name.c_str(), READONLY, &status);
+    checkStatus(status, "cannot open file");
+
+    try {
+      fits_movnam_hdu(m_fptr, BINARY_TBL, const_cast<char *>(ext_name.c_str()), 0, &status);
+      checkStatus(status, "cannot find binary table " + ext_name);
+
+      LONGLONG num_rows = 0;
+      fits_get_num_rowsll(m_fptr, &num_rows, &status);
+      checkStatus(status, "cannot get number of rows in table " + ext_name);
+      m_num_rows = num_rows;
+
+      m_value_col = findColumn(value_column);
+      if (!error_column.empty()) m_error_col = findColumn(error_column);
+
+      // Rows are read in blocks of the number cfitsio reads most efficiently at a time.
+      long block_size = 0;
+      fits_get_rowsize(m_fptr, &block_size, &status);
+      checkStatus(status, "cannot get optimal number of rows in table " + ext_name);
+      m_block_size = std::max(block_size, 1l);
+    } catch (...) {
+      status = 0;
+      fits_close_file(m_fptr, &status);
+      throw;
+    }
+  }
+
+  FitsTable::~FitsTable() {
+    int status = 0;
+    fits_close_file(m_fptr, &status);
+  }
+
+  void FitsTable::read(size_type first_row, size_type count, double * value, double * error) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    readColumn(m_value_col, first_row, count, value);
+    if (0 != error && 0 != m_error_col) readColumn(m_error_col, first_row, count, error);
+  }
+
+  int FitsTable::findColumn(const std::string & column) {
+    int status = 0;
+    int col_num = 0;
+    fits_get_colnum(m_fptr, CASEINSEN, const_cast<char *>(column.c_str()), &col_num, &status);
+    checkStatus(status, "cannot find column " + column);
+
+    // Each row must hold a single number, so that rows correspond one-to-one with sequence elements.
+    int type_code = 0;
+    LONGLONG repeat = 0;
+    LONGLONG width = 0;
+    fits_get_coltypell(m_fptr, col_num, &type_code, &repeat, &width, &status);
+    checkStatus(status, "cannot get type of column " + column);
+    if (TSTRING == type_code || TLOGICAL == type_code || TBIT == type_code || 1 != repeat)
+      throw std::runtime_error("FitsColumnSequence: column " + column + " in file " + m_file_name +
+        " does not hold one number per row");
+    return col_num;
+  }
+
+  void FitsTable::readColumn(int col_num, size_type first_row, size_type count, double * buffer) {
+    int status = 0;
+    int any_null = 0;
+    // FITS rows are numbered from 1. Undefined values, such as the TNULL value of an integer column, are returned as
+    // NaN, so that validity masks drop them rather than plotting them as numbers.
+    double null_value = std::numeric_limits<double>::quiet_NaN();
+    fits_read_col(m_fptr, TDOUBLE, col_num, first_row + 1, 1, count, &null_value, buffer, &any_null, &status);
+    checkStatus(status, "cannot read column");
+  }
+
+  void FitsTable::checkStatus(int status, const std::string & context) const {
+    if (0 != status) {
+      char err_text[FLEN_STATUS] = "";
+      fits_get_errstatus(status, err_text);
+      throw std::runtime_error("FitsColumnSequence: " + context + " in file " + m_file_name + ": " + err_text);
+    }
+  }
+
+  FitsColumnSequence::FitsColumnSequence(const std::string & file_name, const std::string & ext_name,
+    const std::string & value_column, const std::string & error_column):
+    FitsColumnSequence(std::shared_ptr<FitsTable>(new FitsTable(file_name, ext_name, value_column, error_column))) {}
+
+  FitsColumnSequence::FitsColumnSequence(const std::shared_ptr<FitsTable> & table): ISequence(table->getNumRows()),
+    m_table(table) {}
+
+  void FitsColumnSequence::getValues(std::vector<double> & val) const {
+    val.resize(size());
+    if (!val.empty()) getRange(0, size(), &val[0], 0, 0, 0, 0);
+  }
+
+  void FitsColumnSequence::getIntervals(std::vector<double> & lower, std::vector<double> & upper) const {
+    lower.resize(size());
+    upper.resize(size());
+    if (!lower.empty()) getRange(0, size(), 0, &lower[0], &upper[0], 0, 0);
+  }
+
+  void FitsColumnSequence::getSpreads(std::vector<double> & lower, std::vector<double> & upper) const {
+    lower.resize(size());
+    upper.resize(size());
+    if (!lower.empty()) getRange(0, size(), 0, 0, 0, &lower[0], &upper[0]);
+  }
+
+  FitsColumnSequence::size_type FitsColumnSequence::getBlockSize() const { return m_table->getBlockSize(); }
+
+  void FitsColumnSequence::fillRange(size_type offset, size_type count, double * out_val, double * out_low,
+    double * out_high, double * out_low_spread, double * out_high_spread) const {
+    // Each call reads into its own buffers, so that copies sharing the table may be used by different threads.
+    size_type block_size = std::min(m_table->getBlockSize(), count);
+    std::vector<double> value(block_size);
+    // The error column only affects the bounds and spreads, so it is not read when just the values are requested.
+    bool need_error = 0 != out_low || 0 != out_high || 0 != out_low_spread || 0 != out_high_spread;
+    std::vector<double> error(need_error && m_table->hasErrorColumn() ? block_size : 0);
+    for (size_type done = 0; done != count; ) {
+      // Read one block of rows, then derive all requested properties from it.
+      size_type num_rows = std::min(block_size, count - done);
+      m_table->read(offset + done, num_rows, &value[0], error.empty() ? 0 : &error[0]);
+      for (size_type ii = 0, jj = done; ii != num_rows; ++ii, ++jj) {
+        double val = value[ii];
+        double spread = error.empty() ? 0. : error[ii];
+        if (0 != out_val) out_val[jj] = val;
+        if (0 != out_low) out_low[jj] = val - spread;
+        if (0 != out_high) out_high[jj] = val + spread;
+        if (0 != out_low_spread) out_low_spread[jj] = spread;
+        if (0 != out_high_spread) out_high_spread[jj] = spread;
+      }
+      done += num_rows;
+    }
+  }
+
+}
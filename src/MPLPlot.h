@@ -56,6 +56,9 @@ namespace st_graph {
       /// \brief Get the sequences this plot represents.
       virtual const std::vector<const ISequence *> getSequences() const;
 
+      /// \brief Discard the results cached for the sequences this plot represents.
+      virtual void clearStatistics();
+
       /// \brief Get the data represented by this plot. If plot does not have this type of data an exception will be thrown.
       virtual const std::vector<std::vector<double> > & getZData() const;
 
@@ -122,6 +125,20 @@ namespace st_graph {
       */
       void setParent(MPLPlotFrame * parent);
 
+      /** \brief Discard the results cached for those sequences this plot represents whose data may have been modified
+                 in place since the last display, i.e. those for which ISequence::hasFixedData returns false, and the
+                 selection of elements to draw if it depends on any of them. Called by the frame before each display.
+      */
+      void clearStaleStatistics();
+
+      /** \brief Select the elements to draw across the given number of pixels, as described for
+                 DecimatedSequence::selectForDisplay. The selection is computed once for each width and cached until
+                 the sequences' statistics are cleared, so that redisplaying a plot of fixed data does not traverse its
+                 data. Returns 0 if the plot should be drawn in full.
+          \param num_pixels The width of the plot in pixels.
+      */
+      const std::vector<ISequence::size_type> * selectForDisplay(ISequence::size_type num_pixels);
+
     private:
       std::vector<const ISequence *> m_seq_cont;
       std::vector<Marker> m_label;
@@ -132,6 +149,10 @@ namespace st_graph {
       unsigned int m_dimensionality;
       MPLPlotFrame * m_parent;
       const std::vector<std::vector<double> > * m_z_data;
+      std::vector<ISequence::size_type> m_selected;
+      ISequence::size_type m_selected_width;
+      bool m_selection_cached;
+      bool m_decimated;
       bool m_delete_parent;
   };
 
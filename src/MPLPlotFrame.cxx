@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <limits>
 #include <list>
 #include <map>
 #include <sstream>
@@ -16,13 +17,14 @@
 #include "MPLPlot.h"
 #include "MPLPlotFrame.h"
 
+#include "st_graph/DecimatedSequence.h"
 #include "st_graph/IEventReceiver.h"
 
 namespace st_graph {
 
   MPLPlotFrame::MPLPlotFrame(IFrame * parent, const std::string & title, unsigned int width, unsigned int height,
     bool delete_parent): MPLFrame(parent, 0, 0, delete_parent), m_axes(3), m_plots(), m_graphs(), m_title(title), m_canvas(0),
-    m_multi_graph(0), m_th2d(Py_None), m_dimensionality(0) {
+    m_multi_graph(0), m_th2d(Py_None), m_dimensionality(0), m_width(width) {
 
     // Send event messages back to parent.
     m_receiver = m_parent->getReceiver();
@@ -103,6 +105,16 @@ namespace st_graph {
       if (1 < m_dimensionality) EP_CallMethod(axes,"set_yscale","(s)",(Axis::eLog == m_axes[1].getScaleMode() ? "log" : "linear"));
       if (2 < m_dimensionality) EP_CallMethod(axes,"set_zscale","(s)",(Axis::eLog == m_axes[1].getScaleMode() ? "log" : "linear"));
 
+      // Autoscaling includes data which cannot be shown on logarithmic axes, so limit those axes to the positive data.
+      if (2 == m_dimensionality) {
+        double lower = 0.;
+        double upper = 0.;
+        if (Axis::eLog == m_axes[0].getScaleMode() && getPositiveRange(0, lower, upper))
+          EP_CallMethod(axes,"set_xlim","(dd)",lower,upper);
+        if (Axis::eLog == m_axes[1].getScaleMode() && getPositiveRange(1, lower, upper))
+          EP_CallMethod(axes,"set_ylim","(dd)",lower,upper);
+      }
+
 //      EP_CallMethod(axes,"set_adjustable","(s)","datalim");
       EP_CallMethod(axes,"set_title","(s)",m_title.c_str());
       // Set axis labels
@@ -225,7 +237,13 @@ namespace st_graph {
   void MPLPlotFrame::display2d() {
 //	  std::cout << "display2D() for " << m_title << std::endl;
 
+    // Buffers used by the previous display are no longer needed; NumPy copied their contents.
+    m_buffer_pool.reset();
+
     for (std::list<MPLPlot *>::iterator itor = m_plots.begin(); itor != m_plots.end(); ++itor) {
+      // The client may have modified the data since the last display, so results cached for sequences which do not
+      // hold fixed data are stale.
+      (*itor)->clearStaleStatistics();
 
       // Get numeric sequences from data.
       const std::vector<const ISequence *> sequences((*itor)->getSequences());
@@ -243,10 +261,15 @@ namespace st_graph {
 
       // Depending on the style, create appropriate MPL plot object.
       PyObject * graph = 0;
-      if (style == "hist")
+      const std::vector<DecimatedSequence::size_type> * selected = 0;
+      if (style == "hist") {
         graph = createHistPlot(*x, *y, format);
-      else
+      } else if (0 != (selected = (*itor)->selectForDisplay(m_width))) {
+        // Far more points than pixels: draw only those which preserve the envelope of the data in each pixel column.
+        graph = createScatterPlot(DecimatedSequence(*x, *selected), DecimatedSequence(*y, *selected), format);
+      } else {
         graph = createScatterPlot(*x, *y, format);
+      }
 
       // Keep track of MPL object, so it can be deleted later.
       m_graphs.push_back(graph);
@@ -259,6 +282,7 @@ namespace st_graph {
 
     if (m_plots.empty()) return;
     std::list<MPLPlot *>::iterator itor = m_plots.begin();
+    (*itor)->clearStaleStatistics();
 
     // Get numeric sequences from data.
     const std::vector<const ISequence *> sequences((*itor)->getSequences());
@@ -275,78 +299,39 @@ namespace st_graph {
 
   }
 
+  bool MPLPlotFrame::getPositiveRange(unsigned int index, double & lower, double & upper) const {
+    lower = std::numeric_limits<double>::infinity();
+    upper = -std::numeric_limits<double>::infinity();
+    for (std::list<MPLPlot *>::const_iterator itor = m_plots.begin(); itor != m_plots.end(); ++itor) {
+      SequenceStatistics stats((*itor)->getSequences().at(index)->getStatistics());
+      if (1 == index && "hist" == (*itor)->getStyle()) {
+        lower = std::min(lower, stats.getMinPositiveValue());
+        upper = std::max(upper, stats.getMaxValue());
+      } else {
+        lower = std::min(lower, stats.getMinPositiveLower());
+        upper = std::max(upper, stats.getMaxUpper());
+      }
+    }
+    return lower < upper;
+  }
+
   PyObject * MPLPlotFrame::createHistPlot(const ISequence & x, const ISequence & y,std::string format) {
     PyObject * retval = 0;
 //	std::cout << "createHistPlot() for " << m_title << std::endl;
 
-    // Get arrays of values.
-    std::vector<double> x_low;
-    std::vector<double> x_high;
-    std::vector<double> y_value;
-
-    // Interpret x as a set of intervals.
-    x.getIntervals(x_low, x_high);
-
-    // Interpret y as the value in each interval.
-    y.getValues(y_value);
-
-    // Combine ranges and values into one array for axis and one array for the data; needed for TGraph.
-    std::vector<double> x_vals(x_low.size() * 4);
-    std::vector<double> y_vals(x_low.size() * 4);
-
-    // Use input arrays to create graphable data.
-    unsigned long idx = 0;
-    unsigned long ii = 0;
-
-#if 0
-    // First point plotted is at the base of the first bin.
-    x_vals[idx] = x_low[ii];
-    y_vals[idx] = 0.;
-
-    ++idx;
-#endif
-    for (ii = 0; ii < x_low.size(); ++ii, ++idx) {
-      // Plot the y value at the left edge.
-      x_vals[idx] = x_low[ii];
-      y_vals[idx] = y_value[ii];
-
-      // Next plot the y value at the right edge.
-      ++idx;
-      x_vals[idx] = x_high[ii];
-      y_vals[idx] = y_value[ii];
-
-      // Exclude the last bin, which requires special handling.
-      if (ii != x_low.size() - 1) {
-        // See if the next bin's left edge is > than the right edge which was just plotted.
-        double next = x_low[ii + 1];
-        if (next > x_vals[idx]) {
-          // There is a gap in the data, so plot a value of 0. in the gap.
-          ++idx;
-          x_vals[idx] = x_vals[idx - 1];
-          y_vals[idx] = 0.;
-          ++idx;
-          x_vals[idx] = next;
-          y_vals[idx] = 0.;
-        }
-#if 0
-      } else {
-        // Last input point is the last right edge, which should drop to 0.
-        ++idx;
-        x_vals[idx] = x_vals[idx - 1];
-        y_vals[idx] = 0.;
-#endif
-      }
-    }
+    // Combine ranges and values into one array for axis and one array for the data. Gaps between bins, and bins which
+    // are not finite, or not positive on logarithmic axes, are marked with NaN vertices, at which matplotlib breaks
+    // the line.
+    const double * x_vals = 0;
+    const double * y_vals = 0;
+    unsigned long num_vals = m_buffer_pool.createStepCurve(x, y, Axis::eLog == m_axes[0].getScaleMode(),
+      Axis::eLog == m_axes[1].getScaleMode(), x_vals, y_vals);
 
     // Create the graph.
     // You can't pass vectors as arguments in a variable length argument list (get Illegal Instruction error)
-    //    so lets make them into python lists
-    PyObject *pyX = PyList_New(0);
-    PyObject *pyY = PyList_New(0);
-    for (unsigned int i = 0; i < idx; ++i){
-    	PyList_Append(pyX,PyFloat_FromDouble(x_vals[i]));
-    	PyList_Append(pyY,PyFloat_FromDouble(y_vals[i]));
-    }
+    //    so lets make them into NumPy arrays
+    PyObject *pyX = createArray(x_vals, num_vals);
+    PyObject *pyY = createArray(y_vals, num_vals);
     // Set some formating keyword arguments
 	PyObject *kwargs = PyDict_New();
 	PyDict_SetItemString(kwargs,"linewidth",PyFloat_FromDouble(0.5));
@@ -365,42 +350,38 @@ namespace st_graph {
   PyObject * MPLPlotFrame::createScatterPlot(const ISequence & x, const ISequence & y,std::string format) {
     PyObject * retval = 0;
 //	std::cout << "createScatterPlot() for " << m_title << std::endl;
-    // Get arrays of values.
-    std::vector<double> x_pts;
-    std::vector<double> x_low_err;
-    std::vector<double> x_high_err;
-    std::vector<double> y_pts;
-    std::vector<double> y_low_err;
-    std::vector<double> y_high_err;
+    // Get arrays of values and spreads, each sequence in a single pass. Points which are not finite, or not positive
+    // on logarithmic axes, are dropped in bulk, so matplotlib never sees them.
+    const SequenceColumns * x_columns = 0;
+    const SequenceColumns * y_columns = 0;
+    unsigned long num_points = m_buffer_pool.createScatterColumns(x, y, Axis::eLog == m_axes[0].getScaleMode(),
+      Axis::eLog == m_axes[1].getScaleMode(), x_columns, y_columns);
 
-    x.getValues(x_pts);
-    x.getSpreads(x_low_err, x_high_err);
+    const double * x_pts = x_columns->data(SequenceColumns::eValue);
+    const double * x_low_err = x_columns->data(SequenceColumns::eLowerSpread);
+    const double * x_high_err = x_columns->data(SequenceColumns::eUpperSpread);
 
-    y.getValues(y_pts);
-    y.getSpreads(y_low_err, y_high_err);
-
-    // Create the graph.
-    // You can't pass vectors as arguments in a variable length argument list (get Illegal Instruction error)
-    //    so lets make them into python lists
-    PyObject *pX = PyList_New(0);
-    PyObject *pY = PyList_New(0);
-    PyObject *pXlow = PyList_New(0);
-    PyObject *pYlow = PyList_New(0);
-    PyObject *pXhigh = PyList_New(0);
-    PyObject *pYhigh = PyList_New(0);
+    const double * y_pts = y_columns->data(SequenceColumns::eValue);
+    const double * y_low_err = y_columns->data(SequenceColumns::eLowerSpread);
+    const double * y_high_err = y_columns->data(SequenceColumns::eUpperSpread);
 
     bool plotXErrors = false;
     bool plotYErrors = false;
-    for (unsigned int i = 0; i< x_pts.size(); ++i){
+    for (unsigned long i = 0; i < num_points; ++i){
     	if (0 != x_low_err[i] ) plotXErrors = true; // don't plot X error bars if the error values are all zero so we need to check
     	if (0 != y_low_err[i] ) plotYErrors = true; // don't plot Y error bars if the error values are all zero so we need to check
-    	PyList_Append(pX,PyFloat_FromDouble(x_pts[i]));
-    	PyList_Append(pY,PyFloat_FromDouble(y_pts[i]));
-    	PyList_Append(pXlow,PyFloat_FromDouble(x_low_err[i]));
-    	PyList_Append(pYlow,PyFloat_FromDouble(y_low_err[i]));
-    	PyList_Append(pXhigh,PyFloat_FromDouble(x_high_err[i]));
-    	PyList_Append(pYhigh,PyFloat_FromDouble(y_high_err[i]));
     }
+
+    // Create the graph.
+    // You can't pass vectors as arguments in a variable length argument list (get Illegal Instruction error)
+    //    so lets make them into NumPy arrays
+    PyObject *pX = createArray(x_pts, num_points);
+    PyObject *pY = createArray(y_pts, num_points);
+    PyObject *pXlow = createArray(x_low_err, num_points);
+    PyObject *pYlow = createArray(y_low_err, num_points);
+    PyObject *pXhigh = createArray(x_high_err, num_points);
+    PyObject *pYhigh = createArray(y_high_err, num_points);
+
     // Set some formating keyword arguments
 	PyObject *kwargs = PyDict_New();
 	PyDict_SetItemString(kwargs,"linewidth",PyFloat_FromDouble(0.5));
@@ -433,57 +414,35 @@ namespace st_graph {
   PyObject * MPLPlotFrame::createHistPlot2D(const std::string & root_name, const ISequence & x, const ISequence & y,
     const std::vector<std::vector<double> > & z) {
 
-    typedef std::vector<double> Vec_t;
 //	std::cout << "createHistPlot2D() for " << m_title << std::endl;
 
-    // Set up x bins. There is one extra for Root's upper cutoff.
-    Vec_t x_bins(x.size() + 1);
-
-    // Set up intervals, big enough to hold either x or y bins.
-    Vec_t lower(std::max(x.size(), y.size()));
-    Vec_t upper(std::max(x.size(), y.size()));
-
-    // Get intervals of x axis.
-    x.getIntervals(lower, upper);
-
-    PyObject *pX = PyList_New(0);
-    // Use low edges of input sequence for all but the last bin.
-    for (Vec_t::size_type ii = 0; ii < x.size(); ++ii) {
-    	PyList_Append(pX,PyFloat_FromDouble(lower[ii]));
-//    	x_bins[ii] = lower[ii];
-    }
-
-    // Last bin is taken from upper bound of last element in sequence.
-    PyList_Append(pX,PyFloat_FromDouble(upper[x.size() - 1]));
-//    x_bins[x.size()] = upper[x.size() - 1];
-
-    // Set up y bins. There is one extra for Root's upper cutoff.
-    Vec_t y_bins(y.size() + 1);
-
-    // Get intervals of y axis.
-    y.getIntervals(lower, upper);
-
-    PyObject *pY = PyList_New(0);
-    // Use low edges of all bins.
-    for (Vec_t::size_type ii = 0; ii < y.size(); ++ii) {
-        PyList_Append(pY,PyFloat_FromDouble(lower[ii]));
-//    	y_bins[ii] = lower[ii];
+    // Set up x and y bin edges. There is one extra edge for the upper bound of the last bin.
+    PyObject *pX = createEdgeArray(x);
+    PyObject *pY = createEdgeArray(y);
+
+    // Populate the histogram values. They are sent to NumPy in one block, one x bin after another, and shaped into the
+    // (x, y) grid, instead of being boxed one Python float at a time. The block is double precision, unless single
+    // precision holds every value exactly, as for counts up to 2^24, in which case it halves the block.
+    bool single = true;
+    for (unsigned long ii = 0; single && ii < x.size(); ++ii)
+      for (unsigned long jj = 0; single && jj < y.size(); ++jj)
+        single = SequenceValueConverter<float>::isExact(z[ii][jj]);
+
+    PyObject *pFlat = 0;
+    if (single) {
+      std::vector<float> z_vals(x.size() * y.size());
+      for (unsigned long ii = 0; ii < x.size(); ++ii)
+        for (unsigned long jj = 0; jj < y.size(); ++jj)
+          z_vals[ii * y.size() + jj] = z[ii][jj];
+      pFlat = createArray(z_vals.empty() ? 0 : &z_vals[0], z_vals.size());
+    } else {
+      std::vector<double> z_vals(x.size() * y.size());
+      for (unsigned long ii = 0; ii < x.size(); ++ii)
+        std::copy(z[ii].begin(), z[ii].begin() + y.size(), z_vals.begin() + ii * y.size());
+      pFlat = createArray(&z_vals[0], z_vals.size());
     }
-
-    // Last bin is overflow.
-    PyList_Append(pY,PyFloat_FromDouble(upper[y.size() - 1]));
-    y_bins[y.size()] = upper[y.size() - 1];
-
-    PyObject *pZ = PyList_New(0);
-    // Populate the histogram values
-	for (unsigned int ii = 0; ii < x.size(); ++ii){
-		PyObject *pYtemp = PyList_New(0);
-		for (unsigned int jj = 0; jj < y.size(); ++jj){
-			PyList_Append(pYtemp,PyFloat_FromDouble(z[ii][jj]));
-			//hist->SetBinContent(ii + 1, jj + 1, z[ii][jj]);
-		}
-		PyList_Append(pZ,pYtemp);
-	}
+    PyObject *pZ = EP_CallMethod(pFlat,"reshape","(ll)",long(x.size()),long(y.size()));
+    Py_DECREF(pFlat);
 
 //    // Create the histogram used to draw the plot.
 	PyObject *pres = EP_CallMethod("Lego","prepareLegoData","(OOO)",pX,pY,pZ); // this returns a tuple of the three lists needed for the surface plot
@@ -513,6 +472,43 @@ namespace st_graph {
     return hist;
   }
 
+  PyObject * MPLPlotFrame::createEdgeArray(const ISequence & seq) const {
+    double lower = 0.;
+    double upper = 0.;
+    if (seq.getUniformBins(lower, upper))
+      return EP_CallMethod("numpy","linspace","(ddl)",lower,upper,long(seq.size() + 1));
+    if (seq.getLogUniformBins(lower, upper))
+      return EP_CallMethod("numpy","geomspace","(ddl)",lower,upper,long(seq.size() + 1));
+    std::vector<double> edges;
+    seq.getBinEdges(edges);
+    return createArray(edges.empty() ? 0 : &edges[0], edges.size());
+  }
+
+  PyObject * MPLPlotFrame::createArray(const double * data, unsigned long size) const {
+    if (0 == size) return EP_CallMethod("numpy","zeros","(i)",0);
+
+    // Expose the doubles to NumPy through a read-only memory view, so that they are copied into the array
+    // in one block instead of being boxed one Python float at a time.
+    PyObject *buffer = PyMemoryView_FromMemory(reinterpret_cast<char *>(const_cast<double *>(data)), size * sizeof(double), PyBUF_READ);
+    PyObject *view = EP_CallMethod("numpy","frombuffer","(Os)",buffer,"d");
+    PyObject *array = EP_CallMethod(view,"copy","()");
+    Py_DECREF(view);
+    Py_DECREF(buffer);
+    return array;
+  }
+
+  PyObject * MPLPlotFrame::createArray(const float * data, unsigned long size) const {
+    if (0 == size) return EP_CallMethod("numpy","zeros","(is)",0,"f");
+
+    // As for doubles, copy the floats into a float32 array through a read-only memory view.
+    PyObject *buffer = PyMemoryView_FromMemory(reinterpret_cast<char *>(const_cast<float *>(data)), size * sizeof(float), PyBUF_READ);
+    PyObject *view = EP_CallMethod("numpy","frombuffer","(Os)",buffer,"f");
+    PyObject *array = EP_CallMethod(view,"copy","()");
+    Py_DECREF(view);
+    Py_DECREF(buffer);
+    return array;
+  }
+
   std::string MPLPlotFrame::createRootName(const std::string & prefix, void * ptr) const {
     // The root name of the object (by which it may be looked up) is its address, converted
     // to a string. This should prevent collisions.
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "st_graph/Axis.h"
+#include "st_graph/SequenceBufferPool.h"
 
 //class TAxis;
 //class TGraph;
@@ -105,6 +106,24 @@ namespace st_graph {
       virtual PyObject * createHistPlot2D(const std::string & root_name, const ISequence & x, const ISequence & y,
         const std::vector<std::vector<double> > & z);
 
+      /** \brief Internal helper method which copies an array of doubles into a new NumPy array.
+          \param data The address of the first double.
+          \param size The number of doubles to copy.
+      */
+      virtual PyObject * createArray(const double * data, unsigned long size) const;
+
+      /** \brief Internal helper method which copies an array of floats into a new single precision NumPy array.
+          \param data The address of the first float.
+          \param size The number of floats to copy.
+      */
+      virtual PyObject * createArray(const float * data, unsigned long size) const;
+
+      /** \brief Internal helper method which creates a NumPy array holding the edges of a sequence interpreted as bins.
+                 Bins of equal linear or logarithmic width are generated by NumPy without extracting them.
+          \param seq The sequence.
+      */
+      virtual PyObject * createEdgeArray(const ISequence & seq) const;
+
       /** \brief Internal helper method which creates a name for MPL objects from the given prefix and a pointer.
           \param prefix String prefix for the MPL object.
 	  \param ptr A pointer which will be concatenated with the prefix to form the name.
@@ -126,6 +145,16 @@ namespace st_graph {
        */
       std::string getColorString(int color) const;
 
+      /** \brief Internal helper method which finds the range along the given axis of the positive data of all plots,
+                 i.e. the part of the data which may be shown on a logarithmic scale. Histograms show only the values
+                 of their second dimension; all other data are shown as intervals. The range is found from the cached
+                 statistics of the plots' sequences, without traversing them. Returns false if no data are positive.
+          \param index The index of the axis.
+          \param lower The output lower limit of the range.
+          \param upper The output upper limit of the range.
+      */
+      virtual bool getPositiveRange(unsigned int index, double & lower, double & upper) const;
+
     private:
       std::vector<Axis> m_axes;
       std::list<MPLPlot *> m_plots;
@@ -134,7 +163,9 @@ namespace st_graph {
       PyObject * m_canvas;
       PyObject * m_multi_graph;
       PyObject * m_th2d;
+      SequenceBufferPool m_buffer_pool;
       unsigned int m_dimensionality;
+      unsigned int m_width;
   };
 
 }
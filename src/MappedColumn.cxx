@@ -0,0 +1,192 @@
+/** \file MappedColumn.cxx
+    \brief Implementation of MappedColumn class.
+*/
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <vector>
+#endif
+
+#include "st_graph/MappedColumn.h"
+
+namespace st_graph {
+
+  /** \class MappedFile
+      \brief Read-only mapping of an entire file into memory. Where memory mapping is not available, the file is
+             read into memory instead.
+  */
+  class MappedFile {
+    public:
+      explicit MappedFile(const std::string & file_name);
+
+      ~MappedFile();
+
+      const char * data() const { return m_data; }
+
+      unsigned long size() const { return m_size; }
+
+    private:
+      // Mappings are shared by reference, never copied.
+      MappedFile(const MappedFile &);
+      MappedFile & operator =(const MappedFile &);
+
+      const char * m_data;
+      unsigned long m_size;
+#ifdef WIN32
+      std::vector<char> m_buffer;
+#endif
+  };
+
+#ifndef WIN32
+  MappedFile::MappedFile(const std::string & file_name): m_data(0), m_size(0) {
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (-1 == fd) throw std::runtime_error("MappedFile: cannot open file " + file_name);
+
+    struct stat status;
+    if (0 != fstat(fd, &status)) {
+      close(fd);
+      throw std::runtime_error("MappedFile: cannot determine size of file " + file_name);
+    }
+    m_size = status.st_size;
+
+    // Files of size 0 cannot be mapped, but need not be.
+    if (0 != m_size) {
+      void * data = mmap(0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (MAP_FAILED == data) {
+        close(fd);
+        throw std::runtime_error("MappedFile: cannot map file " + file_name);
+      }
+      // Sequences are normally read from beginning to end, so ask for aggressive read-ahead.
+      posix_madvise(data, m_size, POSIX_MADV_SEQUENTIAL);
+      m_data = static_cast<const char *>(data);
+    }
+
+    // The mapping remains valid after the file is closed.
+    close(fd);
+  }
+
+  MappedFile::~MappedFile() {
+    if (0 != m_data) munmap(const_cast<char *>(m_data), m_size);
+  }
+#else
+  MappedFile::MappedFile(const std::string & file_name): m_data(0), m_size(0), m_buffer() {
+    std::ifstream file(file_name.c_str(), std::ios::in | std::ios::binary);
+    if (!file) throw std::runtime_error("MappedFile: cannot open file " + file_name);
+    file.seekg(0, std::ios::end);
+    m_buffer.resize(file.tellg());
+    file.seekg(0, std::ios::beg);
+    if (!m_buffer.empty()) {
+      if (!file.read(&m_buffer[0], m_buffer.size())) throw std::runtime_error("MappedFile: cannot read file " + file_name);
+      m_data = &m_buffer[0];
+      m_size = m_buffer.size();
+    }
+  }
+
+  MappedFile::~MappedFile() {}
+#endif
+
+  namespace {
+    // Magic string at the start of every NumPy .npy file.
+    const char s_npy_magic[] = "\x93NUMPY";
+    const MappedColumn::size_type s_npy_magic_size = sizeof(s_npy_magic) - 1;
+
+    bool isLittleEndian() {
+      const unsigned short probe = 1;
+      return 1 == *reinterpret_cast<const unsigned char *>(&probe);
+    }
+
+    // Return the text following the given key in a .npy header dictionary, or throw if the key is absent.
+    std::string::size_type findKey(const std::string & header, const std::string & key, const std::string & file_name) {
+      std::string::size_type pos = header.find("'" + key + "'");
+      if (std::string::npos == pos) throw std::runtime_error("MappedColumn: " + file_name + " has no " + key + " in its header");
+      pos = header.find(':', pos);
+      if (std::string::npos == pos) throw std::runtime_error("MappedColumn: " + file_name + " has a malformed header");
+      return header.find_first_not_of(" ", pos + 1);
+    }
+  }
+
+  MappedColumn::MappedColumn(const std::string & file_name): m_file(new MappedFile(file_name)), m_file_name(file_name),
+    m_begin(0), m_end(0) {
+    size_type offset = 0;
+    size_type count = m_file->size() / sizeof(double);
+    if (s_npy_magic_size <= m_file->size() && 0 == std::memcmp(m_file->data(), s_npy_magic, s_npy_magic_size)) {
+      parseNpyHeader(offset, count);
+    } else if (0 != m_file->size() % sizeof(double)) {
+      throw std::runtime_error("MappedColumn: size of file " + file_name + " is not a whole number of doubles");
+    }
+    setData(offset, count);
+  }
+
+  MappedColumn::MappedColumn(const std::string & file_name, size_type offset, size_type count):
+    m_file(new MappedFile(file_name)), m_file_name(file_name), m_begin(0), m_end(0) {
+    setData(offset, count);
+  }
+
+  void MappedColumn::setData(size_type offset, size_type count) {
+    if (offset > m_file->size() || count > (m_file->size() - offset) / sizeof(double))
+      throw std::out_of_range("MappedColumn: requested column extends past the end of file " + m_file_name);
+    if (0 == count) return;
+    if (0 != offset % sizeof(double))
+      throw std::runtime_error("MappedColumn: column in file " + m_file_name + " is not aligned for doubles");
+    m_begin = reinterpret_cast<const double *>(m_file->data() + offset);
+    m_end = m_begin + count;
+  }
+
+  void MappedColumn::parseNpyHeader(size_type & offset, size_type & count) const {
+    // Fixed part of the header: magic string, major and minor version, then the little-endian length of the
+    // header dictionary, which is 2 bytes in version 1 and 4 bytes in later versions.
+    const unsigned char * data = reinterpret_cast<const unsigned char *>(m_file->data());
+    size_type file_size = m_file->size();
+    if (s_npy_magic_size + 4 > file_size) throw std::runtime_error("MappedColumn: " + m_file_name + " has a truncated header");
+    unsigned int major_version = data[s_npy_magic_size];
+    size_type len_pos = s_npy_magic_size + 2;
+    size_type header_len = 0;
+    if (1 == major_version) {
+      header_len = data[len_pos] | size_type(data[len_pos + 1]) << 8;
+      offset = len_pos + 2 + header_len;
+    } else {
+      if (len_pos + 4 > file_size) throw std::runtime_error("MappedColumn: " + m_file_name + " has a truncated header");
+      header_len = data[len_pos] | size_type(data[len_pos + 1]) << 8 | size_type(data[len_pos + 2]) << 16 |
+        size_type(data[len_pos + 3]) << 24;
+      offset = len_pos + 4 + header_len;
+    }
+    if (offset > file_size) throw std::runtime_error("MappedColumn: " + m_file_name + " has a truncated header");
+    std::string header(m_file->data() + offset - header_len, header_len);
+
+    // Data must be doubles in the byte order of this host, so that they may be used in place.
+    std::string::size_type pos = findKey(header, "descr", m_file_name);
+    std::string descr = header.substr(pos, 5);
+    std::string native_descr = isLittleEndian() ? "'<f8'" : "'>f8'";
+    if (native_descr != descr)
+      throw std::runtime_error("MappedColumn: " + m_file_name + " holds data of type " + descr + ", not " + native_descr);
+
+    // The shape may have several dimensions, provided only one of them is larger than 1, so the data form a single
+    // column regardless of their order in memory.
+    pos = findKey(header, "shape", m_file_name);
+    std::string::size_type end_pos = header.find(')', pos);
+    if (std::string::npos == pos || '(' != header[pos] || std::string::npos == end_pos)
+      throw std::runtime_error("MappedColumn: " + m_file_name + " has a malformed shape in its header");
+    std::istringstream shape(header.substr(pos + 1, end_pos - pos - 1));
+    count = 1;
+    int num_long_dims = 0;
+    std::string dim;
+    while (std::getline(shape, dim, ',')) {
+      if (std::string::npos == dim.find_first_not_of(" ")) continue;
+      size_type dim_size = std::strtoul(dim.c_str(), 0, 10);
+      if (1 < dim_size) ++num_long_dims;
+      count *= dim_size;
+    }
+    if (1 < num_long_dims)
+      throw std::runtime_error("MappedColumn: " + m_file_name + " holds a multi-dimensional array, not a single column");
+  }
+
+}
@@ -11,6 +11,7 @@
 #include "RootPlot.h"
 #include "RootPlotFrame.h"
 
+#include "st_graph/DecimatedSequence.h"
 #include "st_graph/IFrame.h"
 #include "st_graph/Sequence.h"
 
@@ -18,7 +19,8 @@ namespace st_graph {
 
   RootPlot::RootPlot(IFrame * parent, const std::string & style, const ISequence & x, const ISequence & y, bool delete_parent):
     m_seq_cont(0), m_label(), m_style(), m_line_style("solid"), m_curve_type("line"), m_line_color(Color::eBlack), m_dimensionality(2),
-    m_parent(0), m_z_data(0), m_delete_parent(delete_parent) {
+    m_parent(0), m_z_data(0), m_selected(), m_selected_width(0), m_selection_cached(false), m_decimated(false),
+    m_delete_parent(delete_parent) {
     // Get the parent multi frame so that the plot can be added with desired style.
     m_parent = dynamic_cast<RootPlotFrame *>(parent);
     if (0 == m_parent) throw std::logic_error("RootPlot constructor: parent must be a valid RootPlotFrame");
@@ -38,7 +40,8 @@ namespace st_graph {
   RootPlot::RootPlot(IFrame * parent, const std::string & style, const ISequence & x, const ISequence & y,
     const std::vector<std::vector<double> > & z, bool delete_parent): m_seq_cont(0), m_label(), m_style(),
     m_line_style("solid"), m_curve_type("line"), m_line_color(Color::eBlack), m_dimensionality(3), m_parent(0),
-    m_z_data(&z), m_delete_parent(delete_parent) {
+    m_z_data(&z), m_selected(), m_selected_width(0), m_selection_cached(false), m_decimated(false),
+    m_delete_parent(delete_parent) {
     // Get the parent multi frame so that the plot can be added with desired style.
     m_parent = dynamic_cast<RootPlotFrame *>(parent);
     if (0 == m_parent) throw std::logic_error("RootPlot constructor: parent must be a valid RootPlotFrame");
@@ -80,6 +83,30 @@ namespace st_graph {
 
   const std::vector<const ISequence *> RootPlot::getSequences() const { return m_seq_cont; }
 
+  void RootPlot::clearStatistics() {
+    for (std::vector<const ISequence *>::iterator itor = m_seq_cont.begin(); itor != m_seq_cont.end(); ++itor)
+      (*itor)->clearStatistics();
+    m_selection_cached = false;
+  }
+
+  void RootPlot::clearStaleStatistics() {
+    for (std::vector<const ISequence *>::iterator itor = m_seq_cont.begin(); itor != m_seq_cont.end(); ++itor) {
+      if (!(*itor)->hasFixedData()) {
+        (*itor)->clearStatistics();
+        m_selection_cached = false;
+      }
+    }
+  }
+
+  const std::vector<ISequence::size_type> * RootPlot::selectForDisplay(ISequence::size_type num_pixels) {
+    if (!m_selection_cached || num_pixels != m_selected_width) {
+      m_decimated = DecimatedSequence::selectForDisplay(*m_seq_cont.at(0), *m_seq_cont.at(1), num_pixels, m_selected);
+      m_selected_width = num_pixels;
+      m_selection_cached = true;
+    }
+    return m_decimated ? &m_selected : 0;
+  }
+
   const std::vector<std::vector<double> > & RootPlot::getZData() const {
     if (0 == m_z_data) throw std::logic_error("RootPlot::getZData() called for a plot which has null Z data");
     return *m_z_data;
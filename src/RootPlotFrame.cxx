@@ -4,8 +4,10 @@
 */
 #include <algorithm>
 #include <cctype>
+#include <limits>
 #include <list>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <utility>
@@ -24,8 +26,28 @@
 #include "RootPlot.h"
 #include "RootPlotFrame.h"
 
+#include "st_graph/DecimatedSequence.h"
 #include "st_graph/IEventReceiver.h"
 
+namespace {
+
+  /** \brief Create a two dimensional Root histogram of type Hist_t (TH2D or TH2F). Bins of equal width are given by
+             their number and range alone; otherwise by their edges, including one extra for Root's upper cutoff.
+  */
+  template <typename Hist_t>
+  TH2 * createTH2(const std::string & name, const std::string & title, int num_x, double x_min, double x_max,
+    const double * x_edges, int num_y, double y_min, double y_max, const double * y_edges) {
+    if (0 == x_edges && 0 == y_edges)
+      return new Hist_t(name.c_str(), title.c_str(), num_x, x_min, x_max, num_y, y_min, y_max);
+    else if (0 == x_edges)
+      return new Hist_t(name.c_str(), title.c_str(), num_x, x_min, x_max, num_y, y_edges);
+    else if (0 == y_edges)
+      return new Hist_t(name.c_str(), title.c_str(), num_x, x_edges, num_y, y_min, y_max);
+    return new Hist_t(name.c_str(), title.c_str(), num_x, x_edges, num_y, y_edges);
+  }
+
+}
+
 namespace st_graph {
 
   class StMarker : public TMarker {
@@ -215,7 +237,7 @@ namespace st_graph {
 
   RootPlotFrame::RootPlotFrame(IFrame * parent, const std::string & title, unsigned int width, unsigned int height,
     bool delete_parent): RootFrame(parent, 0, 0, delete_parent), m_axes(3), m_plots(), m_tgraphs(), m_title(title), m_canvas(0),
-    m_multi_graph(0), m_th2d(0), m_dimensionality(0) {
+    m_multi_graph(0), m_th2d(0), m_dimensionality(0), m_width(width) {
     
     // Send event messages back to parent.
     m_receiver = m_parent->getReceiver();
@@ -409,7 +431,13 @@ namespace st_graph {
     // Enable custom event handling for 2d graphs.
     m_canvas->setHandleEvents(true);
 
+    // Buffers used by the previous display are no longer needed; Root copied their contents.
+    m_buffer_pool.reset();
+
     for (std::list<RootPlot *>::iterator itor = m_plots.begin(); itor != m_plots.end(); ++itor) {
+      // The client may have modified the data since the last display, so results cached for sequences which do not
+      // hold fixed data are stale.
+      (*itor)->clearStaleStatistics();
 
       // Get numeric sequences from data.
       const std::vector<const ISequence *> sequences((*itor)->getSequences());
@@ -421,14 +449,17 @@ namespace st_graph {
       // Determine the style of the graph.
       std::string style = (*itor)->getStyle();
 
-      // Depending on the style, create appropriate Root plot object.
-      TGraph * tgraph = 0;
-      if (style == "hist")
-        tgraph = createHistPlot(*x, *y);
-      else
-        tgraph = createScatterPlot(*x, *y);
-
-      tgraph->SetLineColor((*itor)->getLineColor());
+      // Depending on the style, create appropriate Root plot objects. Histograms with a few gaps need one per segment.
+      std::vector<TGraph *> tgraphs;
+      const std::vector<DecimatedSequence::size_type> * selected = 0;
+      if (style == "hist") {
+        createHistPlot(*x, *y, tgraphs);
+      } else if (0 != (selected = (*itor)->selectForDisplay(m_width))) {
+        // Far more points than pixels: draw only those which preserve the envelope of the data in each pixel column.
+        tgraphs.push_back(createScatterPlot(DecimatedSequence(*x, *selected), DecimatedSequence(*y, *selected)));
+      } else {
+        tgraphs.push_back(createScatterPlot(*x, *y));
+      }
 
       // Handle line style: none, solid, dashed, dotted.
       std::string line_style = (*itor)->getLineStyle();
@@ -446,18 +477,32 @@ namespace st_graph {
         else line_style = "L";
       }
 
-      tgraph->SetLineStyle(root_line_style);
+      for (std::vector<TGraph *>::iterator graph_itor = tgraphs.begin(); graph_itor != tgraphs.end(); ++graph_itor) {
+        TGraph * tgraph = *graph_itor;
+        tgraph->SetLineColor((*itor)->getLineColor());
+        tgraph->SetLineStyle(root_line_style);
 
-      // Keep track of Root object, so it can be deleted later.
-      m_tgraphs.push_back(tgraph);
+        // Keep track of Root object, so it can be deleted later.
+        m_tgraphs.push_back(tgraph);
 
-      // Connect Root objects.
-      m_multi_graph->Add(tgraph, line_style.c_str());
+        // Connect Root objects.
+        m_multi_graph->Add(tgraph, line_style.c_str());
+      }
     }
 
     // Draw parent TMultiGraph object.
     m_multi_graph->Draw("A");
 
+    // Autoscaling includes data which cannot be shown on logarithmic axes, so limit those axes to the positive data.
+    double lower = 0.;
+    double upper = 0.;
+    if (Axis::eLog == m_axes[0].getScaleMode() && getPositiveRange(0, lower, upper))
+      m_multi_graph->GetXaxis()->SetLimits(lower, upper);
+    if (Axis::eLog == m_axes[1].getScaleMode() && getPositiveRange(1, lower, upper)) {
+      m_multi_graph->SetMinimum(lower);
+      m_multi_graph->SetMaximum(upper);
+    }
+
     // Get axes. Set all three dimensions even though this is 2D.
     axes.resize(3);
     axes[0] = m_multi_graph->GetXaxis();
@@ -470,6 +515,7 @@ namespace st_graph {
 
     if (m_plots.empty()) return;
     std::list<RootPlot *>::iterator itor = m_plots.begin();
+    (*itor)->clearStaleStatistics();
 
     // Get numeric sequences from data.
     const std::vector<const ISequence *> sequences((*itor)->getSequences());
@@ -492,136 +538,120 @@ namespace st_graph {
     axes[2] = m_th2d->GetZaxis();
   }
 
-  TGraph * RootPlotFrame::createHistPlot(const ISequence & x, const ISequence & y) {
-    TGraph * retval = 0;
-
-    // Get arrays of values.
-    std::vector<double> x_low;
-    std::vector<double> x_high;
-    std::vector<double> y_value;
-
-    // Interpret x as a set of intervals.
-    x.getIntervals(x_low, x_high);
-
-    // Interpret y as the value in each interval.
-    y.getValues(y_value);
-
-    // Combine ranges and values into one array for axis and one array for the data; needed for TGraph.
-    std::vector<double> x_vals(x_low.size() * 4);
-    std::vector<double> y_vals(x_low.size() * 4);
-
-    // Use input arrays to create graphable data.
-    unsigned long idx = 0;
-    unsigned long ii = 0;
-
-#if 0
-    // First point plotted is at the base of the first bin.
-    x_vals[idx] = x_low[ii];
-    y_vals[idx] = 0.;
-
-    ++idx;
-#endif
-    for (ii = 0; ii < x_low.size(); ++ii, ++idx) {
-      // Plot the y value at the left edge.
-      x_vals[idx] = x_low[ii];
-      y_vals[idx] = y_value[ii];
-
-      // Next plot the y value at the right edge.
-      ++idx;
-      x_vals[idx] = x_high[ii];
-      y_vals[idx] = y_value[ii];
-
-      // Exclude the last bin, which requires special handling.
-      if (ii != x_low.size() - 1) {
-        // See if the next bin's left edge is > than the right edge which was just plotted.
-        double next = x_low[ii + 1];
-        if (next > x_vals[idx]) {
-          // There is a gap in the data, so plot a value of 0. in the gap.
-          ++idx;
-          x_vals[idx] = x_vals[idx - 1];
-          y_vals[idx] = 0.;
-          ++idx;
-          x_vals[idx] = next;
-          y_vals[idx] = 0.;
-        }
-#if 0
+  bool RootPlotFrame::getPositiveRange(unsigned int index, double & lower, double & upper) const {
+    lower = std::numeric_limits<double>::infinity();
+    upper = -std::numeric_limits<double>::infinity();
+    for (std::list<RootPlot *>::const_iterator itor = m_plots.begin(); itor != m_plots.end(); ++itor) {
+      SequenceStatistics stats((*itor)->getSequences().at(index)->getStatistics());
+      if (1 == index && "hist" == (*itor)->getStyle()) {
+        lower = std::min(lower, stats.getMinPositiveValue());
+        upper = std::max(upper, stats.getMaxValue());
       } else {
-        // Last input point is the last right edge, which should drop to 0.
-        ++idx;
-        x_vals[idx] = x_vals[idx - 1];
-        y_vals[idx] = 0.;
-#endif
+        lower = std::min(lower, stats.getMinPositiveLower());
+        upper = std::max(upper, stats.getMaxUpper());
       }
     }
+    return lower < upper;
+  }
 
-    // Create the graph.
-    retval = new TGraph(idx, &*x_vals.begin(), &*y_vals.begin());
-
-    retval->SetEditable(kFALSE);
+  void RootPlotFrame::createHistPlot(const ISequence & x, const ISequence & y, std::vector<TGraph *> & tgraphs) {
+    // Combine ranges and values into one array for axis and one array for the data; needed for TGraph. Bins which are
+    // not finite, or not positive on logarithmic axes, are left out, so Root never sees them.
+    const double * x_vals = 0;
+    const double * y_vals = 0;
+    unsigned long num_vals = m_buffer_pool.createStepCurve(x, y, Axis::eLog == m_axes[0].getScaleMode(),
+      Axis::eLog == m_axes[1].getScaleMode(), x_vals, y_vals);
+
+    if (0 == num_vals) return;
+
+    // Root does not break lines at NaN, so each run of vertices between break vertices needs its own graph.
+    unsigned long num_breaks = 0;
+    for (unsigned long ii = 0; ii != num_vals; ++ii) if (x_vals[ii] != x_vals[ii]) ++num_breaks;
+
+    if (s_max_hist_graphs <= num_breaks) {
+      // Too many segments for one graph each: draw a single graph, joining the segments across the breaks.
+      TGraph * tgraph = new TGraph(num_vals - num_breaks);
+      double * x_pts = tgraph->GetX();
+      double * y_pts = tgraph->GetY();
+      for (unsigned long ii = 0; ii != num_vals; ++ii) {
+        if (x_vals[ii] != x_vals[ii]) continue;
+        *x_pts++ = x_vals[ii];
+        *y_pts++ = y_vals[ii];
+      }
+      tgraph->SetEditable(kFALSE);
+      tgraphs.push_back(tgraph);
+      return;
+    }
 
-    return retval;
+    for (unsigned long begin = 0; begin < num_vals; ) {
+      unsigned long end = begin;
+      while (end != num_vals && x_vals[end] == x_vals[end]) ++end;
+      TGraph * tgraph = new TGraph(end - begin, x_vals + begin, y_vals + begin);
+      tgraph->SetEditable(kFALSE);
+      tgraphs.push_back(tgraph);
+      begin = end + 1;
+    }
   }
 
   TGraph * RootPlotFrame::createScatterPlot(const ISequence & x, const ISequence & y) {
     TGraph * retval = 0;
-    // Get arrays of values.
-    std::vector<double> x_pts;
-    std::vector<double> x_low_err;
-    std::vector<double> x_high_err;
-    std::vector<double> y_pts;
-    std::vector<double> y_low_err;
-    std::vector<double> y_high_err;
+    // Get arrays of values and spreads, each sequence in a single pass. Points which are not finite, or not positive
+    // on logarithmic axes, are dropped in bulk, so Root never sees them.
+    const SequenceColumns * x_columns = 0;
+    const SequenceColumns * y_columns = 0;
+    unsigned long num_points = m_buffer_pool.createScatterColumns(x, y, Axis::eLog == m_axes[0].getScaleMode(),
+      Axis::eLog == m_axes[1].getScaleMode(), x_columns, y_columns);
 
-    x.getValues(x_pts);
-    x.getSpreads(x_low_err, x_high_err);
+    const double * x_pts = x_columns->data(SequenceColumns::eValue);
+    const double * x_low_err = x_columns->data(SequenceColumns::eLowerSpread);
+    const double * x_high_err = x_columns->data(SequenceColumns::eUpperSpread);
 
-    y.getValues(y_pts);
-    y.getSpreads(y_low_err, y_high_err);
+    const double * y_pts = y_columns->data(SequenceColumns::eValue);
+    const double * y_low_err = y_columns->data(SequenceColumns::eLowerSpread);
+    const double * y_high_err = y_columns->data(SequenceColumns::eUpperSpread);
 
     // Create the graph.
-    retval = new TGraphAsymmErrors(x.size(), &x_pts[0], &y_pts[0], &x_low_err[0], &x_high_err[0], &y_low_err[0], &y_high_err[0]);
+    retval = new TGraphAsymmErrors(num_points, x_pts, y_pts, x_low_err, x_high_err, y_low_err, y_high_err);
     retval->SetEditable(kFALSE);
 
     return retval;
   }
 
-  TH2D * RootPlotFrame::createHistPlot2D(const std::string & root_name, const ISequence & x, const ISequence & y,
+  TH2 * RootPlotFrame::createHistPlot2D(const std::string & root_name, const ISequence & x, const ISequence & y,
     const std::vector<std::vector<double> > & z) {
 
-    TH2D * hist = 0;
+    TH2 * hist = 0;
 
     typedef std::vector<double> Vec_t;
 
-    // Set up x bins. There is one extra for Root's upper cutoff.
-    Vec_t x_bins(x.size() + 1);
-
-    // Set up intervals, big enough to hold either x or y bins.
-    Vec_t lower(std::max(x.size(), y.size()));
-    Vec_t upper(std::max(x.size(), y.size()));
-    
-    // Get intervals of x axis.
-    x.getIntervals(lower, upper);
-
-    // Use low edges of input sequence for all but the last bin.
-    for (Vec_t::size_type ii = 0; ii < x.size(); ++ii) x_bins[ii] = lower[ii];
-
-    // Last bin is taken from upper bound of last element in sequence.
-    x_bins[x.size()] = upper[x.size() - 1];
-
-    // Set up y bins. There is one extra for Root's upper cutoff.
-    Vec_t y_bins(y.size() + 1);
-
-    // Get intervals of y axis.
-    y.getIntervals(lower, upper);
-
-    // Use low edges of all bins.
-    for (Vec_t::size_type ii = 0; ii < y.size(); ++ii) y_bins[ii] = lower[ii];
-
-    // Last bin is overflow.
-    y_bins[y.size()] = upper[y.size() - 1];
+    // Bins of equal width are given to Root by their number and range alone, which also lets Root find bins in
+    // constant time. Otherwise, set up bin edges, which include one extra for Root's upper cutoff.
+    double x_min = 0.;
+    double x_max = 0.;
+    Vec_t x_bins;
+    bool x_uniform = x.getUniformBins(x_min, x_max);
+    if (!x_uniform) x.getBinEdges(x_bins);
+
+    double y_min = 0.;
+    double y_max = 0.;
+    Vec_t y_bins;
+    bool y_uniform = y.getUniformBins(y_min, y_max);
+    if (!y_uniform) y.getBinEdges(y_bins);
+
+    // Bin contents are double precision, unless single precision holds every value exactly, as for counts up to 2^24,
+    // in which case it halves the memory of large count maps without changing them.
+    bool single = true;
+    for (unsigned int ii = 0; single && ii < x.size(); ++ii)
+      for (unsigned int jj = 0; single && jj < y.size(); ++jj)
+        single = SequenceValueConverter<float>::isExact(z[ii][jj]);
 
     // Create the histogram used to draw the plot.
-    hist = new TH2D(root_name.c_str(), getTitle().c_str(), x_bins.size() - 1, &x_bins[0], y_bins.size() - 1, &y_bins[0]);
+    const double * x_edges = x_uniform ? 0 : &x_bins[0];
+    const double * y_edges = y_uniform ? 0 : &y_bins[0];
+    if (single)
+      hist = createTH2<TH2F>(root_name, getTitle(), x.size(), x_min, x_max, x_edges, y.size(), y_min, y_max, y_edges);
+    else
+      hist = createTH2<TH2D>(root_name, getTitle(), x.size(), x_min, x_max, x_edges, y.size(), y_min, y_max, y_edges);
 
     // Populate the histogram.
     for (unsigned int ii = 0; ii < x.size(); ++ii)
@@ -10,11 +10,12 @@
 #include <vector>
 
 #include "st_graph/Axis.h"
+#include "st_graph/SequenceBufferPool.h"
 #include "st_graph/RootFrame.h"
 
 class TAxis;
 class TGraph;
-class TH2D;
+class TH2;
 class TMultiGraph;
 
 namespace st_graph {
@@ -73,6 +74,9 @@ namespace st_graph {
       const std::vector<Axis> & getAxes() const;
 
     protected:
+      /// \brief The largest number of Root objects created for the segments of one histogram.
+      static const unsigned long s_max_hist_graphs = 16;
+
       /** \brief Internal helper method which correctly displays 2d plots.
           \param axes (Output) set of Root axis objects. Note that axes contains 3 such TAxis objects.
       */
@@ -83,11 +87,15 @@ namespace st_graph {
       */
       virtual void display3d(std::vector<TAxis *> & axes);
 
-      /** \brief Internal helper method which creates histogram plot as a Root object.
+      /** \brief Internal helper method which creates histogram plot as Root objects, one for each segment of
+                 adjacent bins, so that gaps between bins are drawn as breaks in the outline. Histograms with more than
+                 s_max_hist_graphs segments are drawn as a single Root object instead, in which adjacent segments are
+                 joined, so that histograms with many gaps do not create one Root object per gap.
           \param x The first dimension.
           \param y The second dimension.
+          \param tgraphs (Output) The Root objects, to which those created are appended.
       */
-      virtual TGraph * createHistPlot(const ISequence & x, const ISequence & y);
+      virtual void createHistPlot(const ISequence & x, const ISequence & y, std::vector<TGraph *> & tgraphs);
 
       /** \brief Internal helper method which creates scatter plot as a Root object.
           \param x The first dimension.
@@ -101,7 +109,7 @@ namespace st_graph {
           \param y The second dimension.
 	  \param z The third dimension.
       */
-      virtual TH2D * createHistPlot2D(const std::string & root_name, const ISequence & x, const ISequence & y,
+      virtual TH2 * createHistPlot2D(const std::string & root_name, const ISequence & x, const ISequence & y,
         const std::vector<std::vector<double> > & z);
 
       /** \brief Internal helper method which creates a name for Root objects from the given prefix and a pointer.
@@ -113,6 +121,16 @@ namespace st_graph {
       /// \brief Get the underlying Root graphical object; create it if it does not yet exist.
       virtual TMultiGraph * getMultiGraph();
 
+      /** \brief Internal helper method which finds the range along the given axis of the positive data of all plots,
+                 i.e. the part of the data which may be shown on a logarithmic scale. Histograms show only the values
+                 of their second dimension; all other data are shown as intervals. The range is found from the cached
+                 statistics of the plots' sequences, without traversing them. Returns false if no data are positive.
+          \param index The index of the axis.
+          \param lower The output lower limit of the range.
+          \param upper The output upper limit of the range.
+      */
+      virtual bool getPositiveRange(unsigned int index, double & lower, double & upper) const;
+
     private:
       std::vector<Axis> m_axes;
       std::list<RootPlot *> m_plots;
@@ -120,8 +138,10 @@ namespace st_graph {
       std::string m_title;
       StEmbeddedCanvas * m_canvas;
       TMultiGraph * m_multi_graph;
-      TH2D * m_th2d;
+      TH2 * m_th2d;
+      SequenceBufferPool m_buffer_pool;
       unsigned int m_dimensionality;
+      unsigned int m_width;
   };
 
 }
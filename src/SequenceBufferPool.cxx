@@ -0,0 +1,138 @@
+/** \file SequenceBufferPool.cxx
+    \brief Implementation of SequenceBufferPool class.
+*/
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include "st_graph/SequenceBufferPool.h"
+
+namespace st_graph {
+
+  SequenceBufferPool::SequenceBufferPool(): m_columns(), m_buffers(), m_num_columns_used(0), m_num_buffers_used(0) {}
+
+  void SequenceBufferPool::reset() {
+    m_num_columns_used = 0;
+    m_num_buffers_used = 0;
+  }
+
+  SequenceColumns & SequenceBufferPool::getColumns() {
+    // Blocks are only ever appended, so references to blocks already handed out remain valid.
+    if (m_columns.size() == m_num_columns_used) m_columns.push_back(SequenceColumns());
+    return m_columns[m_num_columns_used++];
+  }
+
+  std::vector<double> & SequenceBufferPool::getBuffer() {
+    if (m_buffers.size() == m_num_buffers_used) m_buffers.push_back(std::vector<double>());
+    return m_buffers[m_num_buffers_used++];
+  }
+
+  unsigned long SequenceBufferPool::createStepCurve(const ISequence & x, const ISequence & y, bool x_positive,
+    bool y_positive, const double * & x_vals, const double * & y_vals) {
+    if (x.size() != y.size())
+      throw std::logic_error("SequenceBufferPool::createStepCurve: sequences have different sizes");
+
+    // Get arrays of values. Sequences which store their data contiguously are read in place.
+    SequenceColumns & x_columns(getColumns());
+    SequenceColumns & y_columns(getColumns());
+
+    // Interpret x as a set of intervals.
+    x.getColumnData(SequenceColumns::eIntervals, x_columns);
+    const double * x_low = x_columns.data(SequenceColumns::eLowerBound);
+    const double * x_high = x_columns.data(SequenceColumns::eUpperBound);
+
+    // Interpret y as the value in each interval.
+    y.getColumnData(SequenceColumns::eValue, y_columns);
+    const double * y_value = y_columns.data(SequenceColumns::eValue);
+
+    // Number of bins in the histogram, the gaps between them and the bins which can be plotted, all of which are
+    // cached by the sequences.
+    unsigned long num_bins = x.size();
+    std::shared_ptr<const GapMask> gaps(x.getGapMask());
+    std::shared_ptr<const ValidityMask> x_valid(x.getValidityMask(x_positive));
+    std::shared_ptr<const ValidityMask> y_valid(y.getValidityMask(y_positive));
+    unsigned long num_valid = x_valid->getNumValid(*y_valid);
+    bool all_valid = num_bins == num_valid;
+
+    // Combine ranges and values into one array for axis and one array for the data, with room for a break at each gap
+    // and each bin left out. Buffers keep their capacity, so this only allocates when the histogram has grown.
+    std::vector<double> & x_buf(getBuffer());
+    std::vector<double> & y_buf(getBuffer());
+    x_buf.resize(2 * num_valid + gaps->getNumGaps() + num_bins - num_valid);
+    y_buf.resize(x_buf.size());
+
+    // Each segment of adjacent bins is copied without testing its bins for gaps, and, unless some bins cannot be
+    // plotted, without testing them for validity. A break is placed only between two bins which are drawn.
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    unsigned long idx = 0;
+    bool broken = false;
+    for (unsigned long begin = 0; begin != num_bins; ) {
+      unsigned long end = gaps->findSegmentEnd(begin);
+      for (unsigned long ii = begin; ii != end; ++ii) {
+        if (!all_valid && !(x_valid->isValid(ii) && y_valid->isValid(ii))) {
+          broken = true;
+          continue;
+        }
+        if (broken && 0 != idx) {
+          x_buf[idx] = nan;
+          y_buf[idx] = nan;
+          ++idx;
+        }
+        broken = false;
+        x_buf[idx] = x_low[ii];
+        y_buf[idx] = y_value[ii];
+        x_buf[idx + 1] = x_high[ii];
+        y_buf[idx + 1] = y_value[ii];
+        idx += 2;
+      }
+      broken = true;
+      begin = end;
+    }
+
+    x_vals = x_buf.empty() ? 0 : &x_buf[0];
+    y_vals = y_buf.empty() ? 0 : &y_buf[0];
+
+    return idx;
+  }
+
+  unsigned long SequenceBufferPool::createScatterColumns(const ISequence & x, const ISequence & y, bool x_positive,
+    bool y_positive, const SequenceColumns * & x_columns, const SequenceColumns * & y_columns) {
+    if (x.size() != y.size())
+      throw std::logic_error("SequenceBufferPool::createScatterColumns: sequences have different sizes");
+
+    // Get arrays of values and spreads, each sequence in a single pass. Sequences which store their data
+    // contiguously are read in place.
+    const unsigned int mask = SequenceColumns::eValue | SequenceColumns::eSpreads;
+    SequenceColumns & x_block(getColumns());
+    SequenceColumns & y_block(getColumns());
+    x.getColumnData(mask, x_block);
+    y.getColumnData(mask, y_block);
+    x_columns = &x_block;
+    y_columns = &y_block;
+
+    // Points are kept only if valid in both sequences. The masks are cached by the sequences.
+    std::shared_ptr<const ValidityMask> x_valid(x.getValidityMask(x_positive));
+    std::shared_ptr<const ValidityMask> y_valid(y.getValidityMask(y_positive));
+    unsigned long num_valid = x_valid->getNumValid(*y_valid);
+    if (x.size() == num_valid) return num_valid;
+
+    // Move the valid points to the start of each column. Columns read in place are first copied to the block's own
+    // storage, which keeps its capacity, while columns already in the block are compressed where they are.
+    const SequenceColumns::Column_e column[] = { SequenceColumns::eValue, SequenceColumns::eLowerSpread,
+      SequenceColumns::eUpperSpread };
+    SequenceColumns * block[] = { &x_block, &y_block };
+    for (int block_idx = 0; block_idx != 2; ++block_idx) {
+      for (int col_idx = 0; col_idx != 3; ++col_idx) {
+        const double * in = block[block_idx]->data(column[col_idx]);
+        double * out = block[block_idx]->resize(column[col_idx], x.size());
+        x_valid->compress(in, out, y_valid.get());
+      }
+    }
+    return num_valid;
+  }
+
+  unsigned long SequenceBufferPool::getNumColumnsUsed() const { return m_num_columns_used; }
+
+  unsigned long SequenceBufferPool::getNumBuffersUsed() const { return m_num_buffers_used; }
+
+}
@@ -0,0 +1,554 @@
+/** \file SimdKernel.cxx
+    \brief Implementation of explicitly vectorized kernels used by the sequence templates for contiguous data.
+*/
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ST_GRAPH_X86_SIMD
+#include <immintrin.h>
+#endif
+
+#include <cstring>
+#include <limits>
+
+#include "st_graph/Sequence.h"
+#include "st_graph/SimdKernel.h"
+
+namespace {
+
+  using namespace st_graph;
+
+  // Each implementation fills elements [begin, end) of the output arrays, where 0 < begin and end < size of the input,
+  // and returns the first element it did not fill, which is less than end when fewer than one vector width remains.
+  // The remainder is then finished by the scalar implementation.
+  typedef unsigned long size_type;
+
+  size_type computeScalar(SimdKernel::Operation_e op, const double * in, size_type begin, size_type end, double * lower,
+    double * upper) {
+    size_type ii = begin;
+    switch (op) {
+      case SimdKernel::eValueBounds:
+        for (; ii != end; ++ii) {
+          lower[ii] = ValueKernel::lowerBound(in[ii - 1], in[ii], in[ii + 1]);
+          upper[ii] = ValueKernel::upperBound(in[ii - 1], in[ii], in[ii + 1]);
+        }
+        break;
+      case SimdKernel::eValueSpreads:
+        for (; ii != end; ++ii) {
+          lower[ii] = ValueKernel::lowerSpread(in[ii - 1], in[ii], in[ii + 1]);
+          upper[ii] = ValueKernel::upperSpread(in[ii - 1], in[ii], in[ii + 1]);
+        }
+        break;
+      case SimdKernel::eLowerBoundBounds:
+        for (; ii != end; ++ii) {
+          lower[ii] = LowerBoundKernel::lowerBound(in[ii - 1], in[ii], in[ii + 1]);
+          upper[ii] = LowerBoundKernel::upperBound(in[ii - 1], in[ii], in[ii + 1]);
+        }
+        break;
+      case SimdKernel::eLowerBoundSpreads:
+        for (; ii != end; ++ii) {
+          lower[ii] = LowerBoundKernel::lowerSpread(in[ii - 1], in[ii], in[ii + 1]);
+          upper[ii] = LowerBoundKernel::upperSpread(in[ii - 1], in[ii], in[ii + 1]);
+        }
+        break;
+    }
+    return ii;
+  }
+
+#ifdef ST_GRAPH_X86_SIMD
+  // Note: multiplications and subtractions are kept as separate instructions (no fused multiply-add) so that the
+  // rounding is the same as in the scalar formulas.
+  __attribute__((target("sse2")))
+  size_type computeSse2(SimdKernel::Operation_e op, const double * in, size_type begin, size_type end, double * lower,
+    double * upper) {
+    const __m128d half = _mm_set1_pd(.5);
+    size_type ii = begin;
+    switch (op) {
+      case SimdKernel::eValueBounds:
+        for (; ii + 2 <= end; ii += 2) {
+          __m128d prev = _mm_loadu_pd(in + ii - 1);
+          __m128d cur = _mm_loadu_pd(in + ii);
+          __m128d next = _mm_loadu_pd(in + ii + 1);
+          _mm_storeu_pd(lower + ii, _mm_sub_pd(cur, _mm_mul_pd(half, _mm_sub_pd(cur, prev))));
+          _mm_storeu_pd(upper + ii, _mm_add_pd(cur, _mm_mul_pd(half, _mm_sub_pd(next, cur))));
+        }
+        break;
+      case SimdKernel::eValueSpreads:
+        for (; ii + 2 <= end; ii += 2) {
+          __m128d prev = _mm_loadu_pd(in + ii - 1);
+          __m128d cur = _mm_loadu_pd(in + ii);
+          __m128d next = _mm_loadu_pd(in + ii + 1);
+          _mm_storeu_pd(lower + ii, _mm_mul_pd(half, _mm_sub_pd(cur, prev)));
+          _mm_storeu_pd(upper + ii, _mm_mul_pd(half, _mm_sub_pd(next, cur)));
+        }
+        break;
+      case SimdKernel::eLowerBoundBounds:
+        for (; ii + 2 <= end; ii += 2) {
+          _mm_storeu_pd(lower + ii, _mm_loadu_pd(in + ii));
+          _mm_storeu_pd(upper + ii, _mm_loadu_pd(in + ii + 1));
+        }
+        break;
+      case SimdKernel::eLowerBoundSpreads:
+        for (; ii + 2 <= end; ii += 2) {
+          __m128d spread = _mm_mul_pd(half, _mm_sub_pd(_mm_loadu_pd(in + ii + 1), _mm_loadu_pd(in + ii)));
+          _mm_storeu_pd(lower + ii, spread);
+          _mm_storeu_pd(upper + ii, spread);
+        }
+        break;
+    }
+    return ii;
+  }
+
+  __attribute__((target("avx2")))
+  size_type computeAvx2(SimdKernel::Operation_e op, const double * in, size_type begin, size_type end, double * lower,
+    double * upper) {
+    const __m256d half = _mm256_set1_pd(.5);
+    size_type ii = begin;
+    switch (op) {
+      case SimdKernel::eValueBounds:
+        for (; ii + 4 <= end; ii += 4) {
+          __m256d prev = _mm256_loadu_pd(in + ii - 1);
+          __m256d cur = _mm256_loadu_pd(in + ii);
+          __m256d next = _mm256_loadu_pd(in + ii + 1);
+          _mm256_storeu_pd(lower + ii, _mm256_sub_pd(cur, _mm256_mul_pd(half, _mm256_sub_pd(cur, prev))));
+          _mm256_storeu_pd(upper + ii, _mm256_add_pd(cur, _mm256_mul_pd(half, _mm256_sub_pd(next, cur))));
+        }
+        break;
+      case SimdKernel::eValueSpreads:
+        for (; ii + 4 <= end; ii += 4) {
+          __m256d prev = _mm256_loadu_pd(in + ii - 1);
+          __m256d cur = _mm256_loadu_pd(in + ii);
+          __m256d next = _mm256_loadu_pd(in + ii + 1);
+          _mm256_storeu_pd(lower + ii, _mm256_mul_pd(half, _mm256_sub_pd(cur, prev)));
+          _mm256_storeu_pd(upper + ii, _mm256_mul_pd(half, _mm256_sub_pd(next, cur)));
+        }
+        break;
+      case SimdKernel::eLowerBoundBounds:
+        for (; ii + 4 <= end; ii += 4) {
+          _mm256_storeu_pd(lower + ii, _mm256_loadu_pd(in + ii));
+          _mm256_storeu_pd(upper + ii, _mm256_loadu_pd(in + ii + 1));
+        }
+        break;
+      case SimdKernel::eLowerBoundSpreads:
+        for (; ii + 4 <= end; ii += 4) {
+          __m256d spread = _mm256_mul_pd(half, _mm256_sub_pd(_mm256_loadu_pd(in + ii + 1), _mm256_loadu_pd(in + ii)));
+          _mm256_storeu_pd(lower + ii, spread);
+          _mm256_storeu_pd(upper + ii, spread);
+        }
+        break;
+    }
+    return ii;
+  }
+#endif
+
+  // Each gap finder sets the bits of one mask word for the count comparisons of upper[ii] with lower[ii + 1] starting
+  // at ii == 0, and returns the number of comparisons it made, which is less than count when fewer than one vector
+  // width remains. The remainder is then finished by the scalar implementation.
+  size_type findGapsScalar(const double * lower, const double * upper, size_type begin, size_type count,
+    unsigned long long & word) {
+    for (size_type ii = begin; ii != count; ++ii) {
+      if (upper[ii] < lower[ii + 1]) word |= 1ull << ii;
+    }
+    return count;
+  }
+
+  unsigned long countBits(unsigned long long word) {
+#ifdef __GNUC__
+    return __builtin_popcountll(word);
+#else
+    unsigned long count = 0;
+    for (; 0 != word; word &= word - 1) ++count;
+    return count;
+#endif
+  }
+
+#ifdef ST_GRAPH_X86_SIMD
+  __attribute__((target("sse2")))
+  size_type findGapsSse2(const double * lower, const double * upper, size_type count, unsigned long long & word) {
+    size_type ii = 0;
+    for (; ii + 2 <= count; ii += 2) {
+      __m128d gap = _mm_cmplt_pd(_mm_loadu_pd(upper + ii), _mm_loadu_pd(lower + ii + 1));
+      word |= (unsigned long long)(_mm_movemask_pd(gap)) << ii;
+    }
+    return ii;
+  }
+
+  __attribute__((target("avx2")))
+  size_type findGapsAvx2(const double * lower, const double * upper, size_type count, unsigned long long & word) {
+    size_type ii = 0;
+    for (; ii + 4 <= count; ii += 4) {
+      __m256d gap = _mm256_cmp_pd(_mm256_loadu_pd(upper + ii), _mm256_loadu_pd(lower + ii + 1), _CMP_LT_OQ);
+      word |= (unsigned long long)(_mm256_movemask_pd(gap)) << ii;
+    }
+    return ii;
+  }
+#endif
+
+  // Each validity checker sets the bits of one mask word for the count elements starting at 0 which are not finite,
+  // or, if positive is true, not greater than 0, and returns the number of elements it checked. Only the bit patterns
+  // of the doubles are examined, so checking NaN never raises floating point exceptions, which may be trapped.
+  const unsigned long long s_exponent_mask = 0x7ff0000000000000ull;
+
+  size_type findInvalidScalar(const double * data, size_type begin, size_type count, bool positive,
+    unsigned long long & word) {
+    for (size_type ii = begin; ii != count; ++ii) {
+      long long bits;
+      std::memcpy(&bits, data + ii, sizeof(bits));
+      bool invalid = s_exponent_mask == (bits & s_exponent_mask) || (positive && bits <= 0);
+      if (invalid) word |= 1ull << ii;
+    }
+    return count;
+  }
+
+#ifdef ST_GRAPH_X86_SIMD
+  __attribute__((target("sse2")))
+  size_type findInvalidSse2(const double * data, size_type count, bool positive, unsigned long long & word) {
+    // SSE2 has no 64-bit integer comparisons, so the tests are made on the high and low 32-bit halves. The exponent
+    // and the sign are in the high half, whose sign bit movemask collects.
+    const __m128i exponent = _mm_set_epi32(0x7ff00000, 0, 0x7ff00000, 0);
+    const __m128i zero = _mm_setzero_si128();
+    size_type ii = 0;
+    for (; ii + 2 <= count; ii += 2) {
+      __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + ii));
+      __m128i invalid = _mm_cmpeq_epi32(_mm_and_si128(bits, exponent), exponent);
+      if (positive) {
+        // Negative if the sign is set; zero if both halves are zero.
+        __m128i is_zero = _mm_cmpeq_epi32(bits, zero);
+        is_zero = _mm_and_si128(is_zero, _mm_shuffle_epi32(is_zero, _MM_SHUFFLE(2, 3, 0, 1)));
+        invalid = _mm_or_si128(invalid, _mm_or_si128(_mm_srai_epi32(bits, 31), is_zero));
+      }
+      word |= (unsigned long long)(_mm_movemask_pd(_mm_castsi128_pd(invalid))) << ii;
+    }
+    return ii;
+  }
+
+  __attribute__((target("avx2")))
+  size_type findInvalidAvx2(const double * data, size_type count, bool positive, unsigned long long & word) {
+    const __m256i exponent = _mm256_set1_epi64x(s_exponent_mask);
+    const __m256i one = _mm256_set1_epi64x(1);
+    size_type ii = 0;
+    for (; ii + 4 <= count; ii += 4) {
+      __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + ii));
+      __m256i invalid = _mm256_cmpeq_epi64(_mm256_and_si256(bits, exponent), exponent);
+      // As signed integers, the bit patterns of doubles which are not greater than 0 are less than 1.
+      if (positive) invalid = _mm256_or_si256(invalid, _mm256_cmpgt_epi64(one, bits));
+      word |= (unsigned long long)(_mm256_movemask_pd(_mm256_castsi256_pd(invalid))) << ii;
+    }
+    return ii;
+  }
+#endif
+
+  // Each finiteness checker examines the count elements of three arrays starting at 0, clears finite if any of them is
+  // infinite or NaN, and returns the number of elements it examined. Masking all but the exponent leaves exactly
+  // +infinity for those elements and a finite number for the others, so the vectorized checkers find the largest masked
+  // element without raising floating point exceptions, and compare it with +infinity once at the end.
+  size_type checkFiniteScalar(const double * value, const double * lower, const double * upper, size_type begin,
+    size_type count, bool & finite) {
+    for (size_type ii = begin; ii != count; ++ii) {
+      long long bits[3];
+      std::memcpy(bits, value + ii, sizeof(bits[0]));
+      std::memcpy(bits + 1, lower + ii, sizeof(bits[0]));
+      std::memcpy(bits + 2, upper + ii, sizeof(bits[0]));
+      for (unsigned int col = 0; col != 3; ++col) {
+        if (s_exponent_mask == (bits[col] & s_exponent_mask)) finite = false;
+      }
+    }
+    return count;
+  }
+
+  // Each summarizer merges the elements [begin, count) into the summary, comparing each of them with the one before it,
+  // so begin must be at least 1, and returns the first element it did not merge. The vectorized implementations leave
+  // fewer than one vector width to be finished by the scalar implementation.
+  size_type summarizeScalar(const double * value, const double * lower, const double * upper, size_type begin,
+    size_type count, SimdKernel::Summary & summary) {
+    for (size_type ii = begin; ii != count; ++ii) {
+      double val = value[ii];
+      double low = lower[ii];
+      double high = upper[ii];
+      if (val < value[ii - 1]) summary.m_non_decreasing = false;
+      if (val > value[ii - 1]) summary.m_non_increasing = false;
+      if (low < upper[ii - 1] || high < low) summary.m_ordered_bins = false;
+      if (val < summary.m_min_value) summary.m_min_value = val;
+      if (val > summary.m_max_value) summary.m_max_value = val;
+      if (0. < val && val < summary.m_min_positive_value) summary.m_min_positive_value = val;
+      if (low < summary.m_min_lower) summary.m_min_lower = low;
+      if (high > summary.m_max_upper) summary.m_max_upper = high;
+      if (0. < low && low < summary.m_min_positive_lower) summary.m_min_positive_lower = low;
+    }
+    return count;
+  }
+
+#ifdef ST_GRAPH_X86_SIMD
+  // Merge the lanes of a vector of minima or maxima into one result.
+  void mergeMin(const double * lane, size_type num_lanes, double & result) {
+    for (size_type ii = 0; ii != num_lanes; ++ii) if (lane[ii] < result) result = lane[ii];
+  }
+
+  void mergeMax(const double * lane, size_type num_lanes, double & result) {
+    for (size_type ii = 0; ii != num_lanes; ++ii) if (lane[ii] > result) result = lane[ii];
+  }
+
+  __attribute__((target("sse2")))
+  size_type checkFiniteSse2(const double * value, const double * lower, const double * upper, size_type count,
+    bool & finite) {
+    const __m128d inf = _mm_set1_pd(std::numeric_limits<double>::infinity());
+    __m128d max_value = _mm_setzero_pd();
+    __m128d max_lower = max_value;
+    __m128d max_upper = max_value;
+    size_type ii = 0;
+    for (; ii + 2 <= count; ii += 2) {
+      max_value = _mm_max_pd(max_value, _mm_and_pd(_mm_loadu_pd(value + ii), inf));
+      max_lower = _mm_max_pd(max_lower, _mm_and_pd(_mm_loadu_pd(lower + ii), inf));
+      max_upper = _mm_max_pd(max_upper, _mm_and_pd(_mm_loadu_pd(upper + ii), inf));
+    }
+    __m128d max_all = _mm_max_pd(max_value, _mm_max_pd(max_lower, max_upper));
+    if (0 != _mm_movemask_pd(_mm_cmpeq_pd(max_all, inf))) finite = false;
+    return ii;
+  }
+
+  __attribute__((target("avx2")))
+  size_type checkFiniteAvx2(const double * value, const double * lower, const double * upper, size_type count,
+    bool & finite) {
+    const __m256d inf = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d max_value = _mm256_setzero_pd();
+    __m256d max_lower = max_value;
+    __m256d max_upper = max_value;
+    size_type ii = 0;
+    for (; ii + 4 <= count; ii += 4) {
+      max_value = _mm256_max_pd(max_value, _mm256_and_pd(_mm256_loadu_pd(value + ii), inf));
+      max_lower = _mm256_max_pd(max_lower, _mm256_and_pd(_mm256_loadu_pd(lower + ii), inf));
+      max_upper = _mm256_max_pd(max_upper, _mm256_and_pd(_mm256_loadu_pd(upper + ii), inf));
+    }
+    __m256d max_all = _mm256_max_pd(max_value, _mm256_max_pd(max_lower, max_upper));
+    if (0 != _mm256_movemask_pd(_mm256_cmp_pd(max_all, inf, _CMP_EQ_OQ))) finite = false;
+    return ii;
+  }
+
+  // The orderings are found by comparing each vector of elements with the vector starting one element earlier. Elements
+  // which are not greater than 0 are replaced by +infinity before taking the positive minima.
+  __attribute__((target("sse2")))
+  size_type summarizeSse2(const double * value, const double * lower, const double * upper, size_type begin,
+    size_type count, SimdKernel::Summary & summary) {
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d inf = _mm_set1_pd(std::numeric_limits<double>::infinity());
+    __m128d min_value = inf;
+    __m128d max_value = _mm_sub_pd(zero, inf);
+    __m128d min_positive_value = inf;
+    __m128d min_lower = inf;
+    __m128d max_upper = max_value;
+    __m128d min_positive_lower = inf;
+    __m128d decreasing = zero;
+    __m128d increasing = zero;
+    __m128d unordered = zero;
+    size_type ii = begin;
+    for (; ii + 2 <= count; ii += 2) {
+      __m128d val = _mm_loadu_pd(value + ii);
+      __m128d low = _mm_loadu_pd(lower + ii);
+      __m128d high = _mm_loadu_pd(upper + ii);
+      __m128d prev_val = _mm_loadu_pd(value + ii - 1);
+      decreasing = _mm_or_pd(decreasing, _mm_cmplt_pd(val, prev_val));
+      increasing = _mm_or_pd(increasing, _mm_cmpgt_pd(val, prev_val));
+      unordered = _mm_or_pd(unordered, _mm_or_pd(_mm_cmplt_pd(low, _mm_loadu_pd(upper + ii - 1)),
+        _mm_cmplt_pd(high, low)));
+      min_value = _mm_min_pd(min_value, val);
+      max_value = _mm_max_pd(max_value, val);
+      __m128d positive = _mm_cmpgt_pd(val, zero);
+      min_positive_value = _mm_min_pd(min_positive_value,
+        _mm_or_pd(_mm_and_pd(positive, val), _mm_andnot_pd(positive, inf)));
+      min_lower = _mm_min_pd(min_lower, low);
+      max_upper = _mm_max_pd(max_upper, high);
+      positive = _mm_cmpgt_pd(low, zero);
+      min_positive_lower = _mm_min_pd(min_positive_lower,
+        _mm_or_pd(_mm_and_pd(positive, low), _mm_andnot_pd(positive, inf)));
+    }
+    if (0 != _mm_movemask_pd(decreasing)) summary.m_non_decreasing = false;
+    if (0 != _mm_movemask_pd(increasing)) summary.m_non_increasing = false;
+    if (0 != _mm_movemask_pd(unordered)) summary.m_ordered_bins = false;
+    double lane[2];
+    _mm_storeu_pd(lane, min_value);
+    mergeMin(lane, 2, summary.m_min_value);
+    _mm_storeu_pd(lane, max_value);
+    mergeMax(lane, 2, summary.m_max_value);
+    _mm_storeu_pd(lane, min_positive_value);
+    mergeMin(lane, 2, summary.m_min_positive_value);
+    _mm_storeu_pd(lane, min_lower);
+    mergeMin(lane, 2, summary.m_min_lower);
+    _mm_storeu_pd(lane, max_upper);
+    mergeMax(lane, 2, summary.m_max_upper);
+    _mm_storeu_pd(lane, min_positive_lower);
+    mergeMin(lane, 2, summary.m_min_positive_lower);
+    return ii;
+  }
+
+  __attribute__((target("avx2")))
+  size_type summarizeAvx2(const double * value, const double * lower, const double * upper, size_type begin,
+    size_type count, SimdKernel::Summary & summary) {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d inf = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d min_value = inf;
+    __m256d max_value = _mm256_sub_pd(zero, inf);
+    __m256d min_positive_value = inf;
+    __m256d min_lower = inf;
+    __m256d max_upper = max_value;
+    __m256d min_positive_lower = inf;
+    __m256d decreasing = zero;
+    __m256d increasing = zero;
+    __m256d unordered = zero;
+    size_type ii = begin;
+    for (; ii + 4 <= count; ii += 4) {
+      __m256d val = _mm256_loadu_pd(value + ii);
+      __m256d low = _mm256_loadu_pd(lower + ii);
+      __m256d high = _mm256_loadu_pd(upper + ii);
+      __m256d prev_val = _mm256_loadu_pd(value + ii - 1);
+      decreasing = _mm256_or_pd(decreasing, _mm256_cmp_pd(val, prev_val, _CMP_LT_OQ));
+      increasing = _mm256_or_pd(increasing, _mm256_cmp_pd(val, prev_val, _CMP_GT_OQ));
+      unordered = _mm256_or_pd(unordered, _mm256_or_pd(_mm256_cmp_pd(low, _mm256_loadu_pd(upper + ii - 1), _CMP_LT_OQ),
+        _mm256_cmp_pd(high, low, _CMP_LT_OQ)));
+      min_value = _mm256_min_pd(min_value, val);
+      max_value = _mm256_max_pd(max_value, val);
+      min_positive_value = _mm256_min_pd(min_positive_value,
+        _mm256_blendv_pd(inf, val, _mm256_cmp_pd(val, zero, _CMP_GT_OQ)));
+      min_lower = _mm256_min_pd(min_lower, low);
+      max_upper = _mm256_max_pd(max_upper, high);
+      min_positive_lower = _mm256_min_pd(min_positive_lower,
+        _mm256_blendv_pd(inf, low, _mm256_cmp_pd(low, zero, _CMP_GT_OQ)));
+    }
+    if (0 != _mm256_movemask_pd(decreasing)) summary.m_non_decreasing = false;
+    if (0 != _mm256_movemask_pd(increasing)) summary.m_non_increasing = false;
+    if (0 != _mm256_movemask_pd(unordered)) summary.m_ordered_bins = false;
+    double lane[4];
+    _mm256_storeu_pd(lane, min_value);
+    mergeMin(lane, 4, summary.m_min_value);
+    _mm256_storeu_pd(lane, max_value);
+    mergeMax(lane, 4, summary.m_max_value);
+    _mm256_storeu_pd(lane, min_positive_value);
+    mergeMin(lane, 4, summary.m_min_positive_value);
+    _mm256_storeu_pd(lane, min_lower);
+    mergeMin(lane, 4, summary.m_min_lower);
+    _mm256_storeu_pd(lane, max_upper);
+    mergeMax(lane, 4, summary.m_max_upper);
+    _mm256_storeu_pd(lane, min_positive_lower);
+    mergeMin(lane, 4, summary.m_min_positive_lower);
+    return ii;
+  }
+#endif
+
+  SimdKernel::InstructionSet_e detectInstructionSet() {
+#ifdef ST_GRAPH_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdKernel::eAvx2;
+    if (__builtin_cpu_supports("sse2")) return SimdKernel::eSse2;
+#endif
+    return SimdKernel::eScalar;
+  }
+
+}
+
+namespace st_graph {
+
+  void SimdKernel::computeInterior(Operation_e op, const double * in, unsigned long size, double * lower, double * upper,
+    InstructionSet_e iset) {
+    if (size < 3) return;
+    size_type end = size - 1;
+    size_type ii = 1;
+
+    InstructionSet_e best = bestInstructionSet();
+    if (iset > best) iset = best;
+
+#ifdef ST_GRAPH_X86_SIMD
+    if (eAvx2 == iset) ii = computeAvx2(op, in, ii, end, lower, upper);
+    else if (eSse2 == iset) ii = computeSse2(op, in, ii, end, lower, upper);
+#endif
+
+    // Finish whatever remains with the scalar formulas.
+    computeScalar(op, in, ii, end, lower, upper);
+  }
+
+  unsigned long SimdKernel::findGaps(const double * lower, const double * upper, unsigned long size,
+    unsigned long long * mask, InstructionSet_e iset) {
+    InstructionSet_e best = bestInstructionSet();
+    if (iset > best) iset = best;
+
+    // The last interval has no neighbor, so size - 1 comparisons are made, 64 per word of the mask.
+    unsigned long num_gaps = 0;
+    for (size_type base = 0; base < size; base += 64) {
+      size_type count = size - 1 - base < 64 ? size - 1 - base : 64;
+      unsigned long long word = 0;
+      size_type ii = 0;
+#ifdef ST_GRAPH_X86_SIMD
+      if (eAvx2 == iset) ii = findGapsAvx2(lower + base, upper + base, count, word);
+      else if (eSse2 == iset) ii = findGapsSse2(lower + base, upper + base, count, word);
+#endif
+      findGapsScalar(lower + base, upper + base, ii, count, word);
+      mask[base / 64] = word;
+      num_gaps += countBits(word);
+    }
+    return num_gaps;
+  }
+
+  void SimdKernel::findInvalid(const double * data, unsigned long size, bool positive, unsigned long long * mask,
+    InstructionSet_e iset) {
+    InstructionSet_e best = bestInstructionSet();
+    if (iset > best) iset = best;
+
+    for (size_type base = 0; base < size; base += 64) {
+      size_type count = size - base < 64 ? size - base : 64;
+      unsigned long long word = 0;
+      size_type ii = 0;
+#ifdef ST_GRAPH_X86_SIMD
+      if (eAvx2 == iset) ii = findInvalidAvx2(data + base, count, positive, word);
+      else if (eSse2 == iset) ii = findInvalidSse2(data + base, count, positive, word);
+#endif
+      findInvalidScalar(data + base, ii, count, positive, word);
+      mask[base / 64] |= word;
+    }
+  }
+
+  bool SimdKernel::summarizeFinite(const double * value, const double * lower, const double * upper,
+    unsigned long size, Summary & summary, InstructionSet_e iset) {
+    InstructionSet_e best = bestInstructionSet();
+    if (iset > best) iset = best;
+
+    // Check all the elements first, so that the comparisons below never see infinities or NaN.
+    bool finite = true;
+    size_type ii = 0;
+#ifdef ST_GRAPH_X86_SIMD
+    if (eAvx2 == iset) ii = checkFiniteAvx2(value, lower, upper, size, finite);
+    else if (eSse2 == iset) ii = checkFiniteSse2(value, lower, upper, size, finite);
+#endif
+    checkFiniteScalar(value, lower, upper, ii, size, finite);
+    if (!finite) return false;
+
+    // The first element has no predecessor in the block, so it just starts the ranges.
+    summary.m_min_value = value[0];
+    summary.m_max_value = value[0];
+    summary.m_min_positive_value = 0. < value[0] ? value[0] : std::numeric_limits<double>::infinity();
+    summary.m_min_lower = lower[0];
+    summary.m_max_upper = upper[0];
+    summary.m_min_positive_lower = 0. < lower[0] ? lower[0] : std::numeric_limits<double>::infinity();
+    summary.m_non_decreasing = true;
+    summary.m_non_increasing = true;
+    summary.m_ordered_bins = !(upper[0] < lower[0]);
+
+    ii = 1;
+#ifdef ST_GRAPH_X86_SIMD
+    if (eAvx2 == iset) ii = summarizeAvx2(value, lower, upper, ii, size, summary);
+    else if (eSse2 == iset) ii = summarizeSse2(value, lower, upper, ii, size, summary);
+#endif
+    summarizeScalar(value, lower, upper, ii, size, summary);
+    return true;
+  }
+
+  SimdKernel::InstructionSet_e SimdKernel::bestInstructionSet() {
+    static const InstructionSet_e s_best = detectInstructionSet();
+    return s_best;
+  }
+
+  const char * SimdKernel::getName(InstructionSet_e iset) {
+    switch (iset) {
+      case eScalar: return "scalar";
+      case eSse2: return "sse2";
+      case eAvx2: return "avx2";
+      default: return "best";
+    }
+  }
+
+}
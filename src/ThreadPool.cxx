@@ -0,0 +1,109 @@
+/** \file ThreadPool.cxx
+    \brief Implementation of ThreadPool class.
+*/
+#include "st_graph/ThreadPool.h"
+
+namespace {
+
+  // Set in threads while they work on the tasks of a pool, so that tasks which call run again do not wait for
+  // themselves.
+  thread_local bool s_in_pool = false;
+
+}
+
+namespace st_graph {
+
+  ThreadPool & ThreadPool::instance() {
+    static ThreadPool s_pool(std::thread::hardware_concurrency());
+    return s_pool;
+  }
+
+  ThreadPool::ThreadPool(unsigned int num_threads): m_workers(), m_run_mutex(), m_mutex(), m_start(), m_done(),
+    m_task(0), m_num_tasks(0), m_next_task(0), m_error(), m_generation(0), m_num_busy(0), m_stop(false) {
+    try {
+      for (unsigned int ii = 1; ii < num_threads; ++ii) m_workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+    } catch (...) {
+      // Threads could not be started: stop those which were.
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+      }
+      m_start.notify_all();
+      for (std::vector<std::thread>::iterator itor = m_workers.begin(); itor != m_workers.end(); ++itor) itor->join();
+      throw;
+    }
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_start.notify_all();
+    for (std::vector<std::thread>::iterator itor = m_workers.begin(); itor != m_workers.end(); ++itor) itor->join();
+  }
+
+  void ThreadPool::run(size_type num_tasks, const ITask & task) {
+    std::unique_lock<std::mutex> run_lock(m_run_mutex, std::defer_lock);
+    if (2 > num_tasks || m_workers.empty() || s_in_pool || !run_lock.try_lock()) {
+      for (size_type index = 0; index != num_tasks; ++index) task(index);
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_task = &task;
+      m_num_tasks = num_tasks;
+      m_next_task = 0;
+      m_error = std::exception_ptr();
+      m_num_busy = m_workers.size();
+      ++m_generation;
+    }
+    m_start.notify_all();
+
+    work();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (0 != m_num_busy) m_done.wait(lock);
+    m_task = 0;
+    if (m_error) {
+      std::exception_ptr error(m_error);
+      m_error = std::exception_ptr();
+      std::rethrow_exception(error);
+    }
+  }
+
+  void ThreadPool::workerLoop() {
+    unsigned long generation = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop && generation == m_generation) m_start.wait(lock);
+        if (m_stop) return;
+        generation = m_generation;
+      }
+      work();
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_num_busy;
+      }
+      m_done.notify_one();
+    }
+  }
+
+  void ThreadPool::work() {
+    s_in_pool = true;
+    for (size_type index = m_next_task++; index < m_num_tasks; index = m_next_task++) {
+      try {
+        (*m_task)(index);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_error) m_error = std::current_exception();
+        // Skip the tasks which have not been started.
+        m_next_task = m_num_tasks;
+      }
+    }
+    s_in_pool = false;
+  }
+
+}
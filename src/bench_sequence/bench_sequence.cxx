@@ -0,0 +1,294 @@
+/** \file bench_sequence.cxx
+    \brief Benchmark of bulk extraction from the sequence templates, over several container types, element types
+           and sizes. Results are written to standard output as JSON, one record per sequence, container, element
+           type, size and extraction method, so that they may be compared between releases.
+
+           Usage: bench_sequence [max_size [min_size]]. Sizes run in powers of 10 from min_size (default 10^3) to
+           max_size (default 10^8). The largest sizes need several GB of memory.
+*/
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "st_graph/CompressedSequence.h"
+#include "st_graph/Sequence.h"
+#include "st_graph/ThreadPool.h"
+
+namespace {
+
+  // Count the bytes allocated through operator new, so that the memory used by each extraction can be reported. The
+  // count is atomic because extractions allocate from ThreadPool workers too.
+  std::atomic<unsigned long long> s_bytes_allocated(0);
+
+}
+
+// Every form of operator new and delete is replaced, so that each allocation is freed by the matching function.
+void * operator new(std::size_t size) {
+  s_bytes_allocated += size;
+  void * ptr = std::malloc(0 != size ? size : 1);
+  if (0 == ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void * operator new[](std::size_t size) { return operator new(size); }
+
+// Deallocation is kept out of line: if free were inlined into callers, GCC would see memory from operator new released
+// by free, and warn about mismatched allocation functions.
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+void operator delete(void * ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void * ptr) noexcept { operator delete(ptr); }
+
+void operator delete(void * ptr, std::size_t) noexcept { operator delete(ptr); }
+
+void operator delete[](void * ptr, std::size_t) noexcept { operator delete(ptr); }
+
+namespace {
+
+  typedef std::vector<double> Vec_t;
+
+  /** \class JsonWriter
+      \brief Writes benchmark results as a JSON document with an array of flat records.
+  */
+  class JsonWriter {
+    public:
+      JsonWriter(std::ostream & os): m_os(os), m_num_records(0) {
+        m_os << "{\n  \"benchmark\": \"bench_sequence\",\n  \"num_threads\": " <<
+          st_graph::ThreadPool::instance().getNumThreads() << ",\n  \"results\": [";
+      }
+
+      ~JsonWriter() { m_os << (0 != m_num_records ? "\n  ]\n}" : "]\n}") << std::endl; }
+
+      /** \brief Write one record, whose fields are already formatted as "name": value pairs separated by commas.
+          \param fields The fields of the record.
+      */
+      void write(const std::string & fields) {
+        m_os << (0 != m_num_records ? ",\n    {" : "\n    {") << fields << "}";
+        m_os.flush();
+        ++m_num_records;
+      }
+
+    private:
+      std::ostream & m_os;
+      unsigned long m_num_records;
+  };
+
+  /** \struct Case
+      \brief Description of the data being benchmarked, shared by all records for the same data.
+  */
+  struct Case {
+    const char * m_container;
+    const char * m_element;
+    unsigned long m_size;
+  };
+
+  /** \class Extraction
+      \brief Performs one bulk extraction from a sequence. Unqualified calls dispatch to the most derived class;
+             qualified calls use the generic implementation of Base_t, e.g. the per-element virtual path of
+             ScalarSequence.
+  */
+  template <typename Base_t>
+  class Extraction {
+    public:
+      Extraction(const Base_t & seq, int method, bool qualified, Vec_t & out1, Vec_t & out2): m_seq(seq),
+        m_method(method), m_qualified(qualified), m_out1(out1), m_out2(out2) {}
+
+      void operator ()() const {
+        if (m_qualified) {
+          if (0 == m_method) m_seq.Base_t::getValues(m_out1);
+          else if (1 == m_method) m_seq.Base_t::getIntervals(m_out1, m_out2);
+          else m_seq.Base_t::getSpreads(m_out1, m_out2);
+        } else {
+          if (0 == m_method) m_seq.getValues(m_out1);
+          else if (1 == m_method) m_seq.getIntervals(m_out1, m_out2);
+          else m_seq.getSpreads(m_out1, m_out2);
+        }
+      }
+
+    private:
+      const Base_t & m_seq;
+      int m_method;
+      bool m_qualified;
+      Vec_t & m_out1;
+      Vec_t & m_out2;
+  };
+
+  /** \brief Return the fastest time in nanoseconds per element taken by the given extraction over several trials.
+          The output containers are sized by the first call, so that allocation is not part of the measurement.
+      \param extract Function object which performs one extraction.
+      \param num_elements Number of elements extracted per trial.
+  */
+  template <typename Extract_t>
+  double timeExtraction(const Extract_t & extract, unsigned long num_elements) {
+    const int num_trials = num_elements >= 10000000ul ? 2 : 5;
+    extract();
+    double best = 0.;
+    for (int trial = 0; trial != num_trials; ++trial) {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      extract();
+      std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      if (0 == trial || elapsed.count() < best) best = elapsed.count();
+    }
+    return 0 != num_elements ? best / num_elements : 0.;
+  }
+
+  /** \brief Benchmark the three extraction methods of one sequence, and write a record for each.
+      \param seq The sequence to benchmark.
+      \param name The name of the sequence template.
+      \param test_case Description of the data.
+      \param compare_virtual Whether also to time the generic implementation of Base_t.
+      \param writer The output.
+  */
+  template <typename Base_t>
+  void benchSequence(const Base_t & seq, const char * name, const Case & test_case, bool compare_virtual,
+    JsonWriter & writer) {
+    static const char * method_name[] = { "getValues", "getIntervals", "getSpreads" };
+    for (int method = 0; method != 3; ++method) {
+      // Bytes allocated by an extraction into empty containers, including the containers themselves.
+      unsigned long long bytes_allocated = 0;
+      {
+        Vec_t out1;
+        Vec_t out2;
+        bytes_allocated = s_bytes_allocated;
+        Extraction<Base_t>(seq, method, false, out1, out2)();
+        bytes_allocated = s_bytes_allocated - bytes_allocated;
+      }
+
+      // Time extractions into reused containers, as when a plot is redisplayed, and count what they still allocate.
+      Vec_t out1;
+      Vec_t out2;
+      Extraction<Base_t> extract(seq, method, false, out1, out2);
+      extract();
+      unsigned long long reuse_bytes_allocated = s_bytes_allocated;
+      double ns = timeExtraction(extract, test_case.m_size);
+      reuse_bytes_allocated = s_bytes_allocated - reuse_bytes_allocated;
+
+      std::ostringstream os;
+      os << "\"sequence\": \"" << name << "\", \"container\": \"" << test_case.m_container << "\", \"element\": \"" <<
+        test_case.m_element << "\", \"size\": " << test_case.m_size << ", \"method\": \"" << method_name[method] <<
+        "\", \"ns_per_element\": " << ns << ", \"bytes_allocated\": " << bytes_allocated <<
+        ", \"bytes_allocated_on_reuse\": " << reuse_bytes_allocated;
+      if (compare_virtual)
+        os << ", \"virtual_ns_per_element\": " <<
+          timeExtraction(Extraction<Base_t>(seq, method, true, out1, out2), test_case.m_size);
+      writer.write(os.str());
+    }
+  }
+
+  /** \brief Benchmark every sequence template over one range of iterators.
+      \param begin The first iterator of the first input range.
+      \param end One past the last iterator of the first input range.
+      \param second_begin The first iterator of the second input range, used for spreads and upper bounds.
+      \param test_case Description of the data.
+      \param writer The output.
+  */
+  template <typename Itor_t>
+  void benchTemplates(const Itor_t & begin, const Itor_t & end, const Itor_t & second_begin, const Case & test_case,
+    JsonWriter & writer) {
+    using namespace st_graph;
+    benchSequence<ScalarSequence<Itor_t> >(PointSequence<Itor_t>(begin, end), "PointSequence", test_case, true, writer);
+    benchSequence<ScalarSequence<Itor_t> >(ValueSequence<Itor_t>(begin, end), "ValueSequence", test_case, true, writer);
+    benchSequence<ScalarSequence<Itor_t> >(LowerBoundSequence<Itor_t>(begin, end), "LowerBoundSequence", test_case,
+      true, writer);
+    benchSequence(ValueSpreadSequence<Itor_t>(begin, end, second_begin), "ValueSpreadSequence", test_case, false,
+      writer);
+    benchSequence(IntervalSequence<Itor_t>(begin, end, second_begin), "IntervalSequence", test_case, false, writer);
+  }
+
+  /** \brief Benchmark compressed columns and the sequences which read them, whose throughput may be compared with
+             that of the same templates reading uncompressed data.
+      \param data The uncompressed data.
+      \param test_case Description of the data.
+      \param writer The output.
+  */
+  template <typename T>
+  void benchCompressed(const std::vector<T> & data, const Case & test_case, JsonWriter & writer) {
+    using namespace st_graph;
+    CompressedColumn column(data.begin(), data.end());
+
+    // Plain decoding of the whole column, and the memory it saves.
+    Vec_t out(data.size());
+    struct Decode {
+      const CompressedColumn & m_column; Vec_t & m_out;
+      void operator ()() const { m_column.decode(0, m_out.size(), m_out.data()); }
+    };
+    Decode decode = { column, out };
+    std::ostringstream os;
+    os << "\"sequence\": \"CompressedColumn\", \"container\": \"" << test_case.m_container << "\", \"element\": \"" <<
+      test_case.m_element << "\", \"size\": " << test_case.m_size << ", \"method\": \"decode\", \"ns_per_element\": " <<
+      timeExtraction(decode, test_case.m_size) << ", \"bytes_stored\": " << column.getMemoryUsage() <<
+      ", \"bytes_uncompressed\": " << data.size() * sizeof(double);
+    writer.write(os.str());
+
+    benchSequence(CompressedPointSequence(column), "CompressedPointSequence", test_case, false, writer);
+    benchSequence(CompressedValueSequence(column), "CompressedValueSequence", test_case, false, writer);
+    benchSequence(CompressedLowerBoundSequence(column), "CompressedLowerBoundSequence", test_case, false, writer);
+  }
+
+  /** \brief Benchmark every sequence template over vectors, deques and raw pointers holding elements of type T, and
+             over compressed columns.
+      \param size The number of elements.
+      \param element The name of type T.
+      \param writer The output.
+  */
+  template <typename T>
+  void benchElementType(unsigned long size, const char * element, JsonWriter & writer) {
+    // Monotone data with irregular spacing, as for bin edges, and a second column holding upper bounds, which also
+    // serve as positive spreads.
+    std::vector<T> data(size);
+    std::vector<T> second(size);
+    double edge = 0.;
+    for (unsigned long ii = 0; ii != size; ++ii) {
+      data[ii] = T(edge);
+      edge += 1. + (ii % 7) * .125;
+      second[ii] = T(edge);
+    }
+
+    Case vector_case = { "vector", element, size };
+    benchTemplates(data.cbegin(), data.cend(), second.cbegin(), vector_case, writer);
+
+    const T * begin = data.empty() ? 0 : &data[0];
+    Case pointer_case = { "pointer", element, size };
+    benchTemplates(begin, begin + size, second.empty() ? begin : &second[0], pointer_case, writer);
+
+    std::deque<T> data_deque(data.begin(), data.end());
+    std::deque<T> second_deque(second.begin(), second.end());
+    Case deque_case = { "deque", element, size };
+    benchTemplates(data_deque.cbegin(), data_deque.cend(), second_deque.cbegin(), deque_case, writer);
+
+    Case compressed_case = { "compressed", element, size };
+    benchCompressed(data, compressed_case, writer);
+  }
+
+}
+
+int main(int argc, char ** argv) {
+  // Range of sizes may be given on the command line.
+  unsigned long max_size = 100000000ul;
+  unsigned long min_size = 1000ul;
+  if (argc > 1) max_size = std::strtoul(argv[1], 0, 10);
+  if (argc > 2) min_size = std::strtoul(argv[2], 0, 10);
+  if (0 == min_size) min_size = 1;
+
+  try {
+    JsonWriter writer(std::cout);
+    for (unsigned long size = min_size; size <= max_size; size *= 10) {
+      benchElementType<double>(size, "double", writer);
+      benchElementType<float>(size, "float", writer);
+      if (size > max_size / 10) break;
+    }
+  } catch (const std::exception & x) {
+    std::cerr << "bench_sequence: " << x.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
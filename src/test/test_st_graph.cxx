@@ -5,9 +5,20 @@
 #ifdef BUILD_WITHOUT_ROOT
 #include <Python.h>
 #endif
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <list>
+#include <memory>
 #include <cmath>
+#include <new>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -17,20 +28,161 @@
 #include <unistd.h>
 #endif
 
+#include "fitsio.h"
+
 #include "hoops/hoops_prompt_group.h"
 #include "st_graph/Axis.h"
+#include "st_graph/CompressedSequence.h"
 #include "st_graph/Engine.h"
+#include "st_graph/EventHistogrammer.h"
+#include "st_graph/DecimatedSequence.h"
+#include "st_graph/FitsColumnSequence.h"
 #include "st_graph/IEventReceiver.h"
 #include "st_graph/IFrame.h"
 #include "st_graph/IPlot.h"
 #include "st_graph/ITabFolder.h"
+#include "st_graph/MappedColumn.h"
+#include "st_graph/OwningSequence.h"
+#include "st_graph/RingSequence.h"
 #include "st_graph/Placer.h"
 #include "st_graph/Sequence.h"
+#include "st_graph/SequenceBufferPool.h"
+#include "st_graph/SequenceExpression.h"
+#include "st_graph/SimdKernel.h"
 
 #include "st_graph/StGui.h"
+#include "st_graph/StridedSequence.h"
+#include "st_graph/ThreadPool.h"
 #include "st_stream/StreamFormatter.h"
 #include "st_stream/st_stream.h"
 
+namespace {
+  // Number of calls to the global operator new, used to check that code under test does not allocate memory. The
+  // count is atomic because ThreadPool workers allocate too.
+  std::atomic<unsigned long> s_num_allocations(0);
+
+  // Thread pool task which stores the square of each index, optionally throwing for one of them, and optionally
+  // running a nested set of tasks on the same pool from each task.
+  class SquareTask : public st_graph::ThreadPool::ITask {
+    public:
+      SquareTask(st_graph::ThreadPool & pool, std::vector<unsigned long> & out, unsigned long throw_index,
+        bool nested): m_pool(pool), m_out(out), m_throw_index(throw_index), m_nested(nested) {}
+
+      virtual void operator ()(st_graph::ThreadPool::size_type index) const {
+        if (m_throw_index == index) throw std::runtime_error("SquareTask: requested failure");
+        if (m_nested) {
+          std::vector<unsigned long> inner(3);
+          m_pool.run(inner.size(), SquareTask(m_pool, inner, inner.size(), false));
+          m_out[index] = index * index + inner[2] - 4;
+        } else {
+          m_out[index] = index * index;
+        }
+      }
+
+    private:
+      st_graph::ThreadPool & m_pool;
+      std::vector<unsigned long> & m_out;
+      unsigned long m_throw_index;
+      bool m_nested;
+  };
+
+  // Thread pool task which fills a weighted histogram from inside the pool, where the histogrammer cannot use other
+  // threads, storing the values and spreads for each index.
+  class WeightedFillTask : public st_graph::ThreadPool::ITask {
+    public:
+      WeightedFillTask(const st_graph::EventHistogrammer & hist, const std::vector<double> & event,
+        const std::vector<double> & weight, std::vector<std::vector<double> > & value,
+        std::vector<std::vector<double> > & spread): m_hist(hist), m_event(event), m_weight(weight), m_value(value),
+        m_spread(spread) {}
+
+      virtual void operator ()(st_graph::ThreadPool::size_type index) const {
+        std::vector<double> upper_spread;
+        m_hist.fillWeighted(m_event, m_weight).getSpreads(m_spread[index], upper_spread);
+        m_hist.fillWeighted(m_event, m_weight).getValues(m_value[index]);
+      }
+
+    private:
+      const st_graph::EventHistogrammer & m_hist;
+      const std::vector<double> & m_event;
+      const std::vector<double> & m_weight;
+      std::vector<std::vector<double> > & m_value;
+      std::vector<std::vector<double> > & m_spread;
+  };
+
+  // Thread pool task which extracts the values of its own copy of a sequence, for each index.
+  class CopyValuesTask : public st_graph::ThreadPool::ITask {
+    public:
+      CopyValuesTask(const st_graph::ISequence & seq, std::vector<std::vector<double> > & value): m_seq(seq),
+        m_value(value) {}
+
+      virtual void operator ()(st_graph::ThreadPool::size_type index) const {
+        std::unique_ptr<st_graph::ISequence> copy(m_seq.clone());
+        copy->getValues(m_value[index]);
+      }
+
+    private:
+      const st_graph::ISequence & m_seq;
+      std::vector<std::vector<double> > & m_value;
+  };
+
+  // Sequence which implements only the original interface of ISequence, as client subclasses written before ranges
+  // were introduced do, counting how many times it is extracted whole. Each element spans its value +/- .5.
+  class PlainSequence : public st_graph::ISequence {
+    public:
+      PlainSequence(const std::vector<double> & value): ISequence(value.size()), m_value(value),
+        m_num_extractions(0) {}
+
+      virtual void getValues(std::vector<double> & val) const { ++m_num_extractions; val = m_value; }
+
+      virtual void getIntervals(std::vector<double> & lower, std::vector<double> & upper) const {
+        ++m_num_extractions;
+        lower.resize(m_value.size());
+        upper.resize(m_value.size());
+        for (size_type ii = 0; ii != m_value.size(); ++ii) {
+          lower[ii] = m_value[ii] - .5;
+          upper[ii] = m_value[ii] + .5;
+        }
+      }
+
+      virtual void getSpreads(std::vector<double> & lower, std::vector<double> & upper) const {
+        ++m_num_extractions;
+        lower.assign(m_value.size(), .5);
+        upper.assign(m_value.size(), .5);
+      }
+
+      virtual st_graph::ISequence * clone() const { return new PlainSequence(*this); }
+
+      unsigned long getNumExtractions() const { return m_num_extractions; }
+
+    private:
+      std::vector<double> m_value;
+      mutable unsigned long m_num_extractions;
+  };
+}
+
+// Every form of operator new and delete is replaced, so that each allocation is freed by the matching function.
+void * operator new(std::size_t size) {
+  ++s_num_allocations;
+  void * ptr = std::malloc(0 == size ? 1 : size);
+  if (0 == ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void * operator new[](std::size_t size) { return operator new(size); }
+
+// Deallocation is kept out of line: if free were inlined into callers, GCC would see memory from operator new released
+// by free, and warn about mismatched allocation functions.
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+void operator delete(void * ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void * ptr) noexcept { operator delete(ptr); }
+
+void operator delete(void * ptr, std::size_t) noexcept { operator delete(ptr); }
+
+void operator delete[](void * ptr, std::size_t) noexcept { operator delete(ptr); }
+
 /** \class StGraphTestApp
     \brief Test application class.
 */
@@ -58,6 +210,57 @@ class StGraphTestApp {
     /// \brief Test the Sequence template class.
     virtual void testSequence();
 
+    /// \brief Test reuse of extraction buffers by SequenceBufferPool.
+    virtual void testBufferPool();
+
+    /// \brief Test sequences which read memory-mapped files.
+    virtual void testMappedColumn();
+
+    /// \brief Test sequences which stream columns from FITS tables.
+    virtual void testFitsColumnSequence();
+
+    /// \brief Test sequences which own their data in shared columns.
+    virtual void testOwningSequence();
+
+    /// \brief Test decimation of sequences for display.
+    virtual void testDecimatedSequence();
+
+    /// \brief Test lazy arithmetic expressions over sequences.
+    virtual void testSequenceExpression();
+
+    /// \brief Test the thread pool and parallel extraction of large sequences.
+    virtual void testParallelExtraction();
+
+    /// \brief Test finding the bins which contain coordinates.
+    virtual void testBinLookup();
+
+    /// \brief Test appending live data to ring columns and sequences which read snapshots of them.
+    virtual void testRingSequence();
+
+    /// \brief Test masks of the gaps between intervals.
+    virtual void testGapMask();
+
+    /// \brief Test sequences which read members of arrays of structures in place.
+    virtual void testStridedSequence();
+
+    /// \brief Test compressed columns and sequences which read them.
+    virtual void testCompressedSequence();
+
+    /// \brief Test masks of the elements of sequences which can be plotted.
+    virtual void testValidityMask();
+
+    /// \brief Test counting events in bins.
+    virtual void testEventHistogrammer();
+
+    /// \brief Test counting events in a grid of bins.
+    virtual void testEventHistogrammer2D();
+
+    /// \brief Test summing weights of events in bins.
+    virtual void testWeightedHistogram();
+
+    /// \brief Test blockwise clients of sequences which implement only the original interface.
+    virtual void testPlainSequence();
+
     /// \brief Report failed tests, and set a flag used to exit with non-0 status if an error occurs.
     void reportUnexpected(const std::string & text) const;
 
@@ -89,6 +292,23 @@ void StGraphTestApp::run() {
   testGuis();
 #endif
   testSequence();
+  testBufferPool();
+  testMappedColumn();
+  testFitsColumnSequence();
+  testOwningSequence();
+  testDecimatedSequence();
+  testSequenceExpression();
+  testParallelExtraction();
+  testBinLookup();
+  testRingSequence();
+  testGapMask();
+  testStridedSequence();
+  testCompressedSequence();
+  testValidityMask();
+  testEventHistogrammer();
+  testEventHistogrammer2D();
+  testWeightedHistogram();
+  testPlainSequence();
   testPlots();
 
   // Test will involve plotting histograms with 200 intervals.
@@ -530,6 +750,19 @@ void StGraphTestApp::testSequence() {
 
   }
 
+  // Test ValueSequence with too few elements for any interior elements, where every element is extrapolated.
+  {
+    const double single[] = { 5. };
+    ValueSequence<const double *> single_seq(single, single + 1);
+    testSequence(single_seq, "ValueSequence with one element", single, single, single);
+
+    const double value[] = { 10., 12. };
+    const double low[] = { 9., 11. };
+    const double high[] = { 11., 13. };
+    ValueSequence<const double *> seq(value, value + 2);
+    testSequence(seq, "ValueSequence with two elements", value, low, high);
+  }
+
   // Test LowerBoundSequence.
   {
     // Create a new sequence of left edges, and correct derived values.
@@ -585,6 +818,340 @@ void StGraphTestApp::testSequence() {
     testSequence(seq, "IntervalSequence", value, left, right);
   }
 
+  // Test that every instruction set of the vectorized kernels matches the scalar formulas exactly, for lengths
+  // which exercise both full vectors and left-over elements.
+  {
+    const SimdKernel::Operation_e op[] = { SimdKernel::eValueBounds, SimdKernel::eValueSpreads,
+      SimdKernel::eLowerBoundBounds, SimdKernel::eLowerBoundSpreads };
+    const SimdKernel::InstructionSet_e iset[] = { SimdKernel::eSse2, SimdKernel::eAvx2, SimdKernel::eBest };
+    for (Vec_t::size_type size = 0; size != 20; ++size) {
+      // One spare element so that the arrays have an address even when size is 0.
+      Vec_t in(size + 1, 0.);
+      double edge = 100.;
+      for (Vec_t::size_type ii = 0; ii != size; ++ii) in[ii] = edge += .1 + ii * ii / 7.;
+      for (unsigned int op_idx = 0; op_idx != sizeof(op) / sizeof(op[0]); ++op_idx) {
+        Vec_t expected_low(size + 1, 0.);
+        Vec_t expected_high(size + 1, 0.);
+        SimdKernel::computeInterior(op[op_idx], &in[0], size, &expected_low[0], &expected_high[0], SimdKernel::eScalar);
+        for (unsigned int iset_idx = 0; iset_idx != sizeof(iset) / sizeof(iset[0]); ++iset_idx) {
+          Vec_t low(size + 1, 0.);
+          Vec_t high(size + 1, 0.);
+          SimdKernel::computeInterior(op[op_idx], &in[0], size, &low[0], &high[0], iset[iset_idx]);
+          if (expected_low != low || expected_high != high) {
+            m_failed = true;
+            m_out.err() << "SimdKernel::computeInterior for operation " << op[op_idx] << " using " <<
+              SimdKernel::getName(iset[iset_idx]) << " differed from scalar result for " << size << " elements" << std::endl;
+          }
+        }
+      }
+    }
+  }
+
+  // Test in-place access to sequences which store their properties contiguously.
+  {
+    const double value[] = { 10., 12., 15., 17., 19., 20. };
+    const double spread[] = { .5, 2., 1., 1.5, .5, 1. };
+    ISequence::size_type num_rec = sizeof(value) / sizeof(double);
+    Vec_t vec(value, value + num_rec);
+    Vec_t buffer;
+    DataView low_view;
+    DataView high_view;
+
+    // A PointSequence over a vector may be read in place, values and bounds alike.
+    PointSequence<Vec_t::iterator> point_seq(vec.begin(), vec.end());
+    if (!point_seq.getValueView(low_view) || !low_view.isContiguous() || &vec[0] != low_view.data()) {
+      m_failed = true;
+      m_out.err() << "PointSequence over a vector did not report a contiguous view of its values" << std::endl;
+    }
+    if (&vec[0] != point_seq.getValueData(buffer) || !buffer.empty()) {
+      m_failed = true;
+      m_out.err() << "PointSequence::getValueData copied values which are stored contiguously" << std::endl;
+    }
+
+    // A LowerBoundSequence must compute its values, so it has no view.
+    LowerBoundSequence<Vec_t::iterator> lower_seq(vec.begin(), vec.end());
+    if (lower_seq.getValueView(low_view) || lower_seq.getIntervalView(low_view, high_view)) {
+      m_failed = true;
+      m_out.err() << "LowerBoundSequence reported a view of properties it computes" << std::endl;
+    }
+    if (lower_seq.getValueData(buffer) != &buffer[0] || num_rec != buffer.size() || 11. != buffer[0]) {
+      m_failed = true;
+      m_out.err() << "LowerBoundSequence::getValueData did not extract the values into the buffer" << std::endl;
+    }
+
+    // Spreads of a ValueSpreadSequence over pointers are stored contiguously.
+    ValueSpreadSequence<const double *> spread_seq(value, value + num_rec, spread);
+    if (!spread_seq.getSpreadView(low_view, high_view) || spread != low_view.data() || spread != high_view.data()) {
+      m_failed = true;
+      m_out.err() << "ValueSpreadSequence over pointers did not report a view of its spreads" << std::endl;
+    }
+
+    // Elements of a list are not contiguous.
+    std::list<double> list(value, value + num_rec);
+    IntervalSequence<std::list<double>::iterator> list_seq(list.begin(), list.end(), list.begin());
+    if (list_seq.getIntervalView(low_view, high_view)) {
+      m_failed = true;
+      m_out.err() << "IntervalSequence over a list reported a contiguous view" << std::endl;
+    }
+  }
+
+
+  // Test LinearSequence.
+  {
+    // Five bins of width 2 from 10 to 20.
+    const double value[] = { 11., 13., 15., 17., 19. };
+    const double low[] = { 10., 12., 14., 16., 18. };
+    const double high[] = { 12., 14., 16., 18., 20. };
+
+    LinearSequence seq(10., 20., 5);
+    testSequence(seq, "LinearSequence", value, low, high);
+
+    // The bins must be identified as uniform, with the correct range.
+    double lower = 0.;
+    double upper = 0.;
+    if (!seq.getUniformBins(lower, upper) || 10. != lower || 20. != upper)
+      reportUnexpected("LinearSequence::getUniformBins did not return the range of the bins");
+    if (seq.getLogUniformBins(lower, upper))
+      reportUnexpected("LinearSequence::getLogUniformBins returned true");
+
+    // The edges must match those of the equivalent IntervalSequence.
+    Vec_t edges;
+    seq.getBinEdges(edges);
+    IntervalSequence<const double *> interval_seq(low, low + 5, high);
+    Vec_t interval_edges;
+    interval_seq.getBinEdges(interval_edges);
+    if (6 != edges.size() || edges != interval_edges)
+      reportUnexpected("LinearSequence::getBinEdges did not return the same edges as the equivalent IntervalSequence");
+    if (interval_seq.getUniformBins(lower, upper))
+      reportUnexpected("IntervalSequence::getUniformBins returned true");
+
+    // Clones must compute the same bins.
+    std::unique_ptr<ISequence> clone(seq.clone());
+    Vec_t clone_edges;
+    clone->getBinEdges(clone_edges);
+    if (edges != clone_edges) reportUnexpected("LinearSequence::clone did not return an identical sequence");
+
+    // Empty ranges cannot be binned.
+    try {
+      LinearSequence bad_seq(20., 10., 5);
+      reportUnexpected("LinearSequence constructor did not throw when the range was reversed");
+    } catch (const std::logic_error &) {
+    }
+  }
+
+  // Test LogSequence.
+  {
+    // Four bins, each a factor of 2 wide, from 1 to 16.
+    const double value[] = { 1.5, 3., 6., 12. };
+    const double low[] = { 1., 2., 4., 8. };
+    const double high[] = { 2., 4., 8., 16. };
+
+    LogSequence seq(1., 16., 4);
+    testSequence(seq, "LogSequence", value, low, high);
+
+    double lower = 0.;
+    double upper = 0.;
+    if (!seq.getLogUniformBins(lower, upper) || 1. != lower || 16. != upper)
+      reportUnexpected("LogSequence::getLogUniformBins did not return the range of the bins");
+    if (seq.getUniformBins(lower, upper))
+      reportUnexpected("LogSequence::getUniformBins returned true");
+
+    // The last edge must be the upper bound exactly, however many bins there are.
+    LogSequence fine_seq(1., 3., 1000);
+    if (3. != fine_seq.getEdge(fine_seq.size()))
+      reportUnexpected("LogSequence::getEdge did not return the upper bound as the last edge");
+
+    try {
+      LogSequence bad_seq(0., 10., 5);
+      reportUnexpected("LogSequence constructor did not throw when the lower bound was 0");
+    } catch (const std::logic_error &) {
+    }
+  }
+
+  // Test typed extraction.
+  {
+    // Integer output rounds to nearest, clamps to the limits of the type and converts NaN to 0.
+    const double value[] = { 1.4, 1.5, -2.5, -0.4, 3.e9, -3.e9, 1.e30, std::numeric_limits<double>::quiet_NaN() };
+    const int expected_int[] = { 1, 2, -3, 0, std::numeric_limits<int>::max(), std::numeric_limits<int>::min(),
+      std::numeric_limits<int>::max(), 0 };
+    const long long expected_long[] = { 1, 2, -3, 0, 3000000000ll, -3000000000ll, std::numeric_limits<long long>::max(),
+      0 };
+    const Vec_t::size_type num_rec = sizeof(value) / sizeof(value[0]);
+    PointSequence<const double *> seq(value, value + num_rec);
+    std::vector<int> int_vec;
+    std::vector<long long> long_vec;
+    seq.getValuesAs(int_vec);
+    seq.getValuesAs(long_vec);
+    if (std::vector<int>(expected_int, expected_int + num_rec) != int_vec)
+      reportUnexpected("getValuesAs<int> did not round and clamp values as expected");
+    if (std::vector<long long>(expected_long, expected_long + num_rec) != long_vec)
+      reportUnexpected("getValuesAs<long long> did not round and clamp values as expected");
+
+    // Float output clamps finite values beyond the range of float, but keeps infinities and NaN. Only values which
+    // float holds without loss are exact.
+    std::vector<float> float_vec;
+    seq.getValuesAs(float_vec);
+    const float float_max = std::numeric_limits<float>::max();
+    if (num_rec != float_vec.size() || 1.4f != float_vec[0] || 3.e9f != float_vec[4] || 1.e30f != float_vec[6] ||
+      float_vec[7] == float_vec[7])
+      reportUnexpected("getValuesAs<float> did not convert values as expected");
+    const double inf = std::numeric_limits<double>::infinity();
+    if (float_max != SequenceValueConverter<float>::convert(1.e300) ||
+      -float_max != SequenceValueConverter<float>::convert(-1.e300) ||
+      -std::numeric_limits<float>::infinity() != SequenceValueConverter<float>::convert(-inf))
+      reportUnexpected("SequenceValueConverter<float> did not clamp values as expected");
+    if (!SequenceValueConverter<float>::isExact(16777216.) || SequenceValueConverter<float>::isExact(16777217.) ||
+      SequenceValueConverter<float>::isExact(1.4) || SequenceValueConverter<float>::isExact(1.e30) ||
+      !SequenceValueConverter<float>::isExact(value[7]))
+      reportUnexpected("SequenceValueConverter<float>::isExact returned the wrong result");
+
+    // Sequences which do not store their values contiguously are converted in blocks; use enough elements to span
+    // several blocks.
+    std::deque<double> low;
+    for (int ii = 0; ii != 2000; ++ii) low.push_back(ii + .25);
+    std::deque<double> high(low.begin(), low.end());
+    for (std::deque<double>::iterator itor = high.begin(); itor != high.end(); ++itor) *itor += 1.5;
+    IntervalSequence<std::deque<double>::const_iterator> interval_seq(low.begin(), low.end(), high.begin());
+    std::vector<int> int_low;
+    std::vector<int> int_high;
+    interval_seq.getIntervalsAs(int_low, int_high);
+    bool ok = 2000 == int_low.size() && 2000 == int_high.size();
+    for (std::vector<int>::size_type ii = 0; ok && ii != int_low.size(); ++ii) {
+      ok = int(ii) == int_low[ii] && int(ii) + 2 == int_high[ii];
+    }
+    if (!ok) reportUnexpected("getIntervalsAs<int> did not convert a non-contiguous sequence correctly");
+  }
+
+  // Test sequence statistics.
+  {
+    // Non-finite elements are excluded; log axes need the smallest positive value.
+    std::vector<double> value;
+    value.push_back(-2.);
+    value.push_back(0.);
+    value.push_back(std::numeric_limits<double>::quiet_NaN());
+    value.push_back(.5);
+    value.push_back(std::numeric_limits<double>::infinity());
+    value.push_back(3.);
+    PointSequence<std::vector<double>::const_iterator> seq(value.begin(), value.end());
+    SequenceStatistics stats(seq.getStatistics());
+    if (6 != stats.getNumElements() || 4 != stats.getNumFinite())
+      reportUnexpected("getStatistics did not exclude non-finite elements");
+    if (-2. != stats.getMinValue() || 3. != stats.getMaxValue() || .5 != stats.getMinPositiveValue() ||
+      -2. != stats.getMinLower() || 3. != stats.getMaxUpper() || .5 != stats.getMinPositiveLower())
+      reportUnexpected("getStatistics did not return the ranges of the finite elements");
+    if (!stats.isNonDecreasing() || stats.isNonIncreasing() || !stats.hasOrderedBins())
+      reportUnexpected("getStatistics did not find the finite elements in increasing order");
+
+    // Statistics are cached until cleared, and clones share them.
+    value[0] = 4.;
+    std::unique_ptr<ISequence> clone(seq.clone());
+    if (-2. != seq.getStatistics().getMinValue() || -2. != clone->getStatistics().getMinValue())
+      reportUnexpected("getStatistics did not return cached statistics");
+    seq.clearStatistics();
+    stats = seq.getStatistics();
+    if (0. != stats.getMinValue() || 4. != stats.getMaxValue() || stats.isNonDecreasing())
+      reportUnexpected("getStatistics did not recompute statistics after clearStatistics");
+
+    // Clones keep their own statistics until cleared themselves, which const clones such as those held by plots may be.
+    const ISequence & held(*clone);
+    if (-2. != held.getStatistics().getMinValue())
+      reportUnexpected("getStatistics of a clone did not return cached statistics after the original was cleared");
+    held.clearStatistics();
+    if (0. != held.getStatistics().getMinValue())
+      reportUnexpected("getStatistics of a clone did not recompute statistics after clearStatistics");
+
+    // Overlapping bins are not ordered, and empty sequences have empty ranges. Use enough elements to span several
+    // blocks.
+    std::vector<double> lower(2000);
+    std::vector<double> upper(2000);
+    for (std::vector<double>::size_type ii = 0; ii != lower.size(); ++ii) {
+      lower[ii] = 2000. - ii;
+      upper[ii] = lower[ii] + 1.;
+    }
+    IntervalSequence<std::vector<double>::const_iterator> decreasing_seq(lower.begin(), lower.end(), upper.begin());
+    stats = decreasing_seq.getStatistics();
+    if (stats.isNonDecreasing() || !stats.isNonIncreasing() || stats.hasOrderedBins() || 1. != stats.getMinLower() ||
+      2001. != stats.getMaxUpper())
+      reportUnexpected("getStatistics did not describe decreasing bins correctly");
+    IntervalSequence<std::vector<double>::const_iterator> empty_seq(lower.end(), lower.end(), upper.end());
+    stats = empty_seq.getStatistics();
+    if (0 != stats.getNumElements() || !(stats.getMinValue() > stats.getMaxValue()))
+      reportUnexpected("getStatistics did not return empty ranges for an empty sequence");
+
+    // Orderings are found across the boundaries of the blocks summarized at once, and across non-finite elements.
+    for (std::vector<double>::size_type ii = 0; ii != lower.size(); ++ii) {
+      lower[ii] = ii;
+      upper[ii] = ii + 1.;
+    }
+    const std::vector<double>::size_type boundary[] = { 1, 255, 256, 257, 511, 512, 1999 };
+    for (unsigned int idx = 0; idx != sizeof(boundary) / sizeof(boundary[0]); ++idx) {
+      std::vector<double> overlap(lower);
+      overlap[boundary[idx]] -= .5;
+      stats = IntervalSequence<std::vector<double>::const_iterator>(overlap.begin(), overlap.end(),
+        upper.begin()).getStatistics();
+      if (!stats.isNonDecreasing() || stats.hasOrderedBins() || 2000 != stats.getNumFinite())
+        reportUnexpected("getStatistics did not find overlapping bins at the boundary of a block");
+      overlap[boundary[idx]] = std::numeric_limits<double>::quiet_NaN();
+      overlap[boundary[idx] - 1] = boundary[idx] + 5.;
+      stats = IntervalSequence<std::vector<double>::const_iterator>(overlap.begin(), overlap.end(),
+        upper.begin()).getStatistics();
+      bool last = lower.size() - 1 == boundary[idx];
+      if (last != stats.isNonDecreasing() || 1999 != stats.getNumFinite())
+        reportUnexpected("getStatistics did not compare the elements on either side of a non-finite element");
+    }
+  }
+
+  // Test that every instruction set summarizes blocks of elements as the scalar implementation does, and that blocks
+  // with a non-finite element are rejected.
+  {
+    const SimdKernel::InstructionSet_e iset[] = { SimdKernel::eScalar, SimdKernel::eSse2, SimdKernel::eAvx2,
+      SimdKernel::eBest };
+    for (std::vector<double>::size_type size = 1; size != 20; ++size) {
+      std::vector<double> value(size);
+      std::vector<double> lower(size);
+      std::vector<double> upper(size);
+      for (std::vector<double>::size_type ii = 0; ii != size; ++ii) {
+        value[ii] = (ii * 37 % 11) - 5.;
+        lower[ii] = value[ii] - (ii % 3) * .5;
+        upper[ii] = value[ii] + 1.;
+      }
+      for (int sorted = 0; sorted != 2; ++sorted) {
+        if (0 != sorted) {
+          std::sort(value.begin(), value.end());
+          for (std::vector<double>::size_type ii = 0; ii != size; ++ii) {
+            lower[ii] = value[ii] - .25;
+            upper[ii] = value[ii] + .25;
+          }
+        }
+        SimdKernel::Summary expected = SimdKernel::Summary();
+        if (!SimdKernel::summarizeFinite(&value[0], &lower[0], &upper[0], size, expected, SimdKernel::eScalar))
+          reportUnexpected("SimdKernel::summarizeFinite rejected a finite block");
+        for (unsigned int iset_idx = 0; iset_idx != sizeof(iset) / sizeof(iset[0]); ++iset_idx) {
+          SimdKernel::Summary summary = SimdKernel::Summary();
+          bool ok = SimdKernel::summarizeFinite(&value[0], &lower[0], &upper[0], size, summary, iset[iset_idx]) &&
+            expected.m_min_value == summary.m_min_value && expected.m_max_value == summary.m_max_value &&
+            expected.m_min_positive_value == summary.m_min_positive_value &&
+            expected.m_min_lower == summary.m_min_lower && expected.m_max_upper == summary.m_max_upper &&
+            expected.m_min_positive_lower == summary.m_min_positive_lower &&
+            expected.m_non_decreasing == summary.m_non_decreasing &&
+            expected.m_non_increasing == summary.m_non_increasing && expected.m_ordered_bins == summary.m_ordered_bins;
+          if (!ok) {
+            m_failed = true;
+            m_out.err() << "SimdKernel::summarizeFinite using " << SimdKernel::getName(iset[iset_idx]) <<
+              " differed from scalar result for " << size << " elements" << std::endl;
+          }
+          std::vector<double> bad(upper);
+          bad[size - 1] = 0 != sorted ? std::numeric_limits<double>::quiet_NaN() :
+            -std::numeric_limits<double>::infinity();
+          if (SimdKernel::summarizeFinite(&value[0], &lower[0], &bad[0], size, summary, iset[iset_idx])) {
+            m_failed = true;
+            m_out.err() << "SimdKernel::summarizeFinite using " << SimdKernel::getName(iset[iset_idx]) <<
+              " accepted a non-finite element in " << size << " elements" << std::endl;
+          }
+        }
+      }
+    }
+  }
 }
 
 void StGraphTestApp::testSequence(const st_graph::ISequence & iseq, const std::string & test_name, const double * value,
@@ -639,6 +1206,1583 @@ void StGraphTestApp::testSequence(const st_graph::ISequence & iseq, const std::s
         ", not " << value_vec[index] - low_vec[index] << std::endl;
     }
   }
+
+  // Confirm that single-pass extraction of all columns agrees with the individual extraction methods, both when
+  // extracting into the block and when referring to the sequence's memory in place.
+  const Vec_t * expected[] = { &value_vec, &low_vec, &high_vec, &low_err, &high_err };
+  const st_graph::SequenceColumns::Column_e column[] = { st_graph::SequenceColumns::eValue,
+    st_graph::SequenceColumns::eLowerBound, st_graph::SequenceColumns::eUpperBound, st_graph::SequenceColumns::eLowerSpread,
+    st_graph::SequenceColumns::eUpperSpread };
+  for (int in_place = 0; in_place != 2; ++in_place) {
+    st_graph::SequenceColumns columns;
+    if (0 == in_place) iseq.getColumns(st_graph::SequenceColumns::eAll, columns);
+    else iseq.getColumnData(st_graph::SequenceColumns::eAll, columns);
+    for (int col_idx = 0; col_idx != 5; ++col_idx) {
+      const double * data = columns.data(column[col_idx]);
+      for (Vec_t::size_type index = 0; index != iseq.size(); ++index) {
+        if (0 == data || (*expected[col_idx])[index] != data[index]) {
+          m_failed = true;
+          m_out.err() << test_name << ": " << (0 == in_place ? "getColumns" : "getColumnData") << " column " <<
+            column[col_idx] << " differed from the individual extraction method at element " << index << std::endl;
+          break;
+        }
+      }
+    }
+  }
+
+  // Confirm that extracting the sequence in blocks of every size agrees with extracting it all at once.
+  for (Vec_t::size_type block_size = 1; block_size <= iseq.size(); ++block_size) {
+    st_graph::SequenceColumns columns;
+    for (Vec_t::size_type offset = 0; offset < iseq.size(); offset += block_size) {
+      Vec_t::size_type count = std::min(block_size, iseq.size() - offset);
+      iseq.getColumnRange(st_graph::SequenceColumns::eAll, offset, count, columns);
+      for (int col_idx = 0; col_idx != 5; ++col_idx) {
+        const double * data = columns.data(column[col_idx]);
+        for (Vec_t::size_type index = 0; index != count; ++index) {
+          if ((*expected[col_idx])[offset + index] != data[index]) {
+            m_failed = true;
+            m_out.err() << test_name << ": getColumnRange with block size " << block_size << " column " <<
+              column[col_idx] << " differed from the individual extraction method at element " << offset + index <<
+              std::endl;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  // Confirm that single-precision extraction gives the double results rounded to float.
+  std::vector<float> float_vec[5];
+  iseq.getValuesAs(float_vec[0]);
+  iseq.getIntervalsAs(float_vec[1], float_vec[2]);
+  iseq.getSpreadsAs(float_vec[3], float_vec[4]);
+  for (int col_idx = 0; col_idx != 5; ++col_idx) {
+    for (Vec_t::size_type index = 0; index != iseq.size(); ++index) {
+      if (iseq.size() != float_vec[col_idx].size() || float((*expected[col_idx])[index]) != float_vec[col_idx][index]) {
+        m_failed = true;
+        m_out.err() << test_name << ": single-precision extraction of column " << column[col_idx] <<
+          " differed from the individual extraction method at element " << index << std::endl;
+        break;
+      }
+    }
+  }
+
+  // Confirm that the cached statistics agree with the extracted values and bounds, which are all finite here.
+  st_graph::SequenceStatistics stats(iseq.getStatistics());
+  if (iseq.size() != stats.getNumElements() || iseq.size() != stats.getNumFinite()) {
+    m_failed = true;
+    m_out.err() << test_name << ": getStatistics did not count all elements as finite" << std::endl;
+  }
+  if (!value_vec.empty() && (*std::min_element(value_vec.begin(), value_vec.end()) != stats.getMinValue() ||
+    *std::max_element(value_vec.begin(), value_vec.end()) != stats.getMaxValue() ||
+    *std::min_element(low_vec.begin(), low_vec.end()) != stats.getMinLower() ||
+    *std::max_element(high_vec.begin(), high_vec.end()) != stats.getMaxUpper())) {
+    m_failed = true;
+    m_out.err() << test_name << ": getStatistics did not return the ranges of the values and bounds" << std::endl;
+  }
+  bool non_decreasing = true;
+  for (Vec_t::size_type index = 1; index < value_vec.size(); ++index) {
+    if (value_vec[index] < value_vec[index - 1]) non_decreasing = false;
+  }
+  if (non_decreasing != stats.isNonDecreasing()) {
+    m_failed = true;
+    m_out.err() << test_name << ": getStatistics returned isNonDecreasing() == " << stats.isNonDecreasing() << std::endl;
+  }
+
+  // Ranges which extend past the end of the sequence must be rejected.
+  try {
+    double dummy = 0.;
+    iseq.getValueRange(iseq.size(), 1, &dummy);
+    m_failed = true;
+    m_out.err() << test_name << ": getValueRange did not throw for a range past the end of the sequence" << std::endl;
+  } catch (const std::out_of_range &) {
+  }
+}
+
+void StGraphTestApp::testBufferPool() {
+  using namespace st_graph;
+
+  // Three bins, with a gap between the second and third. Deques are used so that data must be copied out of the
+  // sequences rather than read in place.
+  const double low_array[] = { 0., 1., 3. };
+  const double high_array[] = { 1., 2., 4. };
+  const double value_array[] = { 5., 6., 7. };
+  std::deque<double> low(low_array, low_array + 3);
+  std::deque<double> high(high_array, high_array + 3);
+  std::deque<double> value(value_array, value_array + 3);
+  IntervalSequence<std::deque<double>::const_iterator> x(low.begin(), low.end(), high.begin());
+  PointSequence<std::deque<double>::const_iterator> y(value.begin(), value.end());
+
+  // Scattered data, some contiguous, some not.
+  std::vector<double> scatter(1000);
+  for (std::vector<double>::size_type ii = 0; ii != scatter.size(); ++ii) scatter[ii] = ii * ii;
+  std::deque<double> scatter_deque(scatter.begin(), scatter.end());
+  ValueSequence<std::vector<double>::const_iterator> scatter_x(scatter.begin(), scatter.end());
+  LowerBoundSequence<std::deque<double>::const_iterator> scatter_y(scatter_deque.begin(), scatter_deque.end());
+
+  // Expected step curve: two vertices per bin, with a single NaN vertex at the gap between the second and third bins.
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double expected_x[] = { 0., 1., 1., 2., nan, 3., 4. };
+  const double expected_y[] = { 5., 5., 6., 6., nan, 7., 7. };
+  const unsigned long expected_num_vals = sizeof(expected_x) / sizeof(double);
+
+  SequenceBufferPool pool;
+  for (int pass = 0; pass != 3; ++pass) {
+    // Mimic a frame's display: reset the pool, then draw a histogram and a scatter plot.
+    unsigned long num_allocations = s_num_allocations;
+    pool.reset();
+
+    const double * x_vals = 0;
+    const double * y_vals = 0;
+    unsigned long num_vals = pool.createStepCurve(x, y, false, false, x_vals, y_vals);
+
+    SequenceColumns & x_columns(pool.getColumns());
+    SequenceColumns & y_columns(pool.getColumns());
+    scatter_x.getColumnData(SequenceColumns::eValue | SequenceColumns::eSpreads, x_columns);
+    scatter_y.getColumnData(SequenceColumns::eValue | SequenceColumns::eSpreads, y_columns);
+
+    num_allocations = s_num_allocations - num_allocations;
+
+    std::ostringstream os;
+    os << "testBufferPool: pass " << pass << ": ";
+    if (expected_num_vals != num_vals) {
+      reportUnexpected(os.str() + "createStepCurve returned the wrong number of vertices");
+    } else {
+      for (unsigned long ii = 0; ii != num_vals; ++ii) {
+        bool is_break = expected_x[ii] != expected_x[ii];
+        if (is_break ? x_vals[ii] == x_vals[ii] || y_vals[ii] == y_vals[ii] :
+          expected_x[ii] != x_vals[ii] || expected_y[ii] != y_vals[ii]) {
+          reportUnexpected(os.str() + "createStepCurve returned the wrong vertices");
+          break;
+        }
+      }
+    }
+    if (scatter[1] != x_columns.data(SequenceColumns::eValue)[1] ||
+      .5 * (scatter[1] + scatter[2]) != y_columns.data(SequenceColumns::eValue)[1])
+      reportUnexpected(os.str() + "pooled columns returned the wrong values");
+
+    // The first pass fills the pool; after that, displaying the same data must not allocate memory.
+    if (0 != pass && 0 != num_allocations) {
+      os << num_allocations << " allocations were made while redisplaying unchanged data";
+      reportUnexpected(os.str());
+    }
+    if (4 != pool.getNumColumnsUsed() || 2 != pool.getNumBuffersUsed())
+      reportUnexpected(os.str() + "pool handed out an unexpected number of blocks or buffers");
+  }
+}
+
+void StGraphTestApp::testMappedColumn() {
+  using namespace st_graph;
+
+  const double value[] = { 10., 12., 15., 17., 19., 20. };
+  const double upper[] = { 11., 13., 16., 18., 20., 21. };
+  const std::size_t num_values = sizeof(value) / sizeof(double);
+  const std::string raw_file = "test_st_graph_mapped.raw";
+  const std::string upper_file = "test_st_graph_mapped_upper.raw";
+  const std::string npy_file = "test_st_graph_mapped.npy";
+
+  // Write the values as a raw array of doubles, preceded by one extra double to test offsets.
+  {
+    std::ofstream os(raw_file.c_str(), std::ios::out | std::ios::binary);
+    const double extra = -1.;
+    os.write(reinterpret_cast<const char *>(&extra), sizeof(double));
+    os.write(reinterpret_cast<const char *>(value), sizeof(value));
+  }
+  {
+    std::ofstream os(upper_file.c_str(), std::ios::out | std::ios::binary);
+    os.write(reinterpret_cast<const char *>(upper), sizeof(upper));
+  }
+
+  // Write the values as a version 1.0 .npy file, with the header padded so that the data are 64-byte aligned.
+  {
+    const unsigned short probe = 1;
+    std::ostringstream header;
+    header << "{'descr': '" << (1 == *reinterpret_cast<const unsigned char *>(&probe) ? '<' : '>') <<
+      "f8', 'fortran_order': False, 'shape': (" << num_values << ",), }";
+    std::string dict = header.str();
+    while (0 != (10 + dict.size() + 1) % 64) dict += ' ';
+    dict += '\n';
+    std::ofstream os(npy_file.c_str(), std::ios::out | std::ios::binary);
+    os.write("\x93NUMPY\x01\x00", 8);
+    os.put(char(dict.size() & 0xff));
+    os.put(char(dict.size() >> 8));
+    os.write(dict.data(), dict.size());
+    os.write(reinterpret_cast<const char *>(value), sizeof(value));
+  }
+
+  try {
+    MappedColumn raw_column(raw_file, sizeof(double), num_values);
+    MappedColumn npy_column(npy_file);
+    MappedColumn upper_column(upper_file);
+
+    if (num_values != raw_column.size() || num_values != npy_column.size() || num_values != upper_column.size())
+      reportUnexpected("testMappedColumn: mapped columns have the wrong size");
+
+    // Mapped sequences must behave exactly like sequences over the same values in memory.
+    std::vector<double> expected_value;
+    std::vector<double> expected_low;
+    std::vector<double> expected_high;
+
+    ValueSequence<const double *> value_seq(value, value + num_values);
+    value_seq.getValues(expected_value);
+    value_seq.getIntervals(expected_low, expected_high);
+    testSequence(MappedValueSequence(raw_column), "MappedValueSequence (raw)", &expected_value[0], &expected_low[0],
+      &expected_high[0]);
+    testSequence(MappedValueSequence(npy_column), "MappedValueSequence (npy)", &expected_value[0], &expected_low[0],
+      &expected_high[0]);
+
+    testSequence(MappedPointSequence(npy_column), "MappedPointSequence", value, value, value);
+
+    LowerBoundSequence<const double *> lower_bound_seq(value, value + num_values);
+    lower_bound_seq.getValues(expected_value);
+    lower_bound_seq.getIntervals(expected_low, expected_high);
+    testSequence(MappedLowerBoundSequence(npy_column), "MappedLowerBoundSequence", &expected_value[0], &expected_low[0],
+      &expected_high[0]);
+
+    IntervalSequence<const double *> interval_seq(value, value + num_values, upper);
+    interval_seq.getValues(expected_value);
+    testSequence(MappedIntervalSequence(raw_column, upper_column), "MappedIntervalSequence", &expected_value[0], value,
+      upper);
+
+    // Mapped data must be read in place, and clones must keep the mapping alive after the original is gone.
+    ISequence * clone = 0;
+    {
+      MappedColumn column(npy_file);
+      MappedPointSequence seq(column);
+      DataView view;
+      if (!seq.getValueView(view) || !view.isContiguous()) reportUnexpected("MappedPointSequence was not read in place");
+      clone = seq.clone();
+    }
+    std::vector<double> clone_value;
+    clone->getValues(clone_value);
+    delete clone;
+    if (clone_value != std::vector<double>(value, value + num_values))
+      reportUnexpected("testMappedColumn: clone of MappedPointSequence did not return the mapped values");
+
+    // Columns which do not fit in the file must be rejected.
+    try {
+      MappedColumn bad_column(raw_file, sizeof(double), num_values + 1);
+      reportUnexpected("testMappedColumn: MappedColumn did not throw for a column past the end of the file");
+    } catch (const std::out_of_range &) {
+    }
+    try {
+      MappedIntervalSequence bad_seq(raw_column, MappedColumn(raw_file));
+      reportUnexpected("testMappedColumn: MappedIntervalSequence did not throw for columns of different sizes");
+    } catch (const std::logic_error &) {
+    }
+  } catch (const std::exception & x) {
+    reportUnexpected(std::string("testMappedColumn: unexpected exception: ") + x.what());
+  }
+
+  std::remove(raw_file.c_str());
+  std::remove(upper_file.c_str());
+  std::remove(npy_file.c_str());
+}
+
+void StGraphTestApp::testFitsColumnSequence() {
+  using namespace st_graph;
+
+  // Create two light curve tables: a small one for detailed tests, and one large enough to span several blocks of rows.
+  const std::string small_file = "test_st_graph_rates_small.fits";
+  const std::string large_file = "test_st_graph_rates.fits";
+  const long num_small_rows = 10;
+  const long num_rows = 100000;
+  std::vector<double> rate(num_rows);
+  std::vector<double> error(num_rows);
+  for (long ii = 0; ii != num_rows; ++ii) {
+    rate[ii] = 100. + ii % 17;
+    error[ii] = .5 + ii % 3;
+  }
+  const std::string * file_name[] = { &small_file, &large_file };
+  const long file_rows[] = { num_small_rows, num_rows };
+  for (int file_idx = 0; file_idx != 2; ++file_idx) {
+    int status = 0;
+    fitsfile * fptr = 0;
+    char * ttype[] = { const_cast<char *>("RATE"), const_cast<char *>("ERROR") };
+    char * tform[] = { const_cast<char *>("1D"), const_cast<char *>("1D") };
+    char * tunit[] = { const_cast<char *>("count/s"), const_cast<char *>("count/s") };
+    fits_create_file(&fptr, ("!" + *file_name[file_idx]).c_str(), &status);
+    fits_create_tbl(fptr, BINARY_TBL, file_rows[file_idx], 2, ttype, tform, tunit, "RATE", &status);
+    fits_write_col(fptr, TDOUBLE, 1, 1, 1, file_rows[file_idx], &rate[0], &status);
+    fits_write_col(fptr, TDOUBLE, 2, 1, 1, file_rows[file_idx], &error[0], &status);
+    fits_close_file(fptr, &status);
+    if (0 != status) {
+      reportUnexpected("testFitsColumnSequence: could not create test file " + *file_name[file_idx]);
+      return;
+    }
+  }
+
+  try {
+    // Detailed test of the small table, which behaves like a ValueSpreadSequence.
+    std::vector<double> low(num_small_rows);
+    std::vector<double> high(num_small_rows);
+    for (long ii = 0; ii != num_small_rows; ++ii) {
+      low[ii] = rate[ii] - error[ii];
+      high[ii] = rate[ii] + error[ii];
+    }
+    testSequence(FitsColumnSequence(small_file, "RATE", "RATE", "ERROR"), "FitsColumnSequence", &rate[0], &low[0],
+      &high[0]);
+
+    FitsColumnSequence seq(large_file, "RATE", "RATE", "ERROR");
+    if (std::size_t(num_rows) != seq.size()) reportUnexpected("testFitsColumnSequence: sequence has the wrong size");
+    if (seq.getBlockSize() >= seq.size())
+      m_out.warn() << "testFitsColumnSequence: table fits in one block, so streaming is not fully exercised" << std::endl;
+
+    // The whole column must be streamed correctly, across block boundaries.
+    std::vector<double> value;
+    std::vector<double> low_spread;
+    std::vector<double> high_spread;
+    seq.getValues(value);
+    seq.getSpreads(low_spread, high_spread);
+    if (rate != value) reportUnexpected("testFitsColumnSequence: getValues did not return the RATE column");
+    if (error != low_spread || error != high_spread)
+      reportUnexpected("testFitsColumnSequence: getSpreads did not return the ERROR column");
+
+    // A range which starts and ends in the middle of blocks must also be correct.
+    FitsColumnSequence::size_type offset = seq.getBlockSize() / 2 + 1;
+    FitsColumnSequence::size_type count = std::min<FitsColumnSequence::size_type>(3 * seq.getBlockSize(),
+      seq.size() - offset);
+    SequenceColumns columns;
+    seq.getColumnRange(SequenceColumns::eIntervals, offset, count, columns);
+    for (FitsColumnSequence::size_type ii = 0; ii != count; ++ii) {
+      if (rate[offset + ii] - error[offset + ii] != columns.data(SequenceColumns::eLowerBound)[ii] ||
+        rate[offset + ii] + error[offset + ii] != columns.data(SequenceColumns::eUpperBound)[ii]) {
+        reportUnexpected("testFitsColumnSequence: getColumnRange did not return the correct intervals");
+        break;
+      }
+    }
+
+    // Copies share the open file, but may be read by different threads at once.
+    std::vector<std::vector<double> > copy_value(8);
+    ThreadPool::instance().run(copy_value.size(), CopyValuesTask(seq, copy_value));
+    for (std::vector<std::vector<double> >::size_type ii = 0; ii != copy_value.size(); ++ii) {
+      if (rate != copy_value[ii]) {
+        reportUnexpected("testFitsColumnSequence: copies read by different threads did not return the RATE column");
+        break;
+      }
+    }
+
+    // Without an error column, spreads are 0.
+    FitsColumnSequence no_error_seq(large_file, "RATE", "RATE");
+    no_error_seq.getSpreads(low_spread, high_spread);
+    if (std::vector<double>(num_rows, 0.) != low_spread)
+      reportUnexpected("testFitsColumnSequence: spreads were not 0 for a sequence without an error column");
+
+    // Undefined values of integer columns are read as NaN, so that they are not plotted.
+    const std::string null_file = "test_st_graph_counts_null.fits";
+    {
+      int status = 0;
+      fitsfile * fptr = 0;
+      char * ttype[] = { const_cast<char *>("COUNTS") };
+      char * tform[] = { const_cast<char *>("1J") };
+      char * tunit[] = { const_cast<char *>("count") };
+      long counts[] = { 3, -1, 5, -1 };
+      fits_create_file(&fptr, ("!" + null_file).c_str(), &status);
+      fits_create_tbl(fptr, BINARY_TBL, 4, 1, ttype, tform, tunit, "COUNTS", &status);
+      fits_write_key_lng(fptr, const_cast<char *>("TNULL1"), -1, const_cast<char *>("undefined value"), &status);
+      fits_write_col(fptr, TLONG, 1, 1, 1, 4, counts, &status);
+      fits_close_file(fptr, &status);
+      if (0 != status) reportUnexpected("testFitsColumnSequence: could not create test file " + null_file);
+    }
+    FitsColumnSequence null_seq(null_file, "COUNTS", "COUNTS");
+    null_seq.getValues(value);
+    if (4 != value.size() || 3. != value[0] || !std::isnan(value[1]) || 5. != value[2] || !std::isnan(value[3]))
+      reportUnexpected("testFitsColumnSequence: undefined values were not read as NaN");
+    if (2 != null_seq.getValidityMask()->getNumValid())
+      reportUnexpected("testFitsColumnSequence: validity mask did not drop undefined values");
+    std::remove(null_file.c_str());
+
+    // Missing columns must be reported.
+    try {
+      FitsColumnSequence bad_seq(large_file, "RATE", "NO_SUCH_COLUMN");
+      reportUnexpected("testFitsColumnSequence: FitsColumnSequence did not throw for a missing column");
+    } catch (const std::runtime_error &) {
+    }
+  } catch (const std::exception & x) {
+    reportUnexpected(std::string("testFitsColumnSequence: unexpected exception: ") + x.what());
+  }
+
+  std::remove(small_file.c_str());
+  std::remove(large_file.c_str());
+}
+
+void StGraphTestApp::testOwningSequence() {
+  using namespace st_graph;
+
+  const double value[] = { 10., 12., 15., 17., 19., 20. };
+  const double spread[] = { 1., 2., 1., 3., 2., 1. };
+  const double upper[] = { 11., 13., 16., 18., 20., 21. };
+  const std::size_t num_values = sizeof(value) / sizeof(double);
+
+  SharedColumn value_column(value, value + num_values);
+  SharedColumn spread_column(spread, spread + num_values);
+  SharedColumn upper_column(upper, upper + num_values);
+
+  // Owning sequences must behave exactly like sequences over the same values in memory.
+  std::vector<double> expected_value;
+  std::vector<double> expected_low;
+  std::vector<double> expected_high;
+
+  ValueSequence<const double *> value_seq(value, value + num_values);
+  value_seq.getValues(expected_value);
+  value_seq.getIntervals(expected_low, expected_high);
+  testSequence(OwningValueSequence(value_column), "OwningValueSequence", &expected_value[0], &expected_low[0],
+    &expected_high[0]);
+
+  testSequence(OwningPointSequence(value_column), "OwningPointSequence", value, value, value);
+
+  LowerBoundSequence<const double *> lower_bound_seq(value, value + num_values);
+  lower_bound_seq.getValues(expected_value);
+  lower_bound_seq.getIntervals(expected_low, expected_high);
+  testSequence(OwningLowerBoundSequence(value_column), "OwningLowerBoundSequence", &expected_value[0], &expected_low[0],
+    &expected_high[0]);
+
+  IntervalSequence<const double *> interval_seq(value, value + num_values, upper);
+  interval_seq.getValues(expected_value);
+  testSequence(OwningIntervalSequence(value_column, upper_column), "OwningIntervalSequence", &expected_value[0], value,
+    upper);
+
+  ValueSpreadSequence<const double *> spread_seq(value, value + num_values, spread);
+  spread_seq.getIntervals(expected_low, expected_high);
+  testSequence(OwningValueSpreadSequence(value_column, spread_column), "OwningValueSpreadSequence", value,
+    &expected_low[0], &expected_high[0]);
+
+  // Copying a column must share its storage, and sequences must read the storage in place.
+  SharedColumn producer(std::vector<double>(value, value + num_values));
+  ISequence * clone = 0;
+  {
+    OwningPointSequence seq(producer);
+    if (!producer.isShared()) reportUnexpected("testOwningSequence: OwningPointSequence did not share its column");
+    DataView view;
+    if (!seq.getValueView(view) || producer.begin() != view.data())
+      reportUnexpected("testOwningSequence: OwningPointSequence did not read its column in place");
+    clone = seq.clone();
+  }
+
+  // Modifying and then discarding the producer's copy must not affect the clone, which must outlive it.
+  producer.getMutableData()[0] = -1.;
+  producer.getMutableData().push_back(-1.);
+  producer = SharedColumn();
+  std::vector<double> clone_value;
+  clone->getValues(clone_value);
+  if (clone_value != std::vector<double>(value, value + num_values))
+    reportUnexpected("testOwningSequence: clone of OwningPointSequence was affected by changes to the producer's column");
+
+  // Once the producer's copy is gone, the clone holds the only copy of the storage.
+  const OwningPointSequence * owning_clone = dynamic_cast<const OwningPointSequence *>(clone);
+  if (0 == owning_clone || owning_clone->getColumn().isShared())
+    reportUnexpected("testOwningSequence: clone of OwningPointSequence did not hold the only copy of its column");
+  delete clone;
+
+  // Owning sequences hold fixed data, so plots keep their cached results from one display to the next, unlike those of
+  // sequences which read the client's memory. Expressions hold fixed data only if all their operands do.
+  OwningPointSequence fixed_seq(value_column);
+  if (!fixed_seq.hasFixedData() || !OwningIntervalSequence(value_column, upper_column).hasFixedData() ||
+    !OwningValueSpreadSequence(value_column, spread_column).hasFixedData() || value_seq.hasFixedData())
+    reportUnexpected("testOwningSequence: hasFixedData returned the wrong result");
+  if (!ScaledSequence(fixed_seq, 2., 1.).hasFixedData() || ScaledSequence(value_seq, 2., 1.).hasFixedData())
+    reportUnexpected("testOwningSequence: hasFixedData returned the wrong result for an expression");
+
+  // Modifying an unshared column must not copy it.
+  SharedColumn unshared(value, value + num_values);
+  const double * data = unshared.begin();
+  if (data != &unshared.getMutableData()[0]) reportUnexpected("testOwningSequence: unshared column was copied");
+
+  // Columns of different sizes must be rejected.
+  try {
+    OwningIntervalSequence bad_seq(value_column, SharedColumn(upper, upper + num_values - 1));
+    reportUnexpected("testOwningSequence: OwningIntervalSequence did not throw for columns of different sizes");
+  } catch (const std::logic_error &) {
+  }
+}
+
+void StGraphTestApp::testDecimatedSequence() {
+  using namespace st_graph;
+  typedef ISequence::size_type size_type;
+
+  // A light curve with a few spikes and a gap of undefined values.
+  const size_type num_points = 100000;
+  std::vector<double> time(num_points);
+  std::vector<double> rate(num_points);
+  for (size_type ii = 0; ii != num_points; ++ii) {
+    time[ii] = ii;
+    rate[ii] = std::sin(ii * 1.e-3) + .01 * (ii % 7);
+  }
+  rate[12345] = 50.;
+  rate[54321] = -50.;
+  for (size_type ii = 70000; ii != 70100; ++ii) rate[ii] = std::numeric_limits<double>::quiet_NaN();
+  ValueSequence<std::vector<double>::const_iterator> x(time.begin(), time.end());
+  PointSequence<std::vector<double>::const_iterator> y(rate.begin(), rate.end());
+
+  const size_type max_points = 1000;
+  for (int mode = DecimatedSequence::eMinMax; mode <= DecimatedSequence::eLargestTriangle; ++mode) {
+    std::ostringstream os;
+    os << "testDecimatedSequence: mode " << mode << ": ";
+    std::string prefix = os.str();
+
+    std::vector<size_type> selected;
+    DecimatedSequence::selectElements(x, y, max_points, DecimatedSequence::Mode_e(mode), selected);
+    if (selected.empty() || max_points < selected.size()) reportUnexpected(prefix + "wrong number of points selected");
+
+    // Selected points must be in order, and must include the spikes, but not the undefined values.
+    bool ok = true;
+    for (size_type ii = 0; ii != selected.size(); ++ii) {
+      if ((0 != ii && selected[ii] <= selected[ii - 1]) || !std::isfinite(rate[selected[ii]])) ok = false;
+    }
+    if (!ok) reportUnexpected(prefix + "selected points are out of order or undefined");
+    if (selected.end() == std::find(selected.begin(), selected.end(), 12345) ||
+      selected.end() == std::find(selected.begin(), selected.end(), 54321))
+      reportUnexpected(prefix + "spikes were not selected");
+
+    // Min/max mode preserves the envelope of every bucket exactly, so the range of the selected points is that of
+    // all the points.
+    if (DecimatedSequence::eMinMax == mode) {
+      std::vector<size_type>::const_iterator itor = selected.begin();
+      size_type bucket_size = num_points / (max_points / 2);
+      if (selected.front() >= bucket_size || selected.back() < num_points - bucket_size)
+        reportUnexpected(prefix + "first and last buckets were not represented");
+      for (; itor != selected.end() && 50. != rate[*itor]; ++itor) {}
+      if (selected.end() == itor) reportUnexpected(prefix + "maximum was not selected");
+    } else if (0 != selected.front() || num_points - 1 != selected.back() || max_points != selected.size()) {
+      reportUnexpected(prefix + "first and last points were not selected, or too few points were selected");
+    }
+
+    // The selection must not depend on the number of threads.
+    std::vector<size_type> threaded;
+    DecimatedSequence::selectElements(x, y, max_points, DecimatedSequence::Mode_e(mode), threaded, 4);
+    if (selected != threaded) reportUnexpected(prefix + "selection depends on the number of threads");
+
+    // Decimated sequences must have the properties of the selected elements of the originals.
+    DecimatedSequence x_dec(x, selected);
+    std::vector<double> value(selected.size());
+    std::vector<double> low(selected.size());
+    std::vector<double> high(selected.size());
+    for (size_type ii = 0; ii != selected.size(); ++ii) x.getRange(selected[ii], 1, &value[ii], &low[ii], &high[ii], 0, 0);
+    std::vector<double> dec_value;
+    std::vector<double> dec_low;
+    std::vector<double> dec_high;
+    x_dec.getValues(dec_value);
+    x_dec.getIntervals(dec_low, dec_high);
+    if (value != dec_value || low != dec_low || high != dec_high)
+      reportUnexpected(prefix + "decimated sequence does not have the properties of the selected elements");
+  }
+
+  // Test all extraction methods on a small decimated sequence, which includes runs of consecutive elements.
+  {
+    const double value[] = { 1., 2., 4., 7., 11., 16., 22. };
+    std::vector<size_type> selected;
+    selected.push_back(0);
+    selected.push_back(2);
+    selected.push_back(3);
+    selected.push_back(4);
+    selected.push_back(6);
+    ValueSequence<const double *> seq(value, value + 7);
+    std::vector<double> all_value;
+    std::vector<double> all_low;
+    std::vector<double> all_high;
+    seq.getValues(all_value);
+    seq.getIntervals(all_low, all_high);
+    std::vector<double> expected_value;
+    std::vector<double> expected_low;
+    std::vector<double> expected_high;
+    for (std::vector<size_type>::iterator itor = selected.begin(); itor != selected.end(); ++itor) {
+      expected_value.push_back(all_value[*itor]);
+      expected_low.push_back(all_low[*itor]);
+      expected_high.push_back(all_high[*itor]);
+    }
+    testSequence(DecimatedSequence(seq, selected), "DecimatedSequence", &expected_value[0], &expected_low[0],
+      &expected_high[0]);
+
+    // Sequences with no more points than requested are not decimated.
+    std::vector<size_type> all;
+    DecimatedSequence::selectElements(seq, seq, 7, DecimatedSequence::eLargestTriangle, all);
+    if (7 != all.size()) reportUnexpected("testDecimatedSequence: short sequence was decimated");
+  }
+
+  // Frames decimate only sequences with many more points than pixels, in increasing order of x.
+  std::vector<size_type> selected;
+  if (!DecimatedSequence::selectForDisplay(x, y, 900, selected) || selected.size() > 1800)
+    reportUnexpected("testDecimatedSequence: selectForDisplay did not decimate a long light curve");
+  if (DecimatedSequence::selectForDisplay(x, y, 20000, selected))
+    reportUnexpected("testDecimatedSequence: selectForDisplay decimated a light curve with few points per pixel");
+  if (DecimatedSequence::selectForDisplay(y, x, 900, selected))
+    reportUnexpected("testDecimatedSequence: selectForDisplay decimated a scatter plot with unordered x values");
+
+  // Each pixel column keeps the points with the smallest and largest y value in it, even where the points are much
+  // denser in some columns than in others. Nine tenths of these points lie in the first tenth of the x range.
+  const size_type num_pixels = 900;
+  std::vector<double> uneven_time(num_points);
+  for (size_type ii = 0; ii != num_points; ++ii)
+    uneven_time[ii] = ii < 90000 ? ii / 90000. : 1. + 9. * (ii - 90000.) / 10000.;
+  ValueSequence<std::vector<double>::const_iterator> uneven_x(uneven_time.begin(), uneven_time.end());
+  if (!DecimatedSequence::selectForDisplay(uneven_x, y, num_pixels, selected) || selected.size() > 2 * num_pixels)
+    reportUnexpected("testDecimatedSequence: selectForDisplay did not decimate a light curve with uneven spacing");
+  std::vector<size_type> min_index(num_pixels, num_points);
+  std::vector<size_type> max_index(num_pixels, num_points);
+  double scale = num_pixels / (uneven_time.back() - uneven_time.front());
+  for (size_type ii = 0; ii != num_points; ++ii) {
+    if (!std::isfinite(rate[ii])) continue;
+    double position = std::min((uneven_time[ii] - uneven_time.front()) * scale, num_pixels - 1.);
+    size_type column = static_cast<size_type>(position);
+    if (num_points == min_index[column] || rate[ii] < rate[min_index[column]]) min_index[column] = ii;
+    if (num_points == max_index[column] || rate[ii] > rate[max_index[column]]) max_index[column] = ii;
+  }
+  std::vector<size_type> expected;
+  for (size_type column = 0; column != num_pixels; ++column) {
+    if (num_points == min_index[column]) continue;
+    expected.push_back(std::min(min_index[column], max_index[column]));
+    if (min_index[column] != max_index[column]) expected.push_back(std::max(min_index[column], max_index[column]));
+  }
+  if (expected != selected)
+    reportUnexpected("testDecimatedSequence: selectForDisplay did not select the extremes of each pixel column");
+}
+
+void StGraphTestApp::testSequenceExpression() {
+  using namespace st_graph;
+
+  // Counts and background with asymmetric errors, and bin widths with no errors.
+  const double counts[] = { 10., 20., 0., 40., 50. };
+  const double counts_low[] = { 3., 4., 0., 6., 7. };
+  const double counts_high[] = { 4., 5., 1., 7., 8. };
+  const double bkg[] = { 1., 2., 3., 4., 5. };
+  const double counts_err[] = { 3., 4., 0., 6., 5. };
+  const double bkg_err[] = { 4., 3., 2., 8., 12. };
+  const double width[] = { 2., 2., 4., 4., 5. };
+  const std::size_t num_bins = sizeof(counts) / sizeof(double);
+  ValueSpreadSequence<const double *> counts_seq(counts, counts + num_bins, counts_low, counts_high);
+  ValueSpreadSequence<const double *> bkg_seq(bkg, bkg + num_bins, bkg_err);
+  PointSequence<const double *> width_seq(width, width + num_bins);
+
+  double value[num_bins];
+  double low[num_bins];
+  double high[num_bins];
+
+  // a * x + b: spreads scale by |a|, and exchange places when a is negative.
+  for (std::size_t ii = 0; ii != num_bins; ++ii) {
+    value[ii] = -2. * counts[ii] + 1.;
+    low[ii] = value[ii] - 2. * counts_high[ii];
+    high[ii] = value[ii] + 2. * counts_low[ii];
+  }
+  testSequence(-2. * counts_seq + 1., "ScaledSequence (-2 * counts + 1)", value, low, high);
+  testSequence(1. - (counts_seq + counts_seq * 0.) * 2., "ScaledSequence (1 - (counts + counts * 0) * 2)", value, low,
+    high);
+
+  // Repeated scaling is folded into one expression over the original sequence.
+  ScaledSequence folded(3. * (2. * counts_seq + 1.) - 4.);
+  if (6. != folded.getFactor() || -1. != folded.getOffset())
+    reportUnexpected("testSequenceExpression: repeated scaling was not folded");
+
+  // Background subtraction: errors add in quadrature. These errors are chosen so that the results are exact.
+  ValueSpreadSequence<const double *> counts_sym_seq(counts, counts + num_bins, counts_err);
+  for (std::size_t ii = 0; ii != num_bins; ++ii) {
+    value[ii] = counts[ii] - bkg[ii];
+    low[ii] = value[ii] - std::sqrt(counts_err[ii] * counts_err[ii] + bkg_err[ii] * bkg_err[ii]);
+    high[ii] = value[ii] + std::sqrt(counts_err[ii] * counts_err[ii] + bkg_err[ii] * bkg_err[ii]);
+  }
+  testSequence(counts_sym_seq - bkg_seq, "DifferenceSequence", value, low, high);
+
+  // The upper spread of the subtrahend widens the lower spread of a difference.
+  std::vector<double> low_spread;
+  std::vector<double> high_spread;
+  (bkg_seq - counts_seq).getSpreads(low_spread, high_spread);
+  if (std::fabs(low_spread[0] - std::sqrt(bkg_err[0] * bkg_err[0] + counts_high[0] * counts_high[0])) > 1.e-12 ||
+    std::fabs(high_spread[0] - std::sqrt(bkg_err[0] * bkg_err[0] + counts_low[0] * counts_low[0])) > 1.e-12)
+    reportUnexpected("testSequenceExpression: difference did not exchange the spreads of the subtrahend");
+
+  // Rates: dividing by exact widths scales the spreads.
+  for (std::size_t ii = 0; ii != num_bins; ++ii) {
+    value[ii] = (counts[ii] - bkg[ii]) / width[ii];
+    low[ii] = value[ii] - std::sqrt(counts_low[ii] * counts_low[ii] + bkg_err[ii] * bkg_err[ii]) / width[ii];
+    high[ii] = value[ii] + std::sqrt(counts_high[ii] * counts_high[ii] + bkg_err[ii] * bkg_err[ii]) / width[ii];
+  }
+  RatioSequence rate((counts_seq - bkg_seq) / width_seq);
+  std::vector<double> rate_value;
+  std::vector<double> rate_low;
+  std::vector<double> rate_high;
+  rate.getValues(rate_value);
+  rate.getIntervals(rate_low, rate_high);
+  for (std::size_t ii = 0; ii != num_bins; ++ii) {
+    if (std::fabs(rate_value[ii] - value[ii]) > 1.e-12 || std::fabs(rate_low[ii] - low[ii]) > 1.e-12 ||
+      std::fabs(rate_high[ii] - high[ii]) > 1.e-12) {
+      reportUnexpected("testSequenceExpression: rate did not have the expected value or spreads");
+      break;
+    }
+  }
+
+  // Products and ratios of uncertain operands add relative errors in quadrature; for a ratio, the upper spread of
+  // the denominator lowers the result.
+  (counts_seq / bkg_seq).getSpreads(low_spread, high_spread);
+  double expected_low = std::sqrt(std::pow(counts_low[1] / bkg[1], 2) + std::pow(counts[1] * bkg_err[1] / (bkg[1] * bkg[1]), 2));
+  double expected_high = std::sqrt(std::pow(counts_high[1] / bkg[1], 2) + std::pow(counts[1] * bkg_err[1] / (bkg[1] * bkg[1]), 2));
+  if (std::fabs(low_spread[1] - expected_low) > 1.e-12 || std::fabs(high_spread[1] - expected_high) > 1.e-12)
+    reportUnexpected("testSequenceExpression: ratio did not have the expected spreads");
+  (counts_seq * bkg_seq).getSpreads(low_spread, high_spread);
+  expected_low = std::sqrt(std::pow(counts_low[3] * bkg[3], 2) + std::pow(counts[3] * bkg_err[3], 2));
+  if (std::fabs(low_spread[3] - expected_low) > 1.e-12)
+    reportUnexpected("testSequenceExpression: product did not have the expected spreads");
+
+  // Expressions are evaluated in blocks; long expressions must agree with element-wise evaluation everywhere.
+  std::vector<double> long_value(1000);
+  for (std::size_t ii = 0; ii != long_value.size(); ++ii) long_value[ii] = ii * .5;
+  ValueSequence<std::vector<double>::const_iterator> long_seq(long_value.begin(), long_value.end());
+  SumSequence long_sum(long_seq + long_seq);
+  std::vector<double> sum_value;
+  long_sum.getValues(sum_value);
+  bool ok = long_value.size() == sum_value.size();
+  for (std::size_t ii = 0; ok && ii != sum_value.size(); ++ii) ok = long_value[ii] * 2. == sum_value[ii];
+  if (!ok) reportUnexpected("testSequenceExpression: long sum did not have the expected values");
+
+  // Expressions hold clones of their operands, so they remain valid after the operands are destroyed.
+  ISequence * clone = 0;
+  {
+    PointSequence<const double *> temp_seq(counts, counts + num_bins);
+    clone = (temp_seq * 2.).clone();
+  }
+  std::vector<double> clone_value;
+  clone->getValues(clone_value);
+  delete clone;
+  if (2. * counts[4] != clone_value.at(4)) reportUnexpected("testSequenceExpression: clone did not have the expected values");
+
+  // Operands must have the same size.
+  try {
+    SumSequence bad_seq(counts_seq + long_seq);
+    reportUnexpected("testSequenceExpression: sum of sequences of different sizes did not throw");
+  } catch (const std::logic_error &) {
+  }
+}
+
+void StGraphTestApp::testParallelExtraction() {
+  using namespace st_graph;
+  typedef ISequence::size_type size_type;
+
+  // Every task must be run exactly once, whatever the number of threads, including tasks which run tasks themselves.
+  for (unsigned int num_threads = 1; num_threads != 5; ++num_threads) {
+    ThreadPool pool(num_threads);
+    if (num_threads != pool.getNumThreads()) reportUnexpected("testParallelExtraction: pool has the wrong number of threads");
+    for (int nested = 0; nested != 2; ++nested) {
+      std::vector<unsigned long> out(1000);
+      pool.run(out.size(), SquareTask(pool, out, out.size(), 0 != nested));
+      bool ok = true;
+      for (unsigned long ii = 0; ii != out.size(); ++ii) ok = ok && ii * ii == out[ii];
+      if (!ok) reportUnexpected("testParallelExtraction: thread pool did not run every task once");
+    }
+    // Exceptions thrown by tasks are passed to the caller, after which the pool remains usable.
+    try {
+      std::vector<unsigned long> out(1000);
+      pool.run(out.size(), SquareTask(pool, out, 500, false));
+      reportUnexpected("testParallelExtraction: thread pool did not rethrow the exception thrown by a task");
+    } catch (const std::runtime_error &) {
+    }
+    std::vector<unsigned long> out(10);
+    pool.run(out.size(), SquareTask(pool, out, out.size(), false));
+    if (81 != out[9]) reportUnexpected("testParallelExtraction: thread pool failed after a task threw");
+  }
+
+  // Irregular data, so that each element differs from its neighbors in a different way.
+  const size_type num_points = 300001;
+  std::vector<double> data(num_points);
+  std::vector<double> spread(num_points);
+  for (size_type ii = 0; ii != num_points; ++ii) {
+    data[ii] = ii + std::sin(ii * .37);
+    spread[ii] = .1 + std::fabs(std::cos(ii * .11));
+  }
+  std::vector<double> upper(num_points);
+  for (size_type ii = 0; ii != num_points; ++ii) upper[ii] = data[ii] + spread[ii];
+  std::deque<double> deque_data(data.begin(), data.end());
+
+  std::vector<ISequence *> seq;
+  seq.push_back(new PointSequence<std::vector<double>::const_iterator>(data.begin(), data.end()));
+  seq.push_back(new ValueSequence<std::vector<double>::const_iterator>(data.begin(), data.end()));
+  seq.push_back(new LowerBoundSequence<std::vector<double>::const_iterator>(data.begin(), data.end()));
+  seq.push_back(new ValueSequence<std::deque<double>::const_iterator>(deque_data.begin(), deque_data.end()));
+  seq.push_back(new LowerBoundSequence<std::deque<double>::const_iterator>(deque_data.begin(), deque_data.end()));
+  seq.push_back(new ValueSpreadSequence<std::vector<double>::const_iterator>(data.begin(), data.end(), spread.begin()));
+  seq.push_back(new IntervalSequence<std::vector<double>::const_iterator>(data.begin(), data.end(), upper.begin()));
+
+  // Parallel extraction must give exactly the same results as serial extraction.
+  size_type default_threshold = ISequence::getParallelThreshold();
+  for (std::size_t ii = 0; ii != seq.size(); ++ii) {
+    std::ostringstream os;
+    os << "testParallelExtraction: sequence " << ii << ": ";
+    std::string prefix = os.str();
+
+    std::vector<double> result[2][5];
+    SequenceColumns columns[2];
+    for (int parallel = 0; parallel != 2; ++parallel) {
+      ISequence::setParallelThreshold(0 != parallel ? 1 : num_points + 1);
+      seq[ii]->getValues(result[parallel][0]);
+      seq[ii]->getIntervals(result[parallel][1], result[parallel][2]);
+      seq[ii]->getSpreads(result[parallel][3], result[parallel][4]);
+      seq[ii]->getColumns(SequenceColumns::eAll, columns[parallel]);
+    }
+    const SequenceColumns::Column_e column[] = { SequenceColumns::eValue, SequenceColumns::eLowerBound,
+      SequenceColumns::eUpperBound, SequenceColumns::eLowerSpread, SequenceColumns::eUpperSpread };
+    for (int jj = 0; jj != 5; ++jj) {
+      if (num_points != result[1][jj].size() ||
+        0 != std::memcmp(&result[0][jj][0], &result[1][jj][0], num_points * sizeof(double)))
+        reportUnexpected(prefix + "parallel and serial extraction differ");
+      if (0 != std::memcmp(columns[0].data(column[jj]), columns[1].data(column[jj]), num_points * sizeof(double)))
+        reportUnexpected(prefix + "parallel and serial extraction of columns differ");
+      if (0 != std::memcmp(&result[0][jj][0], columns[1].data(column[jj]), num_points * sizeof(double)))
+        reportUnexpected(prefix + "parallel extraction of columns differs from extraction of each property");
+    }
+  }
+  ISequence::setParallelThreshold(default_threshold);
+  for (std::vector<ISequence *>::iterator itor = seq.begin(); itor != seq.end(); ++itor) delete *itor;
+}
+
+void StGraphTestApp::testBinLookup() {
+  using namespace st_graph;
+  typedef ISequence::size_type size_type;
+
+  // Bins with a gap between the second and third, a zero-width fourth bin, and a gap before the last.
+  const double lower[] = { 0., 1., 3., 4., 4., 6. };
+  const double upper[] = { 1., 2., 4., 4., 5., 8. };
+  const size_type num_bins = sizeof(lower) / sizeof(double);
+  IntervalSequence<const double *> interval_seq(lower, lower + num_bins, upper);
+
+  // Coordinates, whether a bin contains them, and which bin or gap they are in.
+  const double x[] = { -1., 0., .5, 1., 1.99, 2., 2.5, 3., 4., 4.5, 5., 7.9, 8., 100. };
+  const bool found[] = { false, true, true, true, true, false, false, true, true, true, false, true, false, false };
+  const size_type bin[] = { 0, 0, 0, 1, 1, 2, 2, 2, 4, 4, 5, 5, 6, 6 };
+  for (std::size_t ii = 0; ii != sizeof(x) / sizeof(double); ++ii) {
+    size_type index = num_bins + 1;
+    if (found[ii] != interval_seq.findBin(x[ii], index) || bin[ii] != index) {
+      std::ostringstream os;
+      os << "testBinLookup: IntervalSequence::findBin(" << x[ii] << ") returned " << index;
+      reportUnexpected(os.str());
+    }
+  }
+
+  // Ranges include every bin which overlaps them, and are empty if they lie in a gap.
+  size_type begin = 0;
+  size_type end = 0;
+  interval_seq.findRange(.5, 3., begin, end);
+  if (0 != begin || 2 != end) reportUnexpected("testBinLookup: IntervalSequence::findRange(.5, 3.) was not [0, 2)");
+  interval_seq.findRange(2., 3.5, begin, end);
+  if (2 != begin || 3 != end) reportUnexpected("testBinLookup: IntervalSequence::findRange(2., 3.5) was not [2, 3)");
+  interval_seq.findRange(5., 6., begin, end);
+  if (5 != begin || 5 != end) reportUnexpected("testBinLookup: IntervalSequence::findRange(5., 6.) was not empty at 5");
+
+  // Adjacent bins of a LowerBoundSequence, the last of which is extrapolated.
+  const double edges[] = { 10., 20., 40., 50. };
+  LowerBoundSequence<const double *> lower_bound_seq(edges, edges + 4);
+  size_type index = 0;
+  if (!lower_bound_seq.findBin(20., index) || 1 != index)
+    reportUnexpected("testBinLookup: LowerBoundSequence::findBin(20.) did not find bin 1");
+  if (!lower_bound_seq.findBin(59., index) || 3 != index)
+    reportUnexpected("testBinLookup: LowerBoundSequence::findBin(59.) did not find the extrapolated last bin");
+  if (lower_bound_seq.findBin(60., index) || 4 != index)
+    reportUnexpected("testBinLookup: LowerBoundSequence::findBin(60.) did not report a coordinate above the bins");
+
+  // The index is cached until the statistics are cleared.
+  std::vector<double> moving(edges, edges + 4);
+  LowerBoundSequence<std::vector<double>::const_iterator> moving_seq(moving.begin(), moving.end());
+  moving_seq.findBin(15., index);
+  moving[0] = 16.;
+  moving_seq.clearStatistics();
+  if (moving_seq.findBin(15., index)) reportUnexpected("testBinLookup: clearStatistics did not discard the bin index");
+
+  // Overlapping bins cannot be indexed.
+  const double overlap_lower[] = { 0., 1. };
+  const double overlap_upper[] = { 2., 3. };
+  IntervalSequence<const double *> overlap_seq(overlap_lower, overlap_lower + 2, overlap_upper);
+  try {
+    overlap_seq.findBin(1.5, index);
+    reportUnexpected("testBinLookup: findBin did not throw for overlapping bins");
+  } catch (const std::logic_error &) {
+  }
+
+  // Analytic sequences must agree exactly with an index of their own bounds, including at the edges.
+  LinearSequence linear_seq(-3., 7.3, 1000);
+  LogSequence log_seq(.1, 1.e4, 777);
+  const ISequence * analytic_seq[] = { &linear_seq, &log_seq };
+  for (int ii = 0; ii != 2; ++ii) {
+    std::vector<double> low;
+    std::vector<double> high;
+    analytic_seq[ii]->getIntervals(low, high);
+    BinIndex bin_index(&low[0], &high[0], low.size());
+    std::vector<double> coord;
+    for (std::size_t jj = 0; jj != low.size(); ++jj) {
+      coord.push_back(low[jj]);
+      coord.push_back(std::nextafter(low[jj], -std::numeric_limits<double>::max()));
+      coord.push_back(.5 * (low[jj] + high[jj]));
+    }
+    coord.push_back(high.back());
+    coord.push_back(-1.e10);
+    coord.push_back(1.e10);
+    bool ok = true;
+    for (std::size_t jj = 0; jj != coord.size(); ++jj) {
+      size_type expected = 0;
+      size_type found_index = 0;
+      bool expected_found = bin_index.findBin(coord[jj], expected);
+      ok = ok && expected_found == analytic_seq[ii]->findBin(coord[jj], found_index) && expected == found_index;
+      const double & x1 = coord[(jj * 7919) % coord.size()];
+      size_type expected_end = 0;
+      bin_index.findRange(coord[jj], x1, expected, expected_end);
+      analytic_seq[ii]->findRange(coord[jj], x1, begin, end);
+      ok = ok && expected == begin && expected_end == end;
+    }
+    if (!ok) reportUnexpected("testBinLookup: analytic findBin or findRange disagreed with the bounds of the bins");
+  }
+}
+
+void StGraphTestApp::testRingSequence() {
+  using namespace st_graph;
+
+  // Ring sequences must behave exactly like sequences over the same values in memory, also across chunks.
+  const double value[] = { 10., 12., 15., 17., 19., 20. };
+  const std::size_t num_values = sizeof(value) / sizeof(double);
+  RingColumn small_column;
+  small_column.append(value, value + num_values);
+  std::vector<double> expected_value;
+  std::vector<double> expected_low;
+  std::vector<double> expected_high;
+  ValueSequence<const double *> value_seq(value, value + num_values);
+  value_seq.getValues(expected_value);
+  value_seq.getIntervals(expected_low, expected_high);
+  testSequence(RingValueSequence(small_column.getSnapshot()), "RingValueSequence", &expected_value[0],
+    &expected_low[0], &expected_high[0]);
+  LowerBoundSequence<const double *> lower_bound_seq(value, value + num_values);
+  lower_bound_seq.getValues(expected_value);
+  lower_bound_seq.getIntervals(expected_low, expected_high);
+  testSequence(RingLowerBoundSequence(small_column.getSnapshot()), "RingLowerBoundSequence", &expected_value[0],
+    &expected_low[0], &expected_high[0]);
+
+  // A sequence within a single chunk is read in place.
+  DataView view;
+  if (!RingPointSequence(small_column.getSnapshot()).getValueView(view) || !view.isContiguous())
+    reportUnexpected("testRingSequence: RingPointSequence within one chunk was not read in place");
+
+  // Windowed column whose window spans several chunks, filled past its capacity.
+  const RingColumn::size_type capacity = 3 * ChunkIterator::s_chunk_size + 100;
+  RingColumn column(capacity);
+  for (unsigned long ii = 0; ii != 2 * capacity; ++ii) column.append(ii * .5);
+  if (capacity != column.size() || 2 * capacity != column.getGeneration())
+    reportUnexpected("testRingSequence: windowed column did not keep its capacity or count its generations");
+
+  RingPointSequence seq(column.getSnapshot());
+  std::vector<double> seq_value;
+  seq.getValues(seq_value);
+  bool ok = capacity == seq_value.size();
+  for (unsigned long ii = 0; ok && ii != capacity; ++ii) ok = (capacity + ii) * .5 == seq_value[ii];
+  if (!ok) reportUnexpected("testRingSequence: RingPointSequence did not hold the most recent samples");
+
+  // Later appends must not change an earlier snapshot or its clones, and must be reported as new.
+  std::unique_ptr<ISequence> clone(seq.clone());
+  const unsigned long displayed = seq.getGeneration();
+  for (unsigned long ii = 0; ii != 10; ++ii) column.append(-1.);
+  std::vector<double> clone_value;
+  clone->getValues(clone_value);
+  if (clone_value != seq_value) reportUnexpected("testRingSequence: snapshot was changed by later appends");
+  RingPointSequence new_seq(column.getSnapshot());
+  if (10 != new_seq.getNumAppendedSince(displayed) || 0 != seq.getNumAppendedSince(displayed) ||
+    capacity != new_seq.getNumAppendedSince(0))
+    reportUnexpected("testRingSequence: getNumAppendedSince did not report the samples appended since a generation");
+  new_seq.getValues(seq_value);
+  if (-1. != seq_value.back() || (capacity + 10) * .5 != seq_value.front())
+    reportUnexpected("testRingSequence: new snapshot did not hold the samples appended since the last one");
+
+  // Once no snapshot holds them, chunks which leave the window are reused instead of allocating new ones.
+  clone.reset();
+  {
+    RingColumn reuse_column(ChunkIterator::s_chunk_size);
+    for (unsigned long ii = 0; ii != 2 * ChunkIterator::s_chunk_size; ++ii) reuse_column.append(ii);
+    unsigned long num_allocations = s_num_allocations;
+    for (unsigned long ii = 0; ii != 4 * ChunkIterator::s_chunk_size; ++ii) reuse_column.append(ii);
+    if (num_allocations != s_num_allocations)
+      reportUnexpected("testRingSequence: windowed column allocated memory once its window was full");
+  }
+}
+
+void StGraphTestApp::testGapMask() {
+  using namespace st_graph;
+
+  // Five bins: the second and third overlap, and there are gaps after the first and third.
+  const double low_array[] = { 0., 2., 2.5, 5., 6. };
+  const double high_array[] = { 1., 3., 4., 6., 7. };
+  std::vector<double> low(low_array, low_array + 5);
+  std::vector<double> high(high_array, high_array + 5);
+  IntervalSequence<std::vector<double>::const_iterator> x(low.begin(), low.end(), high.begin());
+
+  std::shared_ptr<const GapMask> gaps(x.getGapMask());
+  if (5 != gaps->size() || 2 != gaps->getNumGaps() || 3 != gaps->getNumSegments())
+    reportUnexpected("testGapMask: getGapMask found the wrong number of gaps");
+  if (!gaps->isGapAfter(0) || gaps->isGapAfter(1) || !gaps->isGapAfter(2) || gaps->isGapAfter(3) || gaps->isGapAfter(4))
+    reportUnexpected("testGapMask: getGapMask put the gaps in the wrong places");
+  if (1 != gaps->findSegmentEnd(0) || 3 != gaps->findSegmentEnd(1) || 3 != gaps->findSegmentEnd(2) ||
+    5 != gaps->findSegmentEnd(3) || 5 != gaps->findSegmentEnd(5))
+    reportUnexpected("testGapMask: findSegmentEnd returned the wrong segment ends");
+
+  // The mask is cached until the statistics are cleared.
+  if (x.getGapMask() != gaps) reportUnexpected("testGapMask: getGapMask did not cache the mask");
+  low[3] = 4.;
+  x.clearStatistics();
+  gaps = x.getGapMask();
+  if (1 != gaps->getNumGaps() || gaps->isGapAfter(2))
+    reportUnexpected("testGapMask: getGapMask did not find the gaps again after clearStatistics");
+
+  // Empty sequences have no gaps and no segments.
+  GapMask empty(0, 0, 0);
+  if (0 != empty.getNumGaps() || 0 != empty.getNumSegments() || 0 != empty.findSegmentEnd(0))
+    reportUnexpected("testGapMask: empty mask has gaps or segments");
+
+  // Every instruction set finds the same gaps as the scalar code, for lengths which exercise full vectors, left-over
+  // elements and several mask words, including gaps at word boundaries.
+  const SimdKernel::InstructionSet_e iset[] = { SimdKernel::eSse2, SimdKernel::eAvx2, SimdKernel::eBest };
+  for (unsigned long size = 1; size < 300; size += 37) {
+    std::vector<double> lower(size);
+    std::vector<double> upper(size);
+    double edge = 0.;
+    for (unsigned long ii = 0; ii != size; ++ii) {
+      lower[ii] = edge;
+      upper[ii] = edge += 1.;
+      // Leave a gap after every third and every 64th interval.
+      if (0 == ii % 3 || 63 == ii % 64) edge += .5;
+    }
+    std::vector<unsigned long long> expected((size + 63) / 64, ~0ull);
+    unsigned long expected_num_gaps = SimdKernel::findGaps(&lower[0], &upper[0], size, &expected[0], SimdKernel::eScalar);
+    for (unsigned int iset_idx = 0; iset_idx != sizeof(iset) / sizeof(iset[0]); ++iset_idx) {
+      std::vector<unsigned long long> mask((size + 63) / 64, ~0ull);
+      unsigned long num_gaps = SimdKernel::findGaps(&lower[0], &upper[0], size, &mask[0], iset[iset_idx]);
+      if (expected_num_gaps != num_gaps || expected != mask) {
+        std::ostringstream os;
+        os << "testGapMask: SimdKernel::findGaps using " << SimdKernel::getName(iset[iset_idx]) <<
+          " differed from scalar result for " << size << " intervals";
+        reportUnexpected(os.str());
+      }
+    }
+    unsigned long count = 0;
+    for (unsigned long ii = 0; ii + 1 < size; ++ii) if (0 == ii % 3 || 63 == ii % 64) ++count;
+    if (count != expected_num_gaps) reportUnexpected("testGapMask: SimdKernel::findGaps found the wrong number of gaps");
+  }
+}
+
+void StGraphTestApp::testStridedSequence() {
+  using namespace st_graph;
+
+  // Event records with members of different types, larger than a cache line so that prefetching matters. Enough
+  // records are used that extraction is done in parallel.
+  struct Event {
+    double m_time;
+    float m_energy;
+    double m_ra;
+    double m_dec;
+    double m_weight;
+    double m_stop;
+    char m_padding[32];
+  };
+  const std::vector<Event>::size_type num_events = 300000;
+  std::vector<Event> events(num_events);
+  std::vector<double> time(num_events);
+  std::vector<double> stop(num_events);
+  std::vector<double> energy(num_events);
+  double tt = 100.;
+  for (std::vector<Event>::size_type ii = 0; ii != num_events; ++ii) {
+    events[ii].m_time = time[ii] = tt;
+    tt += 1. + (ii % 5) * .25;
+    events[ii].m_stop = stop[ii] = tt - .5;
+    events[ii].m_energy = float(30. + ii % 1000);
+    energy[ii] = events[ii].m_energy;
+  }
+
+  // Compare each strided sequence with the same template reading a copy of the column.
+  std::vector<double> expected1;
+  std::vector<double> expected2;
+  std::vector<double> result1;
+  std::vector<double> result2;
+
+  StridedValueSequence time_seq(&events[0], num_events, &Event::m_time);
+  ValueSequence<std::vector<double>::const_iterator> time_copy(time.begin(), time.end());
+  time_seq.getValues(result1);
+  time_copy.getValues(expected1);
+  if (expected1 != result1) reportUnexpected("testStridedSequence: StridedValueSequence::getValues returned wrong values");
+  time_seq.getIntervals(result1, result2);
+  time_copy.getIntervals(expected1, expected2);
+  if (expected1 != result1 || expected2 != result2)
+    reportUnexpected("testStridedSequence: StridedValueSequence::getIntervals returned wrong intervals");
+
+  // The same column, given by its address and the size of the records.
+  StridedLowerBoundSequence time_bytes(&events[0].m_time, num_events, sizeof(Event));
+  LowerBoundSequence<std::vector<double>::const_iterator> time_bytes_copy(time.begin(), time.end());
+  time_bytes.getSpreads(result1, result2);
+  time_bytes_copy.getSpreads(expected1, expected2);
+  if (expected1 != result1 || expected2 != result2)
+    reportUnexpected("testStridedSequence: StridedLowerBoundSequence::getSpreads returned wrong spreads");
+
+  // Members of other types are converted to double.
+  StridedSequence<PointSequence, float> energy_seq(&events[0], num_events, &Event::m_energy);
+  energy_seq.getValues(result1);
+  if (energy != result1) reportUnexpected("testStridedSequence: float members were read incorrectly");
+
+  // Intervals given by two members of each record, read by the columnar interface.
+  StridedIntervalSequence interval_seq(&events[0], num_events, &Event::m_time, &Event::m_stop);
+  SequenceColumns columns;
+  interval_seq.getColumnData(SequenceColumns::eIntervals, columns);
+  if (!std::equal(time.begin(), time.end(), columns.data(SequenceColumns::eLowerBound)) ||
+    !std::equal(stop.begin(), stop.end(), columns.data(SequenceColumns::eUpperBound)))
+    reportUnexpected("testStridedSequence: StridedIntervalSequence::getColumnData returned wrong intervals");
+  if (interval_seq.getGapMask()->getNumGaps() != num_events - 1)
+    reportUnexpected("testStridedSequence: StridedIntervalSequence has the wrong number of gaps");
+
+  // Clones read the same records.
+  std::unique_ptr<ISequence> clone(time_seq.clone());
+  clone->getValues(result1);
+  if (time != result1) reportUnexpected("testStridedSequence: clone returned wrong values");
+
+  // Strided doubles have a view which records the stride, so that backends may read them in place.
+  DataView view;
+  if (!makeDataView(makeStridedIterator(&events[0], &Event::m_ra), num_events, view) ||
+    view.isContiguous() || std::ptrdiff_t(sizeof(Event)) != view.stride() || &events[0].m_ra != view.data() ||
+    &events[2].m_ra != &view[2])
+    reportUnexpected("testStridedSequence: makeDataView returned the wrong view of strided doubles");
+}
+
+void StGraphTestApp::testCompressedSequence() {
+  using namespace st_graph;
+
+  // Fine, evenly spaced bin edges of a long light curve, whose fractional spacing is not exact in binary, followed
+  // by irregular edges, and a range crossing zero. Enough edges are used that extraction is done in parallel.
+  std::vector<double> edges;
+  for (int ii = 0; ii != 600000; ++ii) edges.push_back(239557417. + ii * .1);
+  double edge = edges.back();
+  for (int ii = 0; ii != 1000; ++ii) edges.push_back(edge += 1. + (ii % 7) * .3);
+  std::vector<double> signed_edges;
+  for (int ii = -1000; ii != 1000; ++ii) signed_edges.push_back(ii * .01);
+
+  CompressedColumn column(edges);
+  if (edges.size() != column.size()) reportUnexpected("testCompressedSequence: column has the wrong size");
+
+  // Compression is lossless, whether the column is read as a whole, in ranges or element by element.
+  std::vector<double> decoded(edges.size());
+  column.decode(0, column.size(), &decoded[0]);
+  if (edges != decoded) reportUnexpected("testCompressedSequence: decode did not restore the data exactly");
+  column.decode(1000, 300, &decoded[0]);
+  if (!std::equal(edges.begin() + 1000, edges.begin() + 1300, decoded.begin()))
+    reportUnexpected("testCompressedSequence: decode of a partial range did not restore the data exactly");
+  if (edges[0] != column[0] || edges[12345] != column[12345] || edges.back() != column[column.size() - 1])
+    reportUnexpected("testCompressedSequence: operator [] did not restore the data exactly");
+  CompressedColumn signed_column(signed_edges.begin(), signed_edges.end());
+  decoded.resize(signed_edges.size());
+  signed_column.decode(0, signed_column.size(), &decoded[0]);
+  if (signed_edges != decoded)
+    reportUnexpected("testCompressedSequence: decode did not restore data of both signs exactly");
+
+  // Evenly spaced edges need far less memory than the raw doubles.
+  if (column.getMemoryUsage() * 4 > edges.size() * sizeof(double)) {
+    std::ostringstream os;
+    os << "testCompressedSequence: column uses " << column.getMemoryUsage() << " bytes for " << edges.size() <<
+      " doubles";
+    reportUnexpected(os.str());
+  }
+
+  // Sequences reading the column agree exactly with the same templates reading the raw data.
+  std::vector<double> expected1;
+  std::vector<double> expected2;
+  std::vector<double> result1;
+  std::vector<double> result2;
+  CompressedLowerBoundSequence lower_bound_seq(column);
+  LowerBoundSequence<std::vector<double>::const_iterator> lower_bound_raw(edges.begin(), edges.end());
+  lower_bound_seq.getIntervals(result1, result2);
+  lower_bound_raw.getIntervals(expected1, expected2);
+  if (expected1 != result1 || expected2 != result2)
+    reportUnexpected("testCompressedSequence: CompressedLowerBoundSequence::getIntervals returned wrong intervals");
+  lower_bound_seq.getValues(result1);
+  lower_bound_raw.getValues(expected1);
+  if (expected1 != result1)
+    reportUnexpected("testCompressedSequence: CompressedLowerBoundSequence::getValues returned wrong values");
+
+  CompressedValueSequence value_seq(signed_column);
+  ValueSequence<std::vector<double>::const_iterator> value_raw(signed_edges.begin(), signed_edges.end());
+  value_seq.getSpreads(result1, result2);
+  value_raw.getSpreads(expected1, expected2);
+  if (expected1 != result1 || expected2 != result2)
+    reportUnexpected("testCompressedSequence: CompressedValueSequence::getSpreads returned wrong spreads");
+
+  // Ranges starting and ending inside blocks.
+  result1.resize(700);
+  expected1.resize(700);
+  lower_bound_seq.getValueRange(300, 700, &result1[0]);
+  lower_bound_raw.getValueRange(300, 700, &expected1[0]);
+  if (expected1 != result1)
+    reportUnexpected("testCompressedSequence: CompressedLowerBoundSequence::getValueRange returned wrong values");
+
+  // A single element is extrapolated as for the other templates.
+  std::vector<double> one(1, 5.);
+  CompressedValueSequence one_seq((CompressedColumn(one)));
+  one_seq.getIntervals(result1, result2);
+  if (1 != result1.size() || 5. != result1[0] || 5. != result2[0])
+    reportUnexpected("testCompressedSequence: single element sequence returned wrong intervals");
+
+  // Data which are not monotone cannot be compressed.
+  std::vector<double> unsorted(edges.begin(), edges.begin() + 1000);
+  std::swap(unsorted[300], unsorted[301]);
+  try {
+    CompressedColumn bad(unsorted);
+    reportUnexpected("testCompressedSequence: CompressedColumn did not throw for data which are not monotone");
+  } catch (const std::logic_error &) {
+  }
+}
+
+void StGraphTestApp::testValidityMask() {
+  using namespace st_graph;
+  const double inf = std::numeric_limits<double>::infinity();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+
+  // Points with a NaN value, an infinite spread, a zero value and a negative value among valid ones.
+  const double value_array[] = { 1., nan, 3., 4., 0., -6., 7. };
+  const double spread_array[] = { .1, .2, inf, .4, .5, .6, .7 };
+  const std::vector<double>::size_type num_points = sizeof(value_array) / sizeof(value_array[0]);
+  std::vector<double> value(value_array, value_array + num_points);
+  std::vector<double> spread(spread_array, spread_array + num_points);
+  ValueSpreadSequence<std::vector<double>::const_iterator> y(value.begin(), value.end(), spread.begin());
+
+  std::shared_ptr<const ValidityMask> valid(y.getValidityMask());
+  if (num_points != valid->size() || 2 != valid->getNumInvalid() || valid->isValid(1) || valid->isValid(2) ||
+    !valid->isValid(4) || !valid->isValid(5))
+    reportUnexpected("testValidityMask: getValidityMask marked the wrong elements invalid");
+  std::shared_ptr<const ValidityMask> positive(y.getValidityMask(true));
+  if (4 != positive->getNumInvalid() || positive->isValid(4) || positive->isValid(5) || !positive->isValid(6))
+    reportUnexpected("testValidityMask: getValidityMask for logarithmic axes marked the wrong elements invalid");
+
+  // Masks are cached until the statistics are cleared.
+  if (y.getValidityMask() != valid || y.getValidityMask(true) != positive)
+    reportUnexpected("testValidityMask: getValidityMask did not cache the masks");
+  value[1] = 2.;
+  y.clearStatistics();
+  if (1 != y.getValidityMask()->getNumInvalid())
+    reportUnexpected("testValidityMask: getValidityMask did not recompute the mask after clearStatistics");
+
+  // Scatter plots drop the points invalid in either sequence, both for columns read in place and for computed columns.
+  std::vector<double> x_value(num_points);
+  for (std::vector<double>::size_type ii = 0; ii != num_points; ++ii) x_value[ii] = ii - 1.;
+  PointSequence<std::vector<double>::const_iterator> x(x_value.begin(), x_value.end());
+  SequenceBufferPool pool;
+  for (int pass = 0; pass != 2; ++pass) {
+    unsigned long num_allocations = s_num_allocations;
+    pool.reset();
+    const SequenceColumns * x_columns = 0;
+    const SequenceColumns * y_columns = 0;
+    unsigned long num_kept = pool.createScatterColumns(x, y, true, false, x_columns, y_columns);
+    num_allocations = s_num_allocations - num_allocations;
+
+    // Points 0 and 1 have x <= 0 on a logarithmic x axis, and point 2 has an infinite spread.
+    const double expected_x[] = { 2., 3., 4., 5. };
+    const double expected_y[] = { 4., 0., -6., 7. };
+    if (4 != num_kept || !std::equal(expected_x, expected_x + 4, x_columns->data(SequenceColumns::eValue)) ||
+      !std::equal(expected_y, expected_y + 4, y_columns->data(SequenceColumns::eValue)) ||
+      spread[3] != y_columns->data(SequenceColumns::eLowerSpread)[0] ||
+      spread[6] != y_columns->data(SequenceColumns::eUpperSpread)[3])
+      reportUnexpected("testValidityMask: createScatterColumns kept the wrong points");
+    if (0 != pass && 0 != num_allocations)
+      reportUnexpected("testValidityMask: createScatterColumns allocated memory while redisplaying unchanged data");
+  }
+
+  // Histograms leave out the bins invalid in either sequence. Runs of drawn bins separated by bins left out or by gaps
+  // are broken by a single NaN vertex, but bins left out at either end add no break.
+  const double hist_low_array[] = { -1., 0., 1., 2., 3., 5., 6., 7. };
+  const double hist_high_array[] = { 0., 1., 2., 3., 4., 6., 7., 8. };
+  const double hist_value_array[] = { 1., 2., nan, inf, 5., 6., -7., 8. };
+  const std::vector<double>::size_type num_hist_bins = sizeof(hist_value_array) / sizeof(hist_value_array[0]);
+  std::vector<double> hist_low(hist_low_array, hist_low_array + num_hist_bins);
+  std::vector<double> hist_high(hist_high_array, hist_high_array + num_hist_bins);
+  std::vector<double> hist_value(hist_value_array, hist_value_array + num_hist_bins);
+  IntervalSequence<std::vector<double>::const_iterator> hist_x(hist_low.begin(), hist_low.end(), hist_high.begin());
+  PointSequence<std::vector<double>::const_iterator> hist_y(hist_value.begin(), hist_value.end());
+  for (int log_flag = 0; log_flag != 2; ++log_flag) {
+    // Bin 0 is left out on a logarithmic x axis, and bin 6 on a logarithmic y axis. Bins 2 and 3 are never drawn, and
+    // there is a gap between bins 4 and 5.
+    const double linear_x[] = { -1., 0., 0., 1., nan, 3., 4., nan, 5., 6., 6., 7., 7., 8. };
+    const double linear_y[] = { 1., 1., 2., 2., nan, 5., 5., nan, 6., 6., -7., -7., 8., 8. };
+    const double log_x[] = { 0., 1., nan, 3., 4., nan, 5., 6., nan, 7., 8. };
+    const double log_y[] = { 2., 2., nan, 5., 5., nan, 6., 6., nan, 8., 8. };
+    const double * expected_hist_x = 0 == log_flag ? linear_x : log_x;
+    const double * expected_hist_y = 0 == log_flag ? linear_y : log_y;
+    unsigned long expected_num_vals = (0 == log_flag ? sizeof(linear_x) : sizeof(log_x)) / sizeof(double);
+    pool.reset();
+    const double * x_vals = 0;
+    const double * y_vals = 0;
+    unsigned long num_vals = pool.createStepCurve(hist_x, hist_y, 0 != log_flag, 0 != log_flag, x_vals, y_vals);
+    bool ok = expected_num_vals == num_vals;
+    for (unsigned long ii = 0; ok && ii != num_vals; ++ii) {
+      if (expected_hist_x[ii] != expected_hist_x[ii])
+        ok = x_vals[ii] != x_vals[ii] && y_vals[ii] != y_vals[ii];
+      else
+        ok = expected_hist_x[ii] == x_vals[ii] && expected_hist_y[ii] == y_vals[ii];
+    }
+    if (!ok) reportUnexpected("testValidityMask: createStepCurve drew the wrong bins of a histogram");
+  }
+
+  // Long sequences are checked in blocks, without extracting the whole sequence, and give the same mask as checking
+  // whole columns. Sequences without efficient ranges are extracted once instead; the plain sequence has finite
+  // spreads, so only element 1024 differs.
+  std::vector<double> long_value(1300);
+  std::vector<double> long_spread(long_value.size(), 1.);
+  for (std::vector<double>::size_type ii = 0; ii != long_value.size(); ++ii) long_value[ii] = ii % 17 - 3.;
+  long_value[511] = nan;
+  long_value[512] = -inf;
+  long_spread[1024] = inf;
+  long_value[1299] = nan;
+  ValueSpreadSequence<std::vector<double>::const_iterator> long_seq(long_value.begin(), long_value.end(),
+    long_spread.begin());
+  PlainSequence plain(long_value);
+  for (int positive_flag = 0; positive_flag != 2; ++positive_flag) {
+    ValidityMask expected(long_value.size());
+    expected.markInvalid(&long_value[0], 0 != positive_flag);
+    expected.markInvalid(&long_spread[0]);
+    unsigned long num_allocations = s_num_allocations;
+    std::shared_ptr<const ValidityMask> long_mask(long_seq.getValidityMask(0 != positive_flag));
+    num_allocations = s_num_allocations - num_allocations;
+    std::shared_ptr<const ValidityMask> plain_mask(plain.getValidityMask(0 != positive_flag));
+    bool ok = expected.getNumInvalid() == long_mask->getNumInvalid() &&
+      expected.getNumInvalid() - 1 == plain_mask->getNumInvalid();
+    for (std::vector<double>::size_type ii = 0; ok && ii != long_value.size(); ++ii)
+      ok = expected.isValid(ii) == long_mask->isValid(ii) &&
+        (1024 == ii || expected.isValid(ii) == plain_mask->isValid(ii));
+    if (!ok) reportUnexpected("testValidityMask: getValidityMask marked the wrong elements of a long sequence invalid");
+    if (2 < num_allocations) reportUnexpected("testValidityMask: getValidityMask extracted a long sequence whole");
+  }
+  try {
+    ValidityMask misaligned(long_value.size());
+    misaligned.markInvalid(100, 10, &long_value[0]);
+    reportUnexpected("testValidityMask: markInvalid did not throw for a range not aligned with the mask words");
+  } catch (const std::logic_error &) {
+  }
+
+  // Every instruction set finds the same invalid elements as the scalar code, including signed zeros, denormals and
+  // infinities, for lengths which exercise full vectors, left-over elements and several mask words.
+  const double special[] = { 0., -0., std::numeric_limits<double>::denorm_min(), -std::numeric_limits<double>::denorm_min(),
+    inf, -inf, nan, 1., -1., std::numeric_limits<double>::max(), -std::numeric_limits<double>::max() };
+  const int num_special = sizeof(special) / sizeof(special[0]);
+  const SimdKernel::InstructionSet_e iset[] = { SimdKernel::eSse2, SimdKernel::eAvx2, SimdKernel::eBest };
+  for (unsigned long size = 1; size < 200; size += 23) {
+    std::vector<double> data(size);
+    for (unsigned long ii = 0; ii != size; ++ii) data[ii] = special[(ii * 7) % num_special];
+    for (int positive_flag = 0; positive_flag != 2; ++positive_flag) {
+      std::vector<unsigned long long> expected((size + 63) / 64, 0);
+      SimdKernel::findInvalid(&data[0], size, 0 != positive_flag, &expected[0], SimdKernel::eScalar);
+      unsigned long num_invalid = 0;
+      for (unsigned long ii = 0; ii != size; ++ii) {
+        bool invalid = !(std::fabs(data[ii]) <= std::numeric_limits<double>::max()) || (positive_flag && !(data[ii] > 0.));
+        if (invalid != (0 != ((expected[ii / 64] >> (ii % 64)) & 1))) ++num_invalid;
+      }
+      if (0 != num_invalid) reportUnexpected("testValidityMask: SimdKernel::findInvalid scalar result is wrong");
+      for (unsigned int iset_idx = 0; iset_idx != sizeof(iset) / sizeof(iset[0]); ++iset_idx) {
+        std::vector<unsigned long long> mask((size + 63) / 64, 0);
+        SimdKernel::findInvalid(&data[0], size, 0 != positive_flag, &mask[0], iset[iset_idx]);
+        if (expected != mask) {
+          std::ostringstream os;
+          os << "testValidityMask: SimdKernel::findInvalid using " << SimdKernel::getName(iset[iset_idx]) <<
+            " differed from scalar result for " << size << " elements";
+          reportUnexpected(os.str());
+        }
+      }
+    }
+  }
+}
+
+void StGraphTestApp::testEventHistogrammer() {
+  using namespace st_graph;
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+
+  // Bins must be defined by a finite, increasing range or set of edges.
+  try {
+    EventHistogrammer hist(1., 1., 10);
+    reportUnexpected("testEventHistogrammer: EventHistogrammer accepted an empty range of bins");
+  } catch (const std::logic_error &) {
+  }
+  try {
+    EventHistogrammer hist(std::vector<double>(3, 1.));
+    reportUnexpected("testEventHistogrammer: EventHistogrammer accepted bin edges which do not increase");
+  } catch (const std::logic_error &) {
+  }
+
+  // Uniform bins include their lower edges, and the last bin also its upper edge. Events outside are not binned.
+  EventHistogrammer uniform(0., 1., 10);
+  const double uniform_event[] = { 0., .1, .35, .999, 1., -1.e-300, 1.0000001, nan, .75 };
+  const EventHistogrammer::size_type uniform_bin[] = { 0, 1, 3, 9, 9, 10, 10, 10, 7 };
+  for (unsigned int ii = 0; ii != sizeof(uniform_event) / sizeof(uniform_event[0]); ++ii) {
+    if (uniform_bin[ii] != uniform.findBin(uniform_event[ii])) {
+      std::ostringstream os;
+      os << "testEventHistogrammer: findBin(" << uniform_event[ii] << ") returned " << uniform.findBin(uniform_event[ii]) <<
+        ", not " << uniform_bin[ii];
+      reportUnexpected(os.str());
+    }
+  }
+
+  // Bins of variable width put every event in the same bin as a search of the edges.
+  std::vector<double> edges;
+  for (double edge = 1.; edge < 1000.; edge *= 1.37) edges.push_back(edge);
+  EventHistogrammer variable(edges);
+  if (variable.isUniform() || edges.size() - 1 != variable.getNumBins())
+    reportUnexpected("testEventHistogrammer: EventHistogrammer created wrong bins from edges");
+
+  // Count a million events, so that they are counted in parallel slices, and compare with counts made one by one.
+  std::vector<double> event(1000000);
+  for (std::vector<double>::size_type ii = 0; ii != event.size(); ++ii)
+    event[ii] = (ii % 5 == 4) ? edges[ii % edges.size()] : std::fmod(ii * 0.61803398875, 1.) * 1100. - 50.;
+  event[17] = nan;
+  const EventHistogrammer * hist[] = { &uniform, &variable };
+  for (int hist_idx = 0; hist_idx != 2; ++hist_idx) {
+    const std::vector<double> & hist_edges(hist[hist_idx]->getEdges().getData());
+    std::vector<double> expected(hist[hist_idx]->getNumBins(), 0.);
+    for (std::vector<double>::size_type ii = 0; ii != event.size(); ++ii) {
+      if (!(hist_edges.front() <= event[ii] && event[ii] <= hist_edges.back())) continue;
+      std::vector<double>::size_type bin = std::upper_bound(hist_edges.begin(), hist_edges.end(), event[ii]) -
+        hist_edges.begin() - 1;
+      if (expected.size() == bin) --bin;
+      ++expected[bin];
+      if (hist[hist_idx]->findBin(event[ii]) != bin)
+        reportUnexpected("testEventHistogrammer: findBin disagreed with a search of the bin edges");
+    }
+    SharedColumn counts(hist[hist_idx]->fill(event));
+    if (expected != counts.getData())
+      reportUnexpected("testEventHistogrammer: fill computed counts which differ from those counted one by one");
+    if (counts.getData() != hist[hist_idx]->fill(&event[0], event.size()).getData())
+      reportUnexpected("testEventHistogrammer: fill computed different counts for the same events");
+  }
+
+  // Results plug into sequences: lower edges for LowerBoundSequence, and exact intervals for bins of any width.
+  std::vector<double> lower;
+  std::vector<double> upper;
+  OwningLowerBoundSequence(uniform.getLowerEdges()).getIntervals(lower, upper);
+  if (lower != uniform.getLowerEdges().getData() || std::fabs(upper.back() - 1.) > 1.e-12)
+    reportUnexpected("testEventHistogrammer: LowerBoundSequence over the lower edges did not reproduce uniform bins");
+  variable.createBinSequence().getIntervals(lower, upper);
+  if (lower != variable.getLowerEdges().getData() || upper != variable.getUpperEdges().getData() ||
+    upper.back() != edges.back())
+    reportUnexpected("testEventHistogrammer: createBinSequence did not reproduce the bins");
+  if (OwningPointSequence(uniform.fill(std::vector<double>())).size() != uniform.getNumBins())
+    reportUnexpected("testEventHistogrammer: fill did not produce one count per bin for no events");
+}
+
+void StGraphTestApp::testEventHistogrammer2D() {
+  using namespace st_graph;
+
+  // A grid of uniform bins in x and variable bins in y.
+  std::vector<double> y_edges;
+  for (double edge = 1.; edge < 100.; edge *= 1.2) y_edges.push_back(edge);
+  EventHistogrammer2D hist(EventHistogrammer(-10., 10., 37), EventHistogrammer(y_edges));
+  const EventHistogrammer & x_bins(hist.getXBins());
+  const EventHistogrammer & y_bins(hist.getYBins());
+
+  // Count a million events, so that they are counted in parallel slices, and compare with counts made one by one.
+  std::vector<double> x(1000000);
+  std::vector<double> y(x.size());
+  for (std::vector<double>::size_type ii = 0; ii != x.size(); ++ii) {
+    x[ii] = std::fmod(ii * 0.61803398875, 1.) * 22. - 11.;
+    y[ii] = std::fmod(ii * 0.41421356237, 1.) * 110.;
+  }
+  std::vector<std::vector<double> > expected(x_bins.getNumBins(), std::vector<double>(y_bins.getNumBins(), 0.));
+  for (std::vector<double>::size_type ii = 0; ii != x.size(); ++ii) {
+    EventHistogrammer::size_type x_bin = x_bins.findBin(x[ii]);
+    EventHistogrammer::size_type y_bin = y_bins.findBin(y[ii]);
+    if (x_bins.getNumBins() != x_bin && y_bins.getNumBins() != y_bin) ++expected[x_bin][y_bin];
+  }
+  std::vector<std::vector<double> > z(3, std::vector<double>(5, 1.));
+  hist.fill(x, y, z);
+  if (expected != z) reportUnexpected("testEventHistogrammer2D: fill computed counts which differ from those counted one by one");
+
+  // A small number of events is counted in one slice, with the same result.
+  hist.fill(&x[0], &y[0], 1000, z);
+  double total = 0.;
+  for (std::vector<std::vector<double> >::size_type ii = 0; ii != z.size(); ++ii) {
+    if (y_bins.getNumBins() != z[ii].size())
+      reportUnexpected("testEventHistogrammer2D: fill did not size the grid to match the bins");
+    for (std::vector<double>::size_type jj = 0; jj != z[ii].size(); ++jj) total += z[ii][jj];
+  }
+  double expected_total = 0.;
+  for (std::vector<double>::size_type ii = 0; ii != 1000; ++ii)
+    if (x_bins.getNumBins() != x_bins.findBin(x[ii]) && y_bins.getNumBins() != y_bins.findBin(y[ii])) ++expected_total;
+  if (x_bins.getNumBins() != z.size() || expected_total != total)
+    reportUnexpected("testEventHistogrammer2D: fill computed wrong counts for a small number of events");
+
+  // A grid too large to stay in cache is counted tile by tile. Use more events than are sorted by tile at a time, and
+  // y bins which do not divide the tiles evenly.
+  EventHistogrammer2D large_hist(EventHistogrammer(-10., 10., 700), EventHistogrammer(0., 100., 333));
+  std::vector<double> large_x(1500000);
+  std::vector<double> large_y(large_x.size());
+  for (std::vector<double>::size_type ii = 0; ii != large_x.size(); ++ii) {
+    large_x[ii] = std::fmod(ii * 0.61803398875, 1.) * 22. - 11.;
+    large_y[ii] = std::fmod(ii * 0.41421356237, 1.) * 110.;
+  }
+  const EventHistogrammer & large_x_bins(large_hist.getXBins());
+  const EventHistogrammer & large_y_bins(large_hist.getYBins());
+  expected.assign(large_x_bins.getNumBins(), std::vector<double>(large_y_bins.getNumBins(), 0.));
+  for (std::vector<double>::size_type ii = 0; ii != large_x.size(); ++ii) {
+    EventHistogrammer::size_type x_bin = large_x_bins.findBin(large_x[ii]);
+    EventHistogrammer::size_type y_bin = large_y_bins.findBin(large_y[ii]);
+    if (large_x_bins.getNumBins() != x_bin && large_y_bins.getNumBins() != y_bin) ++expected[x_bin][y_bin];
+  }
+  large_hist.fill(large_x, large_y, z);
+  if (expected != z)
+    reportUnexpected("testEventHistogrammer2D: fill computed wrong counts for a grid counted tile by tile");
+
+  // Coordinates must come in pairs.
+  try {
+    hist.fill(x, std::vector<double>(3), z);
+    reportUnexpected("testEventHistogrammer2D: fill accepted coordinates of different sizes");
+  } catch (const std::logic_error &) {
+  }
+}
+
+void StGraphTestApp::testWeightedHistogram() {
+  using namespace st_graph;
+  EventHistogrammer hist(0., 100., 250);
+
+  // A few events, summed in one slice, give exactly the sums made one by one.
+  const double event_array[] = { .5, .6, 99.9, 100., 150., 42. };
+  const double weight_array[] = { 2., -.5, 1.5, 3., 7., .25 };
+  std::vector<double> event(event_array, event_array + sizeof(event_array) / sizeof(event_array[0]));
+  std::vector<double> weight(weight_array, weight_array + event.size());
+  OwningValueSpreadSequence result(hist.fillWeighted(event, weight));
+  std::vector<double> value;
+  std::vector<double> low_spread;
+  std::vector<double> high_spread;
+  result.getValues(value);
+  result.getSpreads(low_spread, high_spread);
+  if (hist.getNumBins() != value.size() || 1.5 != value[1] || 4.5 != value[249] || .25 != value[105] || 0. != value[2] ||
+    std::sqrt(4.25) != low_spread[1] || std::sqrt(11.25) != high_spread[249] || 0. != low_spread[2])
+    reportUnexpected("testWeightedHistogram: fillWeighted computed wrong sums for a few events");
+
+  // A million events, summed in parallel slices, agree with sums made one by one up to rounding.
+  event.resize(1000000);
+  weight.resize(event.size());
+  for (std::vector<double>::size_type ii = 0; ii != event.size(); ++ii) {
+    event[ii] = std::fmod(ii * 0.61803398875, 1.) * 110. - 5.;
+    weight[ii] = 1. / (1. + std::fmod(ii * 0.41421356237, 1.) * 1000.);
+  }
+  std::vector<double> sum(hist.getNumBins(), 0.);
+  std::vector<double> sum_squares(hist.getNumBins(), 0.);
+  for (std::vector<double>::size_type ii = 0; ii != event.size(); ++ii) {
+    EventHistogrammer::size_type bin = hist.findBin(event[ii]);
+    if (hist.getNumBins() == bin) continue;
+    sum[bin] += weight[ii];
+    sum_squares[bin] += weight[ii] * weight[ii];
+  }
+  hist.fillWeighted(&event[0], &weight[0], event.size()).getValues(value);
+  hist.fillWeighted(event, weight).getSpreads(low_spread, high_spread);
+  for (std::vector<double>::size_type bin = 0; bin != sum.size(); ++bin) {
+    if (std::fabs(value[bin] - sum[bin]) > 1.e-12 * sum[bin] ||
+      std::fabs(low_spread[bin] - std::sqrt(sum_squares[bin])) > 1.e-12 * low_spread[bin] || low_spread != high_spread) {
+      reportUnexpected("testWeightedHistogram: fillWeighted computed sums which differ from those made one by one");
+      break;
+    }
+  }
+
+  // Calls made from inside the shared thread pool cannot use other threads, but give the same result to the last bit.
+  std::vector<std::vector<double> > serial_value(2);
+  std::vector<std::vector<double> > serial_spread(2);
+  ThreadPool::instance().run(2, WeightedFillTask(hist, event, weight, serial_value, serial_spread));
+  if (value != serial_value[0] || value != serial_value[1] || low_spread != serial_spread[0] ||
+    low_spread != serial_spread[1])
+    reportUnexpected("testWeightedHistogram: fillWeighted result depended on the number of threads");
+
+  try {
+    hist.fillWeighted(event, std::vector<double>(3));
+    reportUnexpected("testWeightedHistogram: fillWeighted accepted events and weights of different sizes");
+  } catch (const std::logic_error &) {
+  }
 }
 
 void StGraphTestApp::reportUnexpected(const std::string & text) const {
@@ -664,3 +2808,69 @@ int main(int argc, char ** argv) {
 
   return status;
 }
+
+void StGraphTestApp::testPlainSequence() {
+  using namespace st_graph;
+  typedef ISequence::size_type size_type;
+
+  // Enough elements that extracting the whole sequence for every block would take minutes.
+  const size_type num_points = 200000;
+  std::vector<double> value(num_points);
+  for (size_type ii = 0; ii != num_points; ++ii) value[ii] = ii % 1000 - 100.;
+  value[123456] = 5000.;
+  PlainSequence plain(value);
+  if (plain.hasEfficientRanges()) reportUnexpected("testPlainSequence: plain sequence claims efficient ranges");
+
+  // Statistics are computed from a single extraction of each column.
+  SequenceStatistics stats(plain.getStatistics());
+  if (-100. != stats.getMinValue() || 5000. != stats.getMaxValue() || -100.5 != stats.getMinLower() ||
+    5000.5 != stats.getMaxUpper() || num_points != stats.getNumFinite())
+    reportUnexpected("testPlainSequence: getStatistics returned wrong statistics");
+  if (3 < plain.getNumExtractions())
+    reportUnexpected("testPlainSequence: getStatistics extracted the sequence more than once per column");
+
+  // So are converted values.
+  unsigned long num_extractions = plain.getNumExtractions();
+  std::vector<float> float_value;
+  plain.getValuesAs(float_value);
+  std::vector<float> float_lower;
+  std::vector<float> float_upper;
+  plain.getSpreadsAs(float_lower, float_upper);
+  if (float_value.size() != num_points || 5000.f != float_value[123456] || 899.f != float_value[num_points - 1] ||
+    .5f != float_lower[17] || .5f != float_upper[num_points - 1])
+    reportUnexpected("testPlainSequence: getValuesAs or getSpreadsAs returned wrong elements");
+  if (num_extractions + 3 < plain.getNumExtractions())
+    reportUnexpected("testPlainSequence: conversion extracted the sequence more than once per column");
+
+  // Expressions over the sequence extract it once, not once per block.
+  num_extractions = plain.getNumExtractions();
+  ScaledSequence scaled(2. * plain + 1.);
+  if (scaled.hasEfficientRanges()) reportUnexpected("testPlainSequence: expression claims efficient ranges");
+  std::vector<double> scaled_value;
+  std::vector<double> scaled_high;
+  scaled.getValues(scaled_value);
+  scaled.getIntervals(scaled_value, scaled_high);
+  scaled.getValues(scaled_value);
+  if (10001. != scaled_value[123456] || 1799. != scaled_value[num_points - 1] || 10002. != scaled_high[123456])
+    reportUnexpected("testPlainSequence: expression returned wrong elements");
+  if (num_extractions + 9 < plain.getNumExtractions())
+    reportUnexpected("testPlainSequence: expression extracted its operand once per block");
+
+  // Decimating the sequence keeps the spike, and reads the selected elements from one extraction.
+  std::vector<double> time(num_points);
+  for (size_type ii = 0; ii != num_points; ++ii) time[ii] = ii;
+  ValueSequence<std::vector<double>::const_iterator> x(time.begin(), time.end());
+  std::vector<size_type> selected;
+  DecimatedSequence::selectElements(x, plain, 1000, DecimatedSequence::eMinMax, selected);
+  if (selected.end() == std::find(selected.begin(), selected.end(), 123456))
+    reportUnexpected("testPlainSequence: decimation lost the spike");
+  num_extractions = plain.getNumExtractions();
+  DecimatedSequence decimated(plain, selected);
+  std::vector<double> decimated_value;
+  decimated.getValues(decimated_value);
+  bool ok = decimated_value.size() == selected.size();
+  for (size_type ii = 0; ok && ii != selected.size(); ++ii) ok = value[selected[ii]] == decimated_value[ii];
+  if (!ok) reportUnexpected("testPlainSequence: decimated sequence returned wrong elements");
+  if (num_extractions + 3 < plain.getNumExtractions())
+    reportUnexpected("testPlainSequence: decimated sequence extracted its source more than once per column");
+}
@@ -0,0 +1,128 @@
+/** \file DecimatedSequence.h
+    \brief Declaration of DecimatedSequence class.
+*/
+#ifndef st_graph_DecimatedSequence_h
+#define st_graph_DecimatedSequence_h
+
+#include <memory>
+#include <vector>
+
+#include "st_graph/Sequence.h"
+
+namespace st_graph {
+
+  /** \class DecimatedSequence
+      \brief An ISequence consisting of selected elements of another sequence, used to reduce a pair of x and y
+             sequences to a number of points which can be drawn quickly, while preserving what the plot looks like.
+             The elements are selected once for the pair by selectElements, after which one DecimatedSequence is
+             constructed for each of x and y from the same selection. Each element keeps all the properties it has in
+             the original sequence, including its bounds and spreads.
+  */
+  class DecimatedSequence : public ISequence {
+    public:
+      /// \brief Methods of selecting elements.
+      enum Mode_e {
+        /// Split the elements into buckets of equal count and select the elements with the smallest and the largest
+        /// y value in each bucket, so that the envelope of the plot is preserved exactly.
+        eMinMax,
+        /// Largest-Triangle-Three-Buckets: select the first and the last element, and from each bucket in between
+        /// the element forming the triangle of largest area with the element selected from the previous bucket and
+        /// the average of the next bucket, so that the shape of the curve is preserved.
+        eLargestTriangle
+      };
+
+      /** \brief Select at most max_points elements from a pair of sequences, in linear time, and return their
+                 indices in increasing order. All elements are selected if there are no more than max_points of them.
+                 Otherwise elements whose y value, or in eLargestTriangle mode whose x or y value, is not finite are
+                 never selected.
+          \param x The sequence giving the positions of the points. Only used in eLargestTriangle mode.
+          \param y The sequence giving the values of the points.
+          \param max_points The maximum number of elements to select.
+          \param mode The method of selecting elements.
+          \param selected The output indices of the selected elements.
+          \param num_threads The number of parts into which the work is split, which run on the shared ThreadPool.
+                 The values of the sequences are extracted once by the calling thread, so the sequences need not
+                 support use by several threads. The selection does not depend on the number of threads. In
+                 eLargestTriangle mode only the averaging of the buckets is done in parallel, because each selection
+                 depends on the one before it.
+      */
+      static void selectElements(const ISequence & x, const ISequence & y, size_type max_points, Mode_e mode,
+        std::vector<size_type> & selected, unsigned int num_threads = 1);
+
+      /** \brief Decide whether a pair of sequences, to be drawn as points or lines across the given number of pixels,
+                 has so many more points than pixels that it should be decimated, and if so select the elements to
+                 draw, using all processors. The range of x from its cached statistics is split into one bucket per
+                 pixel column, from each of which the elements with the smallest and the largest finite y value are
+                 selected, so that the envelope of the plot is preserved exactly even where points are denser in some
+                 columns than others. Only pairs whose x values are in non-decreasing order are decimated, so that each
+                 bucket is a contiguous range of elements. Returns false if the pair should be drawn in full. Plots
+                 cache the selection until they are resized or their statistics are cleared.
+          \param x The sequence giving the positions of the points.
+          \param y The sequence giving the values of the points.
+          \param num_pixels The width of the plot in pixels.
+          \param selected The output indices of the selected elements.
+      */
+      static bool selectForDisplay(const ISequence & x, const ISequence & y, size_type num_pixels,
+        std::vector<size_type> & selected);
+
+      /** \brief Create a sequence from the selected elements of another sequence.
+          \param source The sequence from which elements are selected. The sequence is cloned.
+          \param selected The indices of the selected elements, as returned by selectElements.
+      */
+      DecimatedSequence(const ISequence & source, const std::vector<size_type> & selected);
+
+      /** \brief Fill the output container with the values of the sequence.
+          \param val The output container.
+      */
+      virtual void getValues(std::vector<double> & val) const;
+
+      /** \brief Fill the output containers with the upper and lower bounds of each element in the sequence.
+          \param lower The lower bounds of the sequence elements.
+          \param upper The upper bounds of the sequence elements.
+      */
+      virtual void getIntervals(std::vector<double> & lower, std::vector<double> & upper) const;
+
+      /** \brief Fill the output containers with the upper and lower spreads of each element in the sequence.
+          \param lower The lower spreads of the sequence elements.
+          \param upper The upper spreads of the sequence elements.
+      */
+      virtual void getSpreads(std::vector<double> & lower, std::vector<double> & upper) const;
+
+      /** \brief Fill the requested columns of a structure-of-arrays block in a single pass over the selected elements.
+          \param mask Bitwise combination of SequenceColumns::Column_e values selecting the columns to fill.
+          \param columns The output block.
+      */
+      virtual void getColumns(unsigned int mask, SequenceColumns & columns) const {
+        getColumnRange(mask, 0, size(), columns);
+      }
+
+      /** \brief Return true if the source sequence computes ranges efficiently. Otherwise each range of selected
+                 elements is gathered from one extraction of the whole source.
+      */
+      virtual bool hasEfficientRanges() const { return m_source->hasEfficientRanges(); }
+
+      /// \brief Return true if the data read by the source sequence cannot change.
+      virtual bool hasFixedData() const { return m_source->hasFixedData(); }
+
+      /// \brief Return the sequence from which elements are selected.
+      const ISequence & getSource() const { return *m_source; }
+
+      /// \brief Return the indices of the selected elements in the source sequence.
+      const std::vector<size_type> & getSelected() const { return *m_selected; }
+
+      /** \brief Return a new copy of the current ISequence subclass.
+      */
+      virtual ISequence * clone() const { return new DecimatedSequence(*this); }
+
+    protected:
+      virtual void fillRange(size_type offset, size_type count, double * out_val, double * out_low, double * out_high,
+        double * out_low_spread, double * out_high_spread) const;
+
+    private:
+      std::shared_ptr<const ISequence> m_source;
+      std::shared_ptr<const std::vector<size_type> > m_selected;
+  };
+
+}
+
+#endif
@@ -0,0 +1,171 @@
+/** \file EventHistogrammer.h
+    \brief Declaration of EventHistogrammer and EventHistogrammer2D classes.
+*/
+#ifndef st_graph_EventHistogrammer_h
+#define st_graph_EventHistogrammer_h
+
+#include <vector>
+
+#include "st_graph/OwningSequence.h"
+
+namespace st_graph {
+
+  /** \class EventHistogrammer
+      \brief Counts events, e.g. photon arrival times or energies, in a fixed set of bins, using every thread of the
+             shared ThreadPool. The bins are either uniform, in which case the bin of each event is computed directly
+             from its value, or given by arbitrary increasing edges, in which case it is found by a binary search
+             without data-dependent branches. Events outside the bins, and NaN events, are not counted. Each bin
+             includes its lower edge and excludes its upper edge, except that the last bin also includes its upper
+             edge.
+
+             Long event arrays are split into slices whose number depends only on the number of events and bins, never
+             on the number of threads. Each slice is counted into private bins, which are then added together in slice
+             order, so the counts are identical however many threads do the work. Weighted sums are likewise added
+             in a fixed order, so they too are reproducible to the last bit.
+
+             The results are shared columns, so they may be plotted directly, e.g. with OwningLowerBoundSequence over
+             getLowerEdges() and OwningPointSequence over the counts, without being copied.
+  */
+  class EventHistogrammer {
+    public:
+      typedef SharedColumn::size_type size_type;
+
+      /** \brief Create uniform bins spanning the given range.
+          \param low The lower edge of the first bin.
+          \param high The upper edge of the last bin, which must be greater than low.
+          \param num_bins The number of bins, which must not be 0.
+      */
+      EventHistogrammer(double low, double high, size_type num_bins);
+
+      /** \brief Create bins with the given edges.
+          \param edges The edges of the bins, at least two, which must be finite and strictly increasing. Bin ii spans
+                 edges[ii] to edges[ii + 1].
+      */
+      explicit EventHistogrammer(const std::vector<double> & edges);
+
+      /// \brief Return the number of bins.
+      size_type getNumBins() const { return m_lower.size(); }
+
+      /// \brief Return true if the bins are uniform, so that bin numbers are computed without searching.
+      bool isUniform() const { return m_uniform; }
+
+      /// \brief Return the getNumBins() + 1 edges of the bins.
+      const SharedColumn & getEdges() const { return m_edges; }
+
+      /** \brief Return the lower edges of the bins, as read by LowerBoundSequence. LowerBoundSequence extrapolates the
+                 upper edge of the last bin from the width of the one before it, so for bins of variable width whose
+                 last two widths differ, createBinSequence should be used instead.
+      */
+      const SharedColumn & getLowerEdges() const { return m_lower; }
+
+      /// \brief Return the upper edges of the bins.
+      const SharedColumn & getUpperEdges() const { return m_upper; }
+
+      /// \brief Return a sequence whose intervals are exactly the bins, for plotting bins of any widths.
+      OwningIntervalSequence createBinSequence() const { return OwningIntervalSequence(m_lower, m_upper); }
+
+      /** \brief Return the bin containing the given event, or getNumBins() if the event is outside the bins or NaN.
+          \param event The event.
+      */
+      size_type findBin(double event) const;
+
+      /** \brief Return the number of events in each bin.
+          \param event The events.
+          \param num_events The number of events.
+      */
+      SharedColumn fill(const double * event, size_type num_events) const;
+
+      /** \brief Return the number of events in each bin.
+          \param event The events.
+      */
+      SharedColumn fill(const std::vector<double> & event) const {
+        return fill(event.empty() ? 0 : &event[0], event.size());
+      }
+
+      /** \brief Return the sum of the weights of the events in each bin, as values, with the square root of the sum of
+                 the squares of the weights, their statistical error, as spreads. Both are accumulated in a single pass.
+                 The result is the same to the last bit however many threads do the work.
+          \param event The events.
+          \param weight The weight of each event.
+          \param num_events The number of events.
+      */
+      OwningValueSpreadSequence fillWeighted(const double * event, const double * weight, size_type num_events) const;
+
+      /** \brief Return the sum of the weights of the events in each bin, as values, with the square root of the sum of
+                 the squares of the weights as spreads.
+          \param event The events.
+          \param weight The weight of each event, which must have the same size as event.
+      */
+      OwningValueSpreadSequence fillWeighted(const std::vector<double> & event, const std::vector<double> & weight) const;
+
+      /** \brief Compute the bin of each of a range of events, storing getNumBins() for events outside the bins.
+          \param event The events.
+          \param num_events The number of events.
+          \param bin The output bins, with room for num_events bins.
+      */
+      void findBins(const double * event, size_type num_events, size_type * bin) const;
+
+    private:
+      void setEdges(const std::vector<double> & edges);
+
+      SharedColumn m_edges;
+      SharedColumn m_lower;
+      SharedColumn m_upper;
+      double m_low;
+      double m_high;
+      double m_inverse_width;
+      bool m_uniform;
+  };
+
+  /** \class EventHistogrammer2D
+      \brief Counts events with two coordinates, e.g. (ra, dec) or (time, energy), in a grid of bins, producing the z
+             data of a three dimensional plot. The bins of each dimension are those of an EventHistogrammer, whose
+             bin sequences serve as the x and y sequences of the plot.
+
+             As for EventHistogrammer, events are split into slices whose number does not depend on the number of
+             threads. Grids small enough to stay in cache are counted one slice at a time into private grids, which
+             are then added in slice order. Larger grids are split into cache-sized tiles of whole x rows; events are
+             sorted by tile a chunk at a time, in slices, and each tile is then counted by one task, so no private
+             grids are needed and the work stays parallel however large the grid. Either way the counts are identical
+             however many threads do the work.
+  */
+  class EventHistogrammer2D {
+    public:
+      typedef EventHistogrammer::size_type size_type;
+
+      /** \brief Create a grid of bins from the bins of each dimension.
+          \param x_bins The bins of the first dimension.
+          \param y_bins The bins of the second dimension.
+      */
+      EventHistogrammer2D(const EventHistogrammer & x_bins, const EventHistogrammer & y_bins): m_x_bins(x_bins),
+        m_y_bins(y_bins) {}
+
+      /// \brief Return the bins of the first dimension.
+      const EventHistogrammer & getXBins() const { return m_x_bins; }
+
+      /// \brief Return the bins of the second dimension.
+      const EventHistogrammer & getYBins() const { return m_y_bins; }
+
+      /** \brief Count the events in each cell of the grid. Events outside the bins in either dimension are not counted.
+          \param x The first coordinates of the events.
+          \param y The second coordinates of the events.
+          \param num_events The number of events.
+          \param z The output counts, resized so that z[ii][jj] is the number of events in x bin ii and y bin jj.
+      */
+      void fill(const double * x, const double * y, size_type num_events, std::vector<std::vector<double> > & z) const;
+
+      /** \brief Count the events in each cell of the grid. Events outside the bins in either dimension are not counted.
+          \param x The first coordinates of the events.
+          \param y The second coordinates of the events, which must have the same size as x.
+          \param z The output counts, resized so that z[ii][jj] is the number of events in x bin ii and y bin jj.
+      */
+      void fill(const std::vector<double> & x, const std::vector<double> & y, std::vector<std::vector<double> > & z) const;
+
+    private:
+      EventHistogrammer m_x_bins;
+      EventHistogrammer m_y_bins;
+  };
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+/** \file FitsColumnSequence.h
+    \brief Declaration of FitsColumnSequence class.
+*/
+#ifndef st_graph_FitsColumnSequence_h
+#define st_graph_FitsColumnSequence_h
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "st_graph/Sequence.h"
+
+namespace st_graph {
+
+  class FitsTable;
+
+  /** \class FitsColumnSequence
+      \brief An ISequence which streams a numeric column of a FITS binary table directly from the file, optionally
+             together with a second column holding the symmetric error of each value. Elements behave like those of
+             a ValueSpreadSequence; without an error column, spreads are 0. Rows are read in blocks of the table's
+             optimal row count, so extracting a range of elements (see ISequence::getRange) holds at most one block
+             of the table in memory in addition to the output, however many rows the table has.
+
+             Copies share the open file, whose reads are serialized, and each extraction uses its own row buffers, so
+             copies may be used concurrently by different threads.
+  */
+  class FitsColumnSequence : public ISequence {
+    public:
+      /** \brief Open a column, and optionally an error column, in a binary table extension of a FITS file.
+          \param file_name The name of the file.
+          \param ext_name The name of the table extension.
+          \param value_column The name of the column holding the values.
+          \param error_column The name of the column holding the errors, or an empty string if there is none.
+      */
+      FitsColumnSequence(const std::string & file_name, const std::string & ext_name, const std::string & value_column,
+        const std::string & error_column = std::string());
+
+      /** \brief Fill the output container with the values of the sequence.
+          \param val The output container.
+      */
+      virtual void getValues(std::vector<double> & val) const;
+
+      /** \brief Fill the output containers with the upper and lower bounds of each element in the sequence.
+          \param lower The lower bounds of the sequence elements.
+          \param upper The upper bounds of the sequence elements.
+      */
+      virtual void getIntervals(std::vector<double> & lower, std::vector<double> & upper) const;
+
+      /** \brief Fill the output containers with the upper and lower spreads of each element in the sequence.
+          \param lower The lower spreads of the sequence elements.
+          \param upper The upper spreads of the sequence elements.
+      */
+      virtual void getSpreads(std::vector<double> & lower, std::vector<double> & upper) const;
+
+      /** \brief Fill the requested columns of a structure-of-arrays block in a single pass over the table.
+          \param mask Bitwise combination of SequenceColumns::Column_e values selecting the columns to fill.
+          \param columns The output block.
+      */
+      virtual void getColumns(unsigned int mask, SequenceColumns & columns) const {
+        getColumnRange(mask, 0, size(), columns);
+      }
+
+      /// \brief Return true, because a range is read from the rows which hold it alone.
+      virtual bool hasEfficientRanges() const { return true; }
+
+      /// \brief Return the number of rows read from the file at a time.
+      size_type getBlockSize() const;
+
+      /** \brief Return a new copy of the current ISequence subclass.
+      */
+      virtual ISequence * clone() const { return new FitsColumnSequence(*this); }
+
+    protected:
+      virtual void fillRange(size_type offset, size_type count, double * out_val, double * out_low, double * out_high,
+        double * out_low_spread, double * out_high_spread) const;
+
+    private:
+      FitsColumnSequence(const std::shared_ptr<FitsTable> & table);
+
+      std::shared_ptr<FitsTable> m_table;
+  };
+
+}
+
+#endif
@@ -45,6 +45,13 @@ namespace st_graph {
       /// \brief Get the sequences this plot represents.
       virtual const std::vector<const ISequence *> getSequences() const = 0;
 
+      /** \brief Discard the statistics, masks and other results cached for the sequences this plot represents. Plots
+                 already discard before each display the results of sequences whose data may be modified in place (see
+                 ISequence::hasFixedData), so this need only be called to release the memory the results occupy. The
+                 default implementation does nothing.
+      */
+      virtual void clearStatistics() {}
+
       /// \brief Get this plot's axes objects, with modification rights.
       virtual std::vector<Axis> & getAxes() = 0;
 
@@ -0,0 +1,126 @@
+/** \file MappedColumn.h
+    \brief Declaration of MappedColumn class and sequences which read memory-mapped columns in place.
+*/
+#ifndef st_graph_MappedColumn_h
+#define st_graph_MappedColumn_h
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "st_graph/Sequence.h"
+
+namespace st_graph {
+
+  class MappedFile;
+
+  /** \class MappedColumn
+      \brief A column of doubles held in a file, which is mapped into memory rather than read. Pages of the file are
+             only read when the data are first accessed, so opening even a very large file is fast. Copies of a column
+             share the mapping, which is released when the last copy is destroyed.
+
+             Two file formats are supported: raw binary arrays of doubles in the byte order of the host, and NumPy
+             .npy files containing a one-dimensional array of doubles in the byte order of the host.
+  */
+  class MappedColumn {
+    public:
+      typedef unsigned long size_type;
+
+      /** \brief Map the whole of the given file. Files beginning with the NumPy magic string are interpreted as .npy
+                 files; all others are interpreted as raw arrays of doubles.
+          \param file_name The name of the file.
+      */
+      explicit MappedColumn(const std::string & file_name);
+
+      /** \brief Map part of the given raw binary file.
+          \param file_name The name of the file.
+          \param offset The position of the first double in the file, in bytes. Must be a multiple of the size of a double.
+          \param count The number of doubles in the column.
+      */
+      MappedColumn(const std::string & file_name, size_type offset, size_type count);
+
+      /// \brief Return a pointer to the first double in the column.
+      const double * begin() const { return m_begin; }
+
+      /// \brief Return a pointer to one position past the last double in the column.
+      const double * end() const { return m_end; }
+
+      /// \brief Return the number of doubles in the column.
+      size_type size() const { return m_end - m_begin; }
+
+      /// \brief Return the name of the mapped file.
+      const std::string & getFileName() const { return m_file_name; }
+
+    private:
+      void setData(size_type offset, size_type count);
+      void parseNpyHeader(size_type & offset, size_type & count) const;
+
+      std::shared_ptr<const MappedFile> m_file;
+      std::string m_file_name;
+      const double * m_begin;
+      const double * m_end;
+  };
+
+  /** \class MappedColumnSequence
+      \brief A sequence whose elements are read in place from a memory-mapped column. Seq_t is one of the sequence
+             templates taking a single range of iterators (PointSequence, ValueSequence or LowerBoundSequence), which
+             determines how elements are interpreted. The sequence keeps the mapping alive for its lifetime.
+  */
+  template <template <typename> class Seq_t>
+  class MappedColumnSequence : public Seq_t<const double *> {
+    public:
+      /** \brief Create a sequence spanning the given column.
+          \param column The column.
+      */
+      MappedColumnSequence(const MappedColumn & column): Seq_t<const double *>(column.begin(), column.end()),
+        m_column(column) {}
+
+      /// \brief Return the mapped column read by this sequence.
+      const MappedColumn & getColumn() const { return m_column; }
+
+      /** \brief Return a new copy of the current ISequence subclass.
+      */
+      virtual ISequence * clone() const { return new MappedColumnSequence(*this); }
+
+      /// \brief Return true, because the columns are mapped read-only.
+      virtual bool hasFixedData() const { return true; }
+
+    private:
+      MappedColumn m_column;
+  };
+
+  typedef MappedColumnSequence<PointSequence> MappedPointSequence;
+  typedef MappedColumnSequence<ValueSequence> MappedValueSequence;
+  typedef MappedColumnSequence<LowerBoundSequence> MappedLowerBoundSequence;
+
+  /** \class MappedIntervalSequence
+      \brief An IntervalSequence whose lower and upper bounds are read in place from two memory-mapped columns.
+  */
+  class MappedIntervalSequence : public IntervalSequence<const double *> {
+    public:
+      /** \brief Create a sequence from columns of lower and upper bounds, which must have the same size.
+          \param lower The column of lower bounds.
+          \param upper The column of upper bounds.
+      */
+      MappedIntervalSequence(const MappedColumn & lower, const MappedColumn & upper):
+        IntervalSequence<const double *>(lower.begin(), lower.end(), upper.begin()), m_lower(lower), m_upper(upper) {
+        if (lower.size() != upper.size())
+          throw std::logic_error("MappedIntervalSequence: columns " + lower.getFileName() + " and " +
+            upper.getFileName() + " have different sizes");
+      }
+
+      /** \brief Return a new copy of the current ISequence subclass.
+      */
+      virtual ISequence * clone() const { return new MappedIntervalSequence(*this); }
+
+      /// \brief Return true, because the columns are mapped read-only.
+      virtual bool hasFixedData() const { return true; }
+
+    private:
+      MappedColumn m_lower;
+      MappedColumn m_upper;
+  };
+
+}
+
+#endif
@@ -0,0 +1,182 @@
+/** \file OwningSequence.h
+    \brief Declaration of SharedColumn class and sequences which own the data they read.
+*/
+#ifndef st_graph_OwningSequence_h
+#define st_graph_OwningSequence_h
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "st_graph/Sequence.h"
+
+namespace st_graph {
+
+  /** \class SharedColumn
+      \brief A column of doubles held in reference-counted storage, which is shared by all copies of the column.
+             Copying a column never copies its data. Data are copied only when one copy is modified while the
+             storage is shared with another, so the data seen by every other copy never change.
+
+             Sequences which own their data (see OwningSequence) hold copies of SharedColumn objects. A producer
+             may therefore hand a column to any number of plots, then go on modifying or discarding its own copy
+             without affecting what the plots display.
+  */
+  class SharedColumn {
+    public:
+      typedef std::vector<double>::size_type size_type;
+
+      /// \brief Create an empty column.
+      SharedColumn(): m_data(new std::vector<double>) {}
+
+      /** \brief Create a column holding a copy of the given data.
+          \param data The data.
+      */
+      explicit SharedColumn(const std::vector<double> & data): m_data(new std::vector<double>(data)) {}
+
+      /** \brief Create a column which takes over the given data, without copying them.
+          \param data The data. Left empty on return.
+      */
+      explicit SharedColumn(std::vector<double> && data): m_data(new std::vector<double>) { m_data->swap(data); }
+
+      /** \brief Create a column holding a copy of a range of values.
+          \param begin The first iterator in the range.
+          \param end One past the last iterator in the range.
+      */
+      template <typename Itor_t>
+      SharedColumn(Itor_t begin, Itor_t end): m_data(new std::vector<double>(begin, end)) {}
+
+      /// \brief Return a pointer to the first double in the column.
+      const double * begin() const { return m_data->empty() ? 0 : &m_data->front(); }
+
+      /// \brief Return a pointer to one position past the last double in the column.
+      const double * end() const { return begin() + m_data->size(); }
+
+      /// \brief Return the number of doubles in the column.
+      size_type size() const { return m_data->size(); }
+
+      /// \brief Return the data of the column.
+      const std::vector<double> & getData() const { return *m_data; }
+
+      /** \brief Return the data of the column so that they may be modified. If the storage is shared with any other
+                 copy of the column, this copy first detaches itself by copying the data. The reference may be used
+                 only until this column is next copied, because modifications through it would then be seen by the copy.
+      */
+      std::vector<double> & getMutableData() {
+        if (isShared()) m_data.reset(new std::vector<double>(*m_data));
+        return *m_data;
+      }
+
+      /// \brief Return true if the storage is shared with any other copy of the column.
+      bool isShared() const { return 1 != m_data.use_count(); }
+
+    private:
+      std::shared_ptr<std::vector<double> > m_data;
+  };
+
+  /** \class OwningSequence
+      \brief A sequence whose elements are read in place from a shared column, which the sequence keeps alive for
+             its lifetime. Seq_t is one of the sequence templates taking a single range of iterators (PointSequence,
+             ValueSequence or LowerBoundSequence), which determines how elements are interpreted. Clones share the
+             column, so plots may clone owning sequences freely, and need not be destroyed before the producer's data.
+  */
+  template <template <typename> class Seq_t>
+  class OwningSequence : public Seq_t<const double *> {
+    public:
+      /** \brief Create a sequence spanning the given column.
+          \param column The column.
+      */
+      OwningSequence(const SharedColumn & column): Seq_t<const double *>(column.begin(), column.end()),
+        m_column(column) {}
+
+      /// \brief Return the column read by this sequence.
+      const SharedColumn & getColumn() const { return m_column; }
+
+      /** \brief Return a new copy of the current ISequence subclass.
+      */
+      virtual ISequence * clone() const { return new OwningSequence(*this); }
+
+      /// \brief Return true, because the shared columns are never modified while the sequence holds them.
+      virtual bool hasFixedData() const { return true; }
+
+    private:
+      SharedColumn m_column;
+  };
+
+  typedef OwningSequence<PointSequence> OwningPointSequence;
+  typedef OwningSequence<ValueSequence> OwningValueSequence;
+  typedef OwningSequence<LowerBoundSequence> OwningLowerBoundSequence;
+
+  /** \class OwningIntervalSequence
+      \brief An IntervalSequence whose lower and upper bounds are read in place from two shared columns.
+  */
+  class OwningIntervalSequence : public IntervalSequence<const double *> {
+    public:
+      /** \brief Create a sequence from columns of lower and upper bounds, which must have the same size.
+          \param lower The column of lower bounds.
+          \param upper The column of upper bounds.
+      */
+      OwningIntervalSequence(const SharedColumn & lower, const SharedColumn & upper):
+        IntervalSequence<const double *>(lower.begin(), lower.end(), upper.begin()), m_lower(lower), m_upper(upper) {
+        if (lower.size() != upper.size())
+          throw std::logic_error("OwningIntervalSequence: columns of lower and upper bounds have different sizes");
+      }
+
+      /** \brief Return a new copy of the current ISequence subclass.
+      */
+      virtual ISequence * clone() const { return new OwningIntervalSequence(*this); }
+
+      /// \brief Return true, because the shared columns are never modified while the sequence holds them.
+      virtual bool hasFixedData() const { return true; }
+
+    private:
+      SharedColumn m_lower;
+      SharedColumn m_upper;
+  };
+
+  /** \class OwningValueSpreadSequence
+      \brief A ValueSpreadSequence whose values and spreads are read in place from shared columns.
+  */
+  class OwningValueSpreadSequence : public ValueSpreadSequence<const double *> {
+    public:
+      /** \brief Create a sequence from columns of values and symmetric spreads, which must have the same size.
+          \param value The column of values.
+          \param spread The column of spreads.
+      */
+      OwningValueSpreadSequence(const SharedColumn & value, const SharedColumn & spread):
+        ValueSpreadSequence<const double *>(value.begin(), value.end(), spread.begin()), m_value(value),
+        m_low_spread(spread), m_high_spread(spread) {
+        checkSize();
+      }
+
+      /** \brief Create a sequence from columns of values and asymmetric spreads, which must have the same size.
+          \param value The column of values.
+          \param low_spread The column of lower spreads.
+          \param high_spread The column of upper spreads.
+      */
+      OwningValueSpreadSequence(const SharedColumn & value, const SharedColumn & low_spread,
+        const SharedColumn & high_spread): ValueSpreadSequence<const double *>(value.begin(), value.end(),
+        low_spread.begin(), high_spread.begin()), m_value(value), m_low_spread(low_spread), m_high_spread(high_spread) {
+        checkSize();
+      }
+
+      /** \brief Return a new copy of the current ISequence subclass.
+      */
+      virtual ISequence * clone() const { return new OwningValueSpreadSequence(*this); }
+
+      /// \brief Return true, because the shared columns are never modified while the sequence holds them.
+      virtual bool hasFixedData() const { return true; }
+
+    private:
+      void checkSize() const {
+        if (m_value.size() != m_low_spread.size() || m_value.size() != m_high_spread.size())
+          throw std::logic_error("OwningValueSpreadSequence: columns of values and spreads have different sizes");
+      }
+
+      SharedColumn m_value;
+      SharedColumn m_low_spread;
+      SharedColumn m_high_spread;
+  };
+
+}
+
+#endif
@@ -0,0 +1,286 @@
+/** \file RingSequence.h
+    \brief Declaration of RingColumn class and sequences which read snapshots of it.
+*/
+#ifndef st_graph_RingSequence_h
+#define st_graph_RingSequence_h
+
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "st_graph/Sequence.h"
+
+namespace st_graph {
+
+  /** \class ChunkIterator
+      \brief Random-access iterator over doubles stored in a table of fixed-size chunks, as held by RingColumn
+             snapshots. The iterator refers to the table, which must outlive it.
+  */
+  class ChunkIterator {
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef double value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const double * pointer;
+      typedef const double & reference;
+
+      /// \brief Number of doubles in each chunk, which is a power of 2.
+      static const std::size_t s_chunk_size = 4096;
+
+      ChunkIterator(): m_chunk(0), m_index(0) {}
+
+      /** \brief Create an iterator pointing to the given position in a table of chunks.
+          \param chunk The address of the first entry in the table of chunks.
+          \param index The position, counted from the start of the first chunk.
+      */
+      ChunkIterator(const double * const * chunk, std::size_t index): m_chunk(chunk), m_index(index) {}
+
+      reference operator *() const { return m_chunk[m_index / s_chunk_size][m_index % s_chunk_size]; }
+      reference operator [](difference_type offset) const { return *(*this + offset); }
+
+      ChunkIterator & operator ++() { ++m_index; return *this; }
+      ChunkIterator operator ++(int) { ChunkIterator prev(*this); ++m_index; return prev; }
+      ChunkIterator & operator --() { --m_index; return *this; }
+      ChunkIterator operator --(int) { ChunkIterator prev(*this); --m_index; return prev; }
+      ChunkIterator & operator +=(difference_type offset) { m_index += offset; return *this; }
+      ChunkIterator & operator -=(difference_type offset) { m_index -= offset; return *this; }
+      ChunkIterator operator +(difference_type offset) const { return ChunkIterator(m_chunk, m_index + offset); }
+      ChunkIterator operator -(difference_type offset) const { return ChunkIterator(m_chunk, m_index - offset); }
+      difference_type operator -(const ChunkIterator & other) const { return difference_type(m_index - other.m_index); }
+
+      bool operator ==(const ChunkIterator & other) const { return m_index == other.m_index; }
+      bool operator !=(const ChunkIterator & other) const { return m_index != other.m_index; }
+      bool operator <(const ChunkIterator & other) const { return m_index < other.m_index; }
+      bool operator >(const ChunkIterator & other) const { return m_index > other.m_index; }
+      bool operator <=(const ChunkIterator & other) const { return m_index <= other.m_index; }
+      bool operator >=(const ChunkIterator & other) const { return m_index >= other.m_index; }
+
+      /** \brief Return the number of doubles from this position to the end of its chunk, which are adjacent in memory.
+      */
+      std::size_t getNumContiguous() const { return s_chunk_size - m_index % s_chunk_size; }
+
+    private:
+      const double * const * m_chunk;
+      std::size_t m_index;
+  };
+
+  inline ChunkIterator operator +(ChunkIterator::difference_type offset, const ChunkIterator & itor) {
+    return itor + offset;
+  }
+
+  /** \brief Fill a view of a range of chunked doubles, if the range lies within a single chunk.
+      \param begin The first iterator in the range.
+      \param count The number of elements in the range.
+      \param view The output view.
+  */
+  inline bool makeDataView(const ChunkIterator & begin, unsigned long count, DataView & view) {
+    if (0 == count || count > begin.getNumContiguous()) return false;
+    view = DataView(&*begin);
+    return true;
+  }
+
+  /** \class RingSnapshot
+      \brief The samples held by a RingColumn at one moment. A snapshot shares the chunks of the column, and keeps
+             alive those it refers to. Because the column never overwrites a sample, but appends each one to a fresh
+             slot, later appends never change what a snapshot contains. Copying a snapshot never copies samples.
+  */
+  class RingSnapshot {
+    public:
+      typedef unsigned long size_type;
+
+      /// \brief Create an empty snapshot.
+      RingSnapshot(): m_table(new Table), m_offset(0), m_size(0), m_generation(0) {}
+
+      /// \brief Return an iterator pointing to the first sample in the snapshot.
+      ChunkIterator begin() const { return ChunkIterator(m_table->m_pointer.empty() ? 0 : &m_table->m_pointer[0], m_offset); }
+
+      /// \brief Return an iterator pointing to one position past the last sample in the snapshot.
+      ChunkIterator end() const { return begin() + m_size; }
+
+      /// \brief Return the number of samples in the snapshot.
+      size_type size() const { return m_size; }
+
+      /** \brief Return the number of samples appended to the column before the snapshot was taken, including any
+                 which have since left the window. The last sample in the snapshot was appended as number
+                 getGeneration() - 1, and the first as getGeneration() - size().
+      */
+      unsigned long getGeneration() const { return m_generation; }
+
+      /** \brief Return the number of samples at the end of the snapshot which were appended after the given
+                 generation, e.g. the generation of the snapshot last displayed. Only these need be added to a display
+                 of the earlier snapshot. If every sample is new, the whole snapshot must be displayed again.
+          \param generation The earlier generation.
+      */
+      size_type getNumAppendedSince(unsigned long generation) const {
+        if (generation >= m_generation) return 0;
+        return m_generation - generation < m_size ? size_type(m_generation - generation) : m_size;
+      }
+
+    private:
+      friend class RingColumn;
+
+      // Chunks referred to by a snapshot, and the addresses of their data in a form which iterators may use.
+      struct Table {
+        std::vector<std::shared_ptr<std::vector<double> > > m_chunk;
+        std::vector<const double *> m_pointer;
+      };
+
+      RingSnapshot(const std::shared_ptr<const Table> & table, size_type offset, size_type size,
+        unsigned long generation): m_table(table), m_offset(offset), m_size(size), m_generation(generation) {}
+
+      std::shared_ptr<const Table> m_table;
+      size_type m_offset;
+      size_type m_size;
+      unsigned long m_generation;
+  };
+
+  /** \class RingColumn
+      \brief A column of doubles to which samples are appended during acquisition, in amortized constant time, e.g.
+             to plot live data. The column is either unbounded, or keeps a window of the most recent samples, with
+             older samples discarded as new ones arrive. Each sample appended increments a generation counter.
+
+             Sequences do not read the column directly, but read a RingSnapshot returned by getSnapshot, which takes
+             time proportional to the number of chunks and does not copy samples. A snapshot is never changed by later
+             appends, so plots may display it while acquisition continues, and may compare generations to learn which
+             samples at the end of a new snapshot were not in the last one they displayed.
+
+             Storage is allocated in chunks of ChunkIterator::s_chunk_size samples. In windowed mode, chunks which
+             have left the window and are no longer held by any snapshot are reused, so that a column whose snapshots
+             are released regularly does not allocate memory once its window is full. A column may be appended to by
+             one thread at a time, while snapshots are read by others.
+  */
+  class RingColumn {
+    public:
+      typedef unsigned long size_type;
+
+      /** \brief Create an empty column.
+          \param capacity The number of most recent samples to keep, or 0 to keep all of them.
+      */
+      explicit RingColumn(size_type capacity = 0): m_chunk(), m_spare(), m_capacity(capacity), m_offset(0), m_size(0),
+        m_generation(0) {}
+
+      /** \brief Append a sample to the end of the column. In windowed mode, the oldest sample is discarded if the
+                 window is full.
+          \param sample The sample.
+      */
+      void append(double sample) {
+        size_type end = m_offset + m_size;
+        if (m_chunk.size() * s_chunk_size == end) addChunk();
+        (*m_chunk.back())[end % s_chunk_size] = sample;
+        ++m_size;
+        ++m_generation;
+        if (0 != m_capacity && m_capacity < m_size) dropFront();
+      }
+
+      /** \brief Append a range of samples to the end of the column.
+          \param begin The first iterator in the range.
+          \param end One past the last iterator in the range.
+      */
+      template <typename Itor_t>
+      void append(Itor_t begin, Itor_t end) { for (; begin != end; ++begin) append(*begin); }
+
+      /// \brief Discard all samples. The generation counter keeps counting from its current value.
+      void clear() {
+        m_chunk.clear();
+        m_offset = 0;
+        m_size = 0;
+      }
+
+      /// \brief Return the number of samples in the column.
+      size_type size() const { return m_size; }
+
+      /// \brief Return the number of most recent samples kept by the column, or 0 if it keeps all of them.
+      size_type getCapacity() const { return m_capacity; }
+
+      /// \brief Return the number of samples ever appended to the column.
+      unsigned long getGeneration() const { return m_generation; }
+
+      /// \brief Return a snapshot of the samples now in the column.
+      RingSnapshot getSnapshot() const {
+        std::shared_ptr<RingSnapshot::Table> table(new RingSnapshot::Table);
+        table->m_chunk.assign(m_chunk.begin(), m_chunk.end());
+        table->m_pointer.reserve(m_chunk.size());
+        for (ChunkList::const_iterator itor = m_chunk.begin(); itor != m_chunk.end(); ++itor)
+          table->m_pointer.push_back(&(**itor)[0]);
+        return RingSnapshot(table, m_offset, m_size, m_generation);
+      }
+
+    private:
+      typedef std::deque<std::shared_ptr<std::vector<double> > > ChunkList;
+
+      static const size_type s_chunk_size = ChunkIterator::s_chunk_size;
+
+      void addChunk() {
+        if (m_spare) {
+          m_chunk.push_back(m_spare);
+          m_spare.reset();
+        } else {
+          m_chunk.push_back(std::make_shared<std::vector<double> >(size_type(s_chunk_size)));
+        }
+      }
+
+      void dropFront() {
+        ++m_offset;
+        --m_size;
+        if (s_chunk_size == m_offset) {
+          // Keep the chunk for reuse if no snapshot still refers to it.
+          if (1 == m_chunk.front().use_count()) m_spare = m_chunk.front();
+          m_chunk.pop_front();
+          m_offset = 0;
+        }
+      }
+
+      ChunkList m_chunk;
+      std::shared_ptr<std::vector<double> > m_spare;
+      size_type m_capacity;
+      size_type m_offset;
+      size_type m_size;
+      unsigned long m_generation;
+  };
+
+  /** \class RingSequence
+      \brief A sequence whose elements are read from a snapshot of a RingColumn, which the sequence keeps alive for its
+             lifetime. Seq_t is one of the sequence templates taking a single range of iterators (PointSequence,
+             ValueSequence or LowerBoundSequence), which determines how elements are interpreted. Clones share the
+             snapshot.
+  */
+  template <template <typename> class Seq_t>
+  class RingSequence : public Seq_t<ChunkIterator> {
+    public:
+      typedef typename Seq_t<ChunkIterator>::size_type size_type;
+
+      /** \brief Create a sequence spanning a snapshot of a column.
+          \param snapshot The snapshot.
+      */
+      RingSequence(const RingSnapshot & snapshot): Seq_t<ChunkIterator>(snapshot.begin(), snapshot.end()),
+        m_snapshot(snapshot) {}
+
+      /// \brief Return the snapshot read by this sequence.
+      const RingSnapshot & getSnapshot() const { return m_snapshot; }
+
+      /// \brief Return the generation of the snapshot read by this sequence.
+      unsigned long getGeneration() const { return m_snapshot.getGeneration(); }
+
+      /** \brief Return the number of elements at the end of the sequence which were appended after the given
+                 generation, as described for RingSnapshot::getNumAppendedSince.
+          \param generation The earlier generation.
+      */
+      size_type getNumAppendedSince(unsigned long generation) const { return m_snapshot.getNumAppendedSince(generation); }
+
+      /** \brief Return a new copy of the current ISequence subclass.
+      */
+      virtual ISequence * clone() const { return new RingSequence(*this); }
+
+    private:
+      RingSnapshot m_snapshot;
+  };
+
+  typedef RingSequence<PointSequence> RingPointSequence;
+  typedef RingSequence<ValueSequence> RingValueSequence;
+  typedef RingSequence<LowerBoundSequence> RingLowerBoundSequence;
+
+}
+
+#endif
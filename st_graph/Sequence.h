@@ -5,11 +5,611 @@
 #ifndef st_graph_Sequence_h
 #define st_graph_Sequence_h
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
+#include "st_graph/SimdKernel.h"
+#include "st_graph/ThreadPool.h"
+
 namespace st_graph {
 
+  /** \class DataView
+      \brief Read-only description of a sequence property which already resides in memory as a series of doubles
+             separated by a constant number of bytes. Backends may read such a property in place instead of copying it.
+  */
+  class DataView {
+    public:
+      /// \brief Construct an empty view, which does not refer to any memory.
+      DataView(): m_data(0), m_stride(0) {}
+
+      /** \brief Construct a view of doubles starting at the given address.
+          \param data Address of the first double in the view.
+          \param stride Distance in bytes between successive doubles in the view.
+      */
+      DataView(const double * data, std::ptrdiff_t stride = sizeof(double)): m_data(data), m_stride(stride) {}
+
+      /** \brief Return the double at the given position in the view.
+          \param index The position in the view.
+      */
+      const double & operator [](std::ptrdiff_t index) const {
+        return *reinterpret_cast<const double *>(reinterpret_cast<const char *>(m_data) + index * m_stride);
+      }
+
+      /// \brief Return the address of the first double in the view.
+      const double * data() const { return m_data; }
+
+      /// \brief Return the distance in bytes between successive doubles in the view.
+      std::ptrdiff_t stride() const { return m_stride; }
+
+      /// \brief Return true if the doubles are adjacent in memory, i.e. if the view may be used as an ordinary C array.
+      bool isContiguous() const { return 0 != m_data && std::ptrdiff_t(sizeof(double)) == m_stride; }
+
+    private:
+      const double * m_data;
+      std::ptrdiff_t m_stride;
+  };
+
+  /** \class SequenceColumns
+      \brief Structure-of-arrays block holding any selection of the properties of a sequence: values, lower/upper
+             bounds and lower/upper spreads, one column per property. A column's data may either be held in the block's
+             own storage, or refer in place to memory owned by the sequence. The storage is retained between uses, so
+             a block which is reused for sequences of the same size does not allocate memory again.
+  */
+  class SequenceColumns {
+    public:
+      /// \brief Bits identifying the columns, which may be combined into masks.
+      enum Column_e {
+        eValue = 1, eLowerBound = 2, eUpperBound = 4, eLowerSpread = 8, eUpperSpread = 16,
+        eIntervals = eLowerBound | eUpperBound, eSpreads = eLowerSpread | eUpperSpread,
+        eAll = eValue | eIntervals | eSpreads
+      };
+
+      SequenceColumns() { for (int ii = 0; ii != s_num_columns; ++ii) m_view[ii] = 0; }
+
+      /** \brief Return the address of the data in the given column, or 0 if the column is empty or has not been filled.
+          \param column The column, which must be a single bit.
+      */
+      const double * data(Column_e column) const {
+        int idx = index(column);
+        if (0 != m_view[idx]) return m_view[idx];
+        return m_storage[idx].empty() ? 0 : &m_storage[idx][0];
+      }
+
+      /** \brief Direct the given column to the block's own storage, and return that storage so that it may be filled.
+          \param column The column, which must be a single bit.
+      */
+      std::vector<double> & getStorage(Column_e column) {
+        int idx = index(column);
+        m_view[idx] = 0;
+        return m_storage[idx];
+      }
+
+      /** \brief Direct the given column to the block's own storage, size it, and return its address so that it may
+                 be filled.
+          \param column The column, which must be a single bit.
+          \param size The number of elements in the column.
+      */
+      double * resize(Column_e column, unsigned long size) {
+        std::vector<double> & storage(getStorage(column));
+        storage.resize(size);
+        return storage.empty() ? 0 : &storage[0];
+      }
+
+      /** \brief Direct the given column to data held in memory outside the block.
+          \param column The column, which must be a single bit.
+          \param data The address of the data.
+      */
+      void setView(Column_e column, const double * data) { m_view[index(column)] = data; }
+
+    private:
+      static const int s_num_columns = 5;
+
+      static int index(Column_e column) {
+        int idx = 0;
+        for (unsigned int bit = column; 1u < bit; bit >>= 1) ++idx;
+        return idx;
+      }
+
+      std::vector<double> m_storage[s_num_columns];
+      const double * m_view[s_num_columns];
+  };
+
+  /** \brief Fill a view of the memory occupied by a range of iterators, if that memory is known to hold doubles
+             with a constant stride. Returns false for empty ranges and for iterators whose memory layout is unknown.
+      \param begin The first iterator in the range.
+      \param count The number of elements in the range.
+      \param view The output view.
+  */
+  template <typename Itor_t>
+  inline bool makeDataView(const Itor_t &, unsigned long, DataView &) { return false; }
+
+  inline bool makeDataView(const double * const & begin, unsigned long count, DataView & view) {
+    if (0 == count) return false;
+    view = DataView(begin);
+    return true;
+  }
+
+  inline bool makeDataView(double * const & begin, unsigned long count, DataView & view) {
+    return makeDataView(static_cast<const double *>(begin), count, view);
+  }
+
+  inline bool makeDataView(const std::vector<double>::const_iterator & begin, unsigned long count, DataView & view) {
+    if (0 == count) return false;
+    view = DataView(&*begin);
+    return true;
+  }
+
+  inline bool makeDataView(const std::vector<double>::iterator & begin, unsigned long count, DataView & view) {
+    return makeDataView(std::vector<double>::const_iterator(begin), count, view);
+  }
+
+  /** \class IsRandomAccess
+      \brief Trait whose value is true for iterators which may be advanced in constant time, so that sequences reading
+             them may be split into chunks and extracted in parallel.
+  */
+  template <typename Itor_t>
+  struct IsRandomAccess : public std::is_base_of<std::random_access_iterator_tag,
+    typename std::iterator_traits<Itor_t>::iterator_category> {};
+
+  /** \class SequenceStatistics
+      \brief Summary of the properties of a sequence which clients need to scale axes and choose algorithms: ranges
+             of the values and bounds, the number of finite elements and whether the elements are sorted. Only
+             elements whose value and bounds are all finite contribute to the ranges and orderings. A range to which no
+             element contributes is empty, i.e. its minimum is +infinity and its maximum is -infinity.
+  */
+  class SequenceStatistics {
+    public:
+      /// \brief Construct the statistics of an empty sequence.
+      SequenceStatistics(): m_num_elements(0), m_num_finite(0), m_min_value(infinity()), m_max_value(-infinity()),
+        m_min_positive_value(infinity()), m_min_lower(infinity()), m_max_upper(-infinity()),
+        m_min_positive_lower(infinity()), m_last_value(0.), m_last_upper(0.), m_non_decreasing(true),
+        m_non_increasing(true), m_ordered_bins(true) {}
+
+      /** \brief Add a block of elements, which follows those previously added, to the statistics.
+          \param value The values of the elements.
+          \param lower The lower bounds of the elements.
+          \param upper The upper bounds of the elements.
+          \param count The number of elements in the block.
+      */
+      void accumulate(const double * value, const double * lower, const double * upper, unsigned long count);
+
+      /// \brief Return the number of elements in the sequence.
+      unsigned long getNumElements() const { return m_num_elements; }
+
+      /// \brief Return the number of elements whose value, lower and upper bound are all finite.
+      unsigned long getNumFinite() const { return m_num_finite; }
+
+      /// \brief Return the smallest value.
+      double getMinValue() const { return m_min_value; }
+
+      /// \brief Return the largest value.
+      double getMaxValue() const { return m_max_value; }
+
+      /// \brief Return the smallest value greater than 0, i.e. the lower limit of a logarithmic axis showing the values.
+      double getMinPositiveValue() const { return m_min_positive_value; }
+
+      /// \brief Return the smallest lower bound.
+      double getMinLower() const { return m_min_lower; }
+
+      /// \brief Return the largest upper bound.
+      double getMaxUpper() const { return m_max_upper; }
+
+      /** \brief Return the smallest lower bound greater than 0, i.e. the lower limit of a logarithmic axis showing the
+                 intervals.
+      */
+      double getMinPositiveLower() const { return m_min_positive_lower; }
+
+      /// \brief Return true if each value is greater than or equal to the one before it.
+      bool isNonDecreasing() const { return m_non_decreasing; }
+
+      /// \brief Return true if each value is less than or equal to the one before it.
+      bool isNonIncreasing() const { return m_non_increasing; }
+
+      /** \brief Return true if the elements form bins in increasing order which do not overlap, i.e. if each lower
+                 bound is no greater than the corresponding upper bound, and no less than the preceding upper bound.
+                 Such bins may be searched by bisection.
+      */
+      bool hasOrderedBins() const { return m_ordered_bins; }
+
+    private:
+      /// \brief The number of elements summarized at once, small enough that a block stays in the L1 cache.
+      static const unsigned long s_block_size = 256;
+
+      static double infinity() { return std::numeric_limits<double>::infinity(); }
+
+      /** \brief Add a block of elements one at a time, skipping those which are not finite.
+          \param value The values of the elements.
+          \param lower The lower bounds of the elements.
+          \param upper The upper bounds of the elements.
+          \param count The number of elements in the block.
+      */
+      void accumulateElements(const double * value, const double * lower, const double * upper, unsigned long count);
+
+      unsigned long m_num_elements;
+      unsigned long m_num_finite;
+      double m_min_value;
+      double m_max_value;
+      double m_min_positive_value;
+      double m_min_lower;
+      double m_max_upper;
+      double m_min_positive_lower;
+      double m_last_value;
+      double m_last_upper;
+      bool m_non_decreasing;
+      bool m_non_increasing;
+      bool m_ordered_bins;
+  };
+
+  inline void SequenceStatistics::accumulate(const double * value, const double * lower, const double * upper,
+    unsigned long count) {
+    // Blocks whose elements are all finite, which is usual, are summarized by the vectorized kernel. Only blocks
+    // containing infinities or NaN are examined one element at a time.
+    SimdKernel::Summary summary;
+    for (unsigned long offset = 0; offset < count; offset += s_block_size) {
+      unsigned long size = count - offset < s_block_size ? count - offset : s_block_size;
+      if (!SimdKernel::summarizeFinite(value + offset, lower + offset, upper + offset, size, summary)) {
+        accumulateElements(value + offset, lower + offset, upper + offset, size);
+        continue;
+      }
+
+      // Orderings are relative to the preceding finite element, if any.
+      if (0 != m_num_finite) {
+        if (value[offset] < m_last_value) m_non_decreasing = false;
+        if (value[offset] > m_last_value) m_non_increasing = false;
+        if (lower[offset] < m_last_upper) m_ordered_bins = false;
+      }
+      m_non_decreasing = m_non_decreasing && summary.m_non_decreasing;
+      m_non_increasing = m_non_increasing && summary.m_non_increasing;
+      m_ordered_bins = m_ordered_bins && summary.m_ordered_bins;
+      m_last_value = value[offset + size - 1];
+      m_last_upper = upper[offset + size - 1];
+      m_num_finite += size;
+
+      if (summary.m_min_value < m_min_value) m_min_value = summary.m_min_value;
+      if (summary.m_max_value > m_max_value) m_max_value = summary.m_max_value;
+      if (summary.m_min_positive_value < m_min_positive_value) m_min_positive_value = summary.m_min_positive_value;
+      if (summary.m_min_lower < m_min_lower) m_min_lower = summary.m_min_lower;
+      if (summary.m_max_upper > m_max_upper) m_max_upper = summary.m_max_upper;
+      if (summary.m_min_positive_lower < m_min_positive_lower) m_min_positive_lower = summary.m_min_positive_lower;
+    }
+    m_num_elements += count;
+  }
+
+  inline void SequenceStatistics::accumulateElements(const double * value, const double * lower, const double * upper,
+    unsigned long count) {
+    for (unsigned long ii = 0; ii != count; ++ii) {
+      double val = value[ii];
+      double low = lower[ii];
+      double high = upper[ii];
+      if (!std::isfinite(val) || !std::isfinite(low) || !std::isfinite(high)) continue;
+
+      // Orderings are relative to the preceding finite element, if any.
+      if (0 != m_num_finite) {
+        if (val < m_last_value) m_non_decreasing = false;
+        if (val > m_last_value) m_non_increasing = false;
+        if (low < m_last_upper) m_ordered_bins = false;
+      }
+      if (high < low) m_ordered_bins = false;
+      m_last_value = val;
+      m_last_upper = high;
+      ++m_num_finite;
+
+      if (val < m_min_value) m_min_value = val;
+      if (val > m_max_value) m_max_value = val;
+      if (0. < val && val < m_min_positive_value) m_min_positive_value = val;
+      if (low < m_min_lower) m_min_lower = low;
+      if (high > m_max_upper) m_max_upper = high;
+      if (0. < low && low < m_min_positive_lower) m_min_positive_lower = low;
+    }
+  }
+
+  /** \class BinIndex
+      \brief Sorted copy of the bounds of a sequence whose elements are bins, with which the bin containing a coordinate
+             is found by bisection in O(log n) time. Bins are half-open, i.e. bin ii contains lower[ii] <= x < upper[ii],
+             so zero-width bins contain nothing. Coordinates between bins, or outside all of them, lie in gaps. When
+             each bin starts where the one before it ends, as for a LowerBoundSequence, only the n + 1 edges are stored.
+  */
+  class BinIndex {
+    public:
+      typedef unsigned long size_type;
+
+      /** \brief Create an index of the given bins, which must all be finite, and must be in increasing order without
+                 overlapping, as described for SequenceStatistics::hasOrderedBins.
+          \param lower The lower bounds of the bins.
+          \param upper The upper bounds of the bins.
+          \param count The number of bins.
+      */
+      BinIndex(const double * lower, const double * upper, size_type count);
+
+      /** \brief Find the bin which contains the given coordinate. Returns true if there is one, and false if the
+                 coordinate lies in a gap or is NaN.
+          \param x The coordinate.
+          \param index The output index of the bin containing x. If x lies in a gap, the number of bins below x, i.e.
+                 the index of the first bin above the gap.
+      */
+      bool findBin(double x, size_type & index) const;
+
+      /** \brief Find the bins which overlap the half-open range [x0, x1). The range of bins is empty if no bin
+                 overlaps the range, in which case begin == end is the index of the first bin above it.
+          \param x0 The lower limit of the range.
+          \param x1 The upper limit of the range.
+          \param begin The output index of the first bin overlapping the range.
+          \param end The output index one past the last bin overlapping the range.
+      */
+      void findRange(double x0, double x1, size_type & begin, size_type & end) const;
+
+    private:
+      // Only called for non-empty indices.
+      const double * lower() const { return &m_lower[0]; }
+      const double * upper() const { return m_upper.empty() ? &m_lower[1] : &m_upper[0]; }
+
+      // Lower bounds, followed by the upper bound of the last bin if the bins are adjacent, in which case m_upper is empty.
+      std::vector<double> m_lower;
+      std::vector<double> m_upper;
+      size_type m_num_bins;
+  };
+
+  inline BinIndex::BinIndex(const double * lower, const double * upper, size_type count): m_lower(), m_upper(),
+    m_num_bins(count) {
+    bool adjacent = true;
+    for (size_type ii = 0; ii != count; ++ii) {
+      if (!std::isfinite(lower[ii]) || !std::isfinite(upper[ii]) || upper[ii] < lower[ii] ||
+        (0 != ii && lower[ii] < upper[ii - 1]))
+        throw std::logic_error("BinIndex: bins must be finite, and in increasing order without overlapping");
+      if (0 != ii && lower[ii] != upper[ii - 1]) adjacent = false;
+    }
+    if (0 == count) return;
+    m_lower.assign(lower, lower + count);
+    if (adjacent) m_lower.push_back(upper[count - 1]);
+    else m_upper.assign(upper, upper + count);
+  }
+
+  inline bool BinIndex::findBin(double x, size_type & index) const {
+    // Upper bounds are sorted, so the first bin ending above x is the only one which may contain it.
+    index = 0;
+    if (0 == m_num_bins || x != x) return false;
+    const double * high = upper();
+    index = std::upper_bound(high, high + m_num_bins, x) - high;
+    return m_num_bins != index && lower()[index] <= x;
+  }
+
+  inline void BinIndex::findRange(double x0, double x1, size_type & begin, size_type & end) const {
+    begin = 0;
+    end = 0;
+    if (0 == m_num_bins) return;
+    const double * low = lower();
+    const double * high = upper();
+    begin = std::upper_bound(high, high + m_num_bins, x0) - high;
+    end = std::lower_bound(low, low + m_num_bins, x1) - low;
+    if (end < begin) end = begin;
+  }
+
+  /** \class GapMask
+      \brief Bit mask recording where a sequence of intervals has gaps, i.e. where the upper bound of an element is
+             less than the lower bound of the next element, computed once with a vectorized compare. The gaps split
+             the sequence into segments of adjacent or overlapping intervals, e.g. the good time intervals of a light
+             curve, which step curves draw separately, with a break at each gap.
+  */
+  class GapMask {
+    public:
+      typedef unsigned long size_type;
+
+      /** \brief Find the gaps between the given intervals.
+          \param lower The lower bounds of the intervals.
+          \param upper The upper bounds of the intervals.
+          \param count The number of intervals.
+      */
+      GapMask(const double * lower, const double * upper, size_type count): m_word((count + 63) / 64), m_size(count),
+        m_num_gaps(0 != count ? SimdKernel::findGaps(lower, upper, count, &m_word[0]) : 0) {}
+
+      /// \brief Return the number of intervals.
+      size_type size() const { return m_size; }
+
+      /// \brief Return the number of gaps.
+      size_type getNumGaps() const { return m_num_gaps; }
+
+      /// \brief Return the number of segments into which the gaps split the intervals.
+      size_type getNumSegments() const { return 0 != m_size ? m_num_gaps + 1 : 0; }
+
+      /** \brief Return true if there is a gap between the given interval and the next one.
+          \param index The index of the interval.
+      */
+      bool isGapAfter(size_type index) const { return 0 != ((m_word[index / 64] >> (index % 64)) & 1); }
+
+      /** \brief Return the index one past the last interval of the segment which starts at the given interval, i.e.
+                 the index of the first interval after the next gap, or size() if there is no further gap. Segments
+                 are visited by calling this repeatedly, starting from 0, until size() is returned.
+          \param begin The index of the first interval of the segment.
+      */
+      size_type findSegmentEnd(size_type begin) const;
+
+    private:
+      static int countTrailingZeros(unsigned long long word) {
+#ifdef __GNUC__
+        return __builtin_ctzll(word);
+#else
+        int count = 0;
+        for (; 0 == (word & 1); word >>= 1) ++count;
+        return count;
+#endif
+      }
+
+      std::vector<unsigned long long> m_word;
+      size_type m_size;
+      size_type m_num_gaps;
+  };
+
+  inline GapMask::size_type GapMask::findSegmentEnd(size_type begin) const {
+    if (begin >= m_size) return m_size;
+    size_type index = begin / 64;
+    unsigned long long word = m_word[index] >> (begin % 64) << (begin % 64);
+    while (0 == word) {
+      if (m_word.size() == ++index) return m_size;
+      word = m_word[index];
+    }
+    return index * 64 + countTrailingZeros(word) + 1;
+  }
+
+  /** \class ValidityMask
+      \brief Bit mask recording which elements of a sequence can be plotted, i.e. those whose value and spreads,
+             and thus bounds, are all finite, and, for logarithmic axes, whose value is also greater than 0. It is
+             computed with a vectorized pass over each property, so that plots may drop the other elements in bulk
+             rather than checking each point, and no NaN or infinity ever reaches a backend.
+  */
+  class ValidityMask {
+    public:
+      typedef unsigned long size_type;
+
+      /** \brief Create a mask in which every element is valid.
+          \param count The number of elements.
+      */
+      explicit ValidityMask(size_type count): m_word((count + 63) / 64, 0), m_size(count), m_num_invalid(0) {}
+
+      /** \brief Mark as invalid the elements of the given property which are not finite, or, optionally, not greater
+                 than 0.
+          \param data The property, with one entry per element.
+          \param positive Whether entries which are not greater than 0 are also invalid.
+      */
+      void markInvalid(const double * data, bool positive = false) { markInvalid(0, m_size, data, positive); }
+
+      /** \brief Mark as invalid the elements of a range of the given property which are not finite, or, optionally,
+                 not greater than 0, so that a mask may be built from a sequence extracted in blocks.
+          \param offset The index of the first element in the range, which must be a multiple of 64.
+          \param count The number of elements in the range.
+          \param data The property, with one entry per element of the range.
+          \param positive Whether entries which are not greater than 0 are also invalid.
+      */
+      void markInvalid(size_type offset, size_type count, const double * data, bool positive = false) {
+        if (0 != offset % 64 || m_size < offset || m_size - offset < count)
+          throw std::logic_error("ValidityMask::markInvalid: range is not aligned or lies outside the mask");
+        if (0 == count) return;
+        unsigned long long * word = &m_word[offset / 64];
+        size_type num_words = (count + 63) / 64;
+        for (size_type index = 0; index != num_words; ++index) m_num_invalid -= countBits(word[index]);
+        SimdKernel::findInvalid(data, count, positive, word);
+        for (size_type index = 0; index != num_words; ++index) m_num_invalid += countBits(word[index]);
+      }
+
+      /// \brief Return the number of elements.
+      size_type size() const { return m_size; }
+
+      /// \brief Return the number of invalid elements.
+      size_type getNumInvalid() const { return m_num_invalid; }
+
+      /// \brief Return the number of valid elements.
+      size_type getNumValid() const { return m_size - m_num_invalid; }
+
+      /** \brief Return true if the given element is valid.
+          \param index The index of the element.
+      */
+      bool isValid(size_type index) const { return 0 == ((m_word[index / 64] >> (index % 64)) & 1); }
+
+      /** \brief Return the number of elements valid both in this mask and in another of the same size, e.g. the masks
+                 of the x and y sequences of a plot.
+          \param other The other mask.
+      */
+      size_type getNumValid(const ValidityMask & other) const;
+
+      /** \brief Copy the valid elements of a property to the start of an output array, in order, and return their
+                 number. Elements invalid in another mask may also be dropped. The output may be the input itself.
+          \param in The property, with one entry per element.
+          \param out The output array, with room for the valid elements.
+          \param other Another mask of the same size, or 0.
+      */
+      size_type compress(const double * in, double * out, const ValidityMask * other = 0) const;
+
+    private:
+      static int countBits(unsigned long long word) {
+#ifdef __GNUC__
+        return __builtin_popcountll(word);
+#else
+        int count = 0;
+        for (; 0 != word; word &= word - 1) ++count;
+        return count;
+#endif
+      }
+
+      std::vector<unsigned long long> m_word;
+      size_type m_size;
+      size_type m_num_invalid;
+  };
+
+  inline ValidityMask::size_type ValidityMask::getNumValid(const ValidityMask & other) const {
+    if (other.m_size != m_size) throw std::logic_error("ValidityMask::getNumValid: masks have different sizes");
+    size_type num_invalid = 0;
+    for (size_type index = 0; index != m_word.size(); ++index) num_invalid += countBits(m_word[index] | other.m_word[index]);
+    return m_size - num_invalid;
+  }
+
+  inline ValidityMask::size_type ValidityMask::compress(const double * in, double * out,
+    const ValidityMask * other) const {
+    if (0 != other && other->m_size != m_size)
+      throw std::logic_error("ValidityMask::compress: masks have different sizes");
+    size_type num_valid = 0;
+    for (size_type index = 0; index != m_word.size(); ++index) {
+      unsigned long long word = m_word[index] | (0 != other ? other->m_word[index] : 0);
+      size_type base = index * 64;
+      size_type count = m_size - base < 64 ? m_size - base : 64;
+      if (0 == word) {
+        // Runs of valid elements are copied whole. The output never lies ahead of the input, so this is safe in place.
+        if (out + num_valid != in + base) std::copy(in + base, in + base + count, out + num_valid);
+        num_valid += count;
+      } else {
+        for (size_type ii = 0; ii != count; ++ii) {
+          if (0 == ((word >> ii) & 1)) out[num_valid++] = in[base + ii];
+        }
+      }
+    }
+    return num_valid;
+  }
+
+  /** \struct SequenceValueConverter
+      \brief Conversion of sequence properties from double to the type T in which a client stores them. Floating point
+             types are converted directly, except that finite values beyond the range of float are clamped to its
+             limits. Integer types are rounded to the nearest integer, halfway cases away from zero; values outside
+             the range of T are clamped to its limits, and NaN is converted to 0, so that no conversion is undefined or
+             raises a floating point exception.
+  */
+  template <typename T, bool IsInteger = std::numeric_limits<T>::is_integer>
+  struct SequenceValueConverter {
+    static T convert(double value) { return static_cast<T>(value); }
+  };
+
+  template <>
+  struct SequenceValueConverter<float, false> {
+    static float convert(double value) {
+      // Infinities and NaN are kept; finite values too large for float would otherwise overflow.
+      const double max = std::numeric_limits<float>::max();
+      if (value > max && value <= std::numeric_limits<double>::max()) return std::numeric_limits<float>::max();
+      if (value < -max && value >= -std::numeric_limits<double>::max()) return -std::numeric_limits<float>::max();
+      return static_cast<float>(value);
+    }
+
+    /** \brief Return true if the value converts to a float without loss, e.g. any integer count up to 2^24, so that
+               clients may store data in single precision only when that loses nothing.
+        \param value The value.
+    */
+    static bool isExact(double value) { return value != value || double(convert(value)) == value; }
+  };
+
+  template <typename T>
+  struct SequenceValueConverter<T, true> {
+    static T convert(double value) {
+      if (value != value) return 0;
+      if (value <= double(std::numeric_limits<T>::min())) return std::numeric_limits<T>::min();
+      if (value >= double(std::numeric_limits<T>::max())) return std::numeric_limits<T>::max();
+      return static_cast<T>(std::round(value));
+    }
+  };
+
   /** \class ISequence
       \brief Abstract interface representing the idea of a sequence of values with spreads (error bars, bin widths etc.),
              with methods which access the sequence properties, i.e. values, lower/upper bounds, etc. The specific
@@ -21,7 +621,8 @@ namespace st_graph {
       /** \brief Construct an ISequence with the given number of points.
           \param num_points The number of points in the sequence.
       */
-      ISequence(size_type num_points): m_num_points(num_points) {}
+      ISequence(size_type num_points): m_num_points(num_points), m_statistics(), m_bin_index(), m_gap_mask(),
+        m_validity_mask(), m_positive_validity_mask() {}
 
       virtual ~ISequence() {}
 
@@ -42,6 +643,304 @@ namespace st_graph {
       */
       virtual void getSpreads(std::vector<double> & lower, std::vector<double> & upper) const = 0;
 
+      /** \brief Describe where the values of the sequence reside in memory, if they are stored directly as doubles.
+                 Returns false if the values must be computed, in which case getValues must be used.
+          \param val The output view of the values.
+      */
+      virtual bool getValueView(DataView & /* val */) const { return false; }
+
+      /** \brief Describe where the lower and upper bounds of the sequence reside in memory, if they are stored
+                 directly as doubles. Returns false if the bounds must be computed, in which case getIntervals must be used.
+          \param lower The output view of the lower bounds.
+          \param upper The output view of the upper bounds.
+      */
+      virtual bool getIntervalView(DataView & /* lower */, DataView & /* upper */) const { return false; }
+
+      /** \brief Describe where the lower and upper spreads of the sequence reside in memory, if they are stored
+                 directly as doubles. Returns false if the spreads must be computed, in which case getSpreads must be used.
+          \param lower The output view of the lower spreads.
+          \param upper The output view of the upper spreads.
+      */
+      virtual bool getSpreadView(DataView & /* lower */, DataView & /* upper */) const { return false; }
+
+      /** \brief Return the address of a contiguous array holding the values of the sequence. The sequence's own
+                 memory is used if possible; otherwise the values are extracted into the given buffer.
+          \param buffer Container which holds the values if they are not stored contiguously by the sequence.
+      */
+      const double * getValueData(std::vector<double> & buffer) const {
+        DataView val;
+        if (getValueView(val) && val.isContiguous()) return val.data();
+        getValues(buffer);
+        return buffer.empty() ? 0 : &buffer[0];
+      }
+
+      /** \brief Get the addresses of contiguous arrays holding the lower and upper bounds of the sequence.
+                 The sequence's own memory is used if possible; otherwise the bounds are extracted into the given buffers.
+          \param lower The output address of the lower bounds.
+          \param upper The output address of the upper bounds.
+          \param lower_buffer Container which holds the lower bounds if they are not stored contiguously.
+          \param upper_buffer Container which holds the upper bounds if they are not stored contiguously.
+      */
+      void getIntervalData(const double * & lower, const double * & upper, std::vector<double> & lower_buffer,
+        std::vector<double> & upper_buffer) const {
+        DataView low_view;
+        DataView high_view;
+        if (getIntervalView(low_view, high_view) && low_view.isContiguous() && high_view.isContiguous()) {
+          lower = low_view.data();
+          upper = high_view.data();
+        } else {
+          getIntervals(lower_buffer, upper_buffer);
+          lower = lower_buffer.empty() ? 0 : &lower_buffer[0];
+          upper = upper_buffer.empty() ? 0 : &upper_buffer[0];
+        }
+      }
+
+      /** \brief Get the addresses of contiguous arrays holding the lower and upper spreads of the sequence.
+                 The sequence's own memory is used if possible; otherwise the spreads are extracted into the given buffers.
+          \param lower The output address of the lower spreads.
+          \param upper The output address of the upper spreads.
+          \param lower_buffer Container which holds the lower spreads if they are not stored contiguously.
+          \param upper_buffer Container which holds the upper spreads if they are not stored contiguously.
+      */
+      void getSpreadData(const double * & lower, const double * & upper, std::vector<double> & lower_buffer,
+        std::vector<double> & upper_buffer) const {
+        DataView low_view;
+        DataView high_view;
+        if (getSpreadView(low_view, high_view) && low_view.isContiguous() && high_view.isContiguous()) {
+          lower = low_view.data();
+          upper = high_view.data();
+        } else {
+          getSpreads(lower_buffer, upper_buffer);
+          lower = lower_buffer.empty() ? 0 : &lower_buffer[0];
+          upper = upper_buffer.empty() ? 0 : &upper_buffer[0];
+        }
+      }
+
+      /** \brief Fill the requested columns of a structure-of-arrays block with the corresponding properties of the
+                 sequence. Subclasses compute all requested columns in a single pass over their input. The contents
+                 of columns which are not requested are unspecified.
+          \param mask Bitwise combination of SequenceColumns::Column_e values selecting the columns to fill.
+          \param columns The output block.
+      */
+      virtual void getColumns(unsigned int mask, SequenceColumns & columns) const;
+
+      /** \brief Make the requested columns of a structure-of-arrays block refer to the corresponding properties of the
+                 sequence. Properties which the sequence stores contiguously are referred to in place; all the others
+                 are extracted together by a single call to getColumns.
+          \param mask Bitwise combination of SequenceColumns::Column_e values selecting the columns to fill.
+          \param columns The output block.
+      */
+      void getColumnData(unsigned int mask, SequenceColumns & columns) const;
+
+      /** \brief Compute the properties of a range of elements into caller-supplied arrays, each of which must have
+                 room for count elements. Arrays given as 0 are not filled. Only the elements in the range and their
+                 immediate neighbors are read, so long sequences may be processed in blocks of bounded size.
+          \param offset The index of the first element in the range.
+          \param count The number of elements in the range.
+          \param out_val The output values.
+          \param out_low The output lower bounds.
+          \param out_high The output upper bounds.
+          \param out_low_spread The output lower spreads.
+          \param out_high_spread The output upper spreads.
+      */
+      void getRange(size_type offset, size_type count, double * out_val, double * out_low, double * out_high,
+        double * out_low_spread, double * out_high_spread) const;
+
+      /** \brief Compute the values of a range of elements.
+          \param offset The index of the first element in the range.
+          \param count The number of elements in the range.
+          \param val The output values, with room for count elements.
+      */
+      void getValueRange(size_type offset, size_type count, double * val) const { getRange(offset, count, val, 0, 0, 0, 0); }
+
+      /** \brief Compute the lower and upper bounds of a range of elements.
+          \param offset The index of the first element in the range.
+          \param count The number of elements in the range.
+          \param lower The output lower bounds, with room for count elements.
+          \param upper The output upper bounds, with room for count elements.
+      */
+      void getIntervalRange(size_type offset, size_type count, double * lower, double * upper) const {
+        getRange(offset, count, 0, lower, upper, 0, 0);
+      }
+
+      /** \brief Compute the lower and upper spreads of a range of elements.
+          \param offset The index of the first element in the range.
+          \param count The number of elements in the range.
+          \param lower The output lower spreads, with room for count elements.
+          \param upper The output upper spreads, with room for count elements.
+      */
+      void getSpreadRange(size_type offset, size_type count, double * lower, double * upper) const {
+        getRange(offset, count, 0, 0, 0, lower, upper);
+      }
+
+      /** \brief Fill the requested columns of a structure-of-arrays block with the properties of a range of elements.
+                 Reusing one block for successive ranges of the same size does not allocate memory.
+          \param mask Bitwise combination of SequenceColumns::Column_e values selecting the columns to fill.
+          \param offset The index of the first element in the range.
+          \param count The number of elements in the range.
+          \param columns The output block.
+      */
+      void getColumnRange(unsigned int mask, size_type offset, size_type count, SequenceColumns & columns) const;
+
+      /** \brief Return true if getRange computes a range of elements in time proportional to the length of the range,
+                 so that a long sequence may be processed range by range in linear time. The default implementation of
+                 fillRange extracts the whole sequence for every range, so this returns false unless a subclass which
+                 overrides fillRange says otherwise. Clients which process sequences in blocks extract those which
+                 return false whole, once, instead.
+      */
+      virtual bool hasEfficientRanges() const { return false; }
+
+      /** \brief Return true if the data read by the sequence cannot change for its lifetime, e.g. because the sequence
+                 owns them, so that its cached statistics and masks never become stale. Plots keep the cached results
+                 of such sequences from one display to the next, and discard those of other sequences, which may read
+                 data their client modifies in place, before each display. The default implementation returns false.
+      */
+      virtual bool hasFixedData() const { return false; }
+
+      /** \brief Fill the output container with the values of the sequence, converted to type T, e.g. float for
+                 single-precision arrays or int for integer histograms. See SequenceValueConverter for how values are
+                 converted. The values are converted directly from the sequence's own memory if possible, and otherwise
+                 from small blocks, so no array of doubles the size of the sequence is created.
+          \param val The output container.
+      */
+      template <typename T>
+      void getValuesAs(std::vector<T> & val) const {
+        val.resize(size());
+        DataView view;
+        if (getValueView(view)) convertView(view, val);
+        else convertRange<T>(SequenceColumns::eValue, val.empty() ? 0 : &val[0], 0);
+      }
+
+      /** \brief Fill the output containers with the upper and lower bounds of each element in the sequence, converted
+                 to type T as described for getValuesAs.
+          \param lower The lower bounds of the sequence elements.
+          \param upper The upper bounds of the sequence elements.
+      */
+      template <typename T>
+      void getIntervalsAs(std::vector<T> & lower, std::vector<T> & upper) const {
+        lower.resize(size());
+        upper.resize(size());
+        DataView low_view;
+        DataView high_view;
+        if (getIntervalView(low_view, high_view)) {
+          convertView(low_view, lower);
+          convertView(high_view, upper);
+        } else {
+          convertRange<T>(SequenceColumns::eIntervals, lower.empty() ? 0 : &lower[0], upper.empty() ? 0 : &upper[0]);
+        }
+      }
+
+      /** \brief Fill the output containers with the upper and lower spreads of each element in the sequence, converted
+                 to type T as described for getValuesAs.
+          \param lower The lower spreads of the sequence elements.
+          \param upper The upper spreads of the sequence elements.
+      */
+      template <typename T>
+      void getSpreadsAs(std::vector<T> & lower, std::vector<T> & upper) const {
+        lower.resize(size());
+        upper.resize(size());
+        DataView low_view;
+        DataView high_view;
+        if (getSpreadView(low_view, high_view)) {
+          convertView(low_view, lower);
+          convertView(high_view, upper);
+        } else {
+          convertRange<T>(SequenceColumns::eSpreads, lower.empty() ? 0 : &lower[0], upper.empty() ? 0 : &upper[0]);
+        }
+      }
+
+      /** \brief Return summary statistics of the sequence: ranges, number of finite elements and orderings. They are
+                 computed in a single pass the first time they are requested, extracting the sequence in small blocks,
+                 and cached, so that later requests and clones of the sequence need not traverse it again. Clients
+                 which modify the data read by a sequence must call clearStatistics afterwards.
+      */
+      SequenceStatistics getStatistics() const {
+        std::shared_ptr<const SequenceStatistics> statistics(std::atomic_load(&m_statistics));
+        if (!statistics) {
+          statistics = std::make_shared<const SequenceStatistics>(computeStatistics());
+          std::atomic_store(&m_statistics, statistics);
+        }
+        return *statistics;
+      }
+
+      /** \brief Discard the cached statistics, bin index, gap mask and validity masks of the sequence, so that they
+                 will be recomputed when next requested. Clones made earlier keep their own; plots hold clones, whose
+                 caches are discarded at each display unless hasFixedData returns true.
+      */
+      void clearStatistics() const {
+        std::atomic_store(&m_statistics, std::shared_ptr<const SequenceStatistics>());
+        std::atomic_store(&m_bin_index, std::shared_ptr<const BinIndex>());
+        std::atomic_store(&m_gap_mask, std::shared_ptr<const GapMask>());
+        std::atomic_store(&m_validity_mask, std::shared_ptr<const ValidityMask>());
+        std::atomic_store(&m_positive_validity_mask, std::shared_ptr<const ValidityMask>());
+      }
+
+      /** \brief Set the number of elements from which sequences able to compute their elements independently, such as
+                 the iterator templates below with random-access iterators, extract whole columns in parallel on the
+                 shared ThreadPool. Smaller sequences are extracted serially. The sequence is split into chunks whose
+                 boundaries depend only on its size, and the results are identical to those of serial extraction.
+          \param threshold The smallest number of elements extracted in parallel.
+      */
+      static void setParallelThreshold(size_type threshold) { parallelThreshold() = threshold; }
+
+      /// \brief Return the number of elements from which sequences are extracted in parallel.
+      static size_type getParallelThreshold() { return parallelThreshold(); }
+
+      /** \brief Describe the sequence as adjacent bins of equal width, if it is known to be one, so that clients may
+                 represent the bins by their number and range alone. Returns false otherwise.
+          \param lower The output lower bound of the first bin.
+          \param upper The output upper bound of the last bin.
+      */
+      virtual bool getUniformBins(double & /* lower */, double & /* upper */) const { return false; }
+
+      /** \brief Describe the sequence as adjacent bins of equal width in the logarithm, if it is known to be one, so
+                 that clients may represent the bins by their number and range alone. Returns false otherwise.
+          \param lower The output lower bound of the first bin.
+          \param upper The output upper bound of the last bin.
+      */
+      virtual bool getLogUniformBins(double & /* lower */, double & /* upper */) const { return false; }
+
+      /** \brief Fill the output container with the edges of the sequence interpreted as bins: the lower bound
+                 of each element, followed by the upper bound of the last element. Empty sequences have no edges.
+          \param edges The output container.
+      */
+      virtual void getBinEdges(std::vector<double> & edges) const;
+
+      /** \brief Find the element whose interval contains the given coordinate, e.g. the bin under the mouse pointer.
+                 Returns false if the coordinate lies in a gap between the intervals or outside all of them. The
+                 intervals must be finite and ordered, as described for BinIndex. The default implementation builds a
+                 BinIndex from the intervals the first time it is needed and caches it, so each lookup takes O(log n)
+                 time; sequences whose bins are given by a formula find them in constant time.
+          \param x The coordinate.
+          \param index The output index of the element containing x, or if x lies in a gap, the number of elements
+                 below x.
+      */
+      virtual bool findBin(double x, size_type & index) const { return getBinIndex()->findBin(x, index); }
+
+      /** \brief Find the elements whose intervals overlap the half-open range [x0, x1), as described for findBin.
+          \param x0 The lower limit of the range.
+          \param x1 The upper limit of the range.
+          \param begin The output index of the first element overlapping the range.
+          \param end The output index one past the last element overlapping the range.
+      */
+      virtual void findRange(double x0, double x1, size_type & begin, size_type & end) const {
+        getBinIndex()->findRange(x0, x1, begin, end);
+      }
+
+      /** \brief Return the gaps between the intervals of the sequence. They are found the first time they are
+                 requested and cached, as are the statistics, so that redisplaying a sequence does not search them again.
+      */
+      std::shared_ptr<const GapMask> getGapMask() const;
+
+      /** \brief Return the elements of the sequence which can be plotted, i.e. those whose value and spreads, and
+                 thus bounds, are all finite. The mask is computed the first time it is requested and cached, as are
+                 the statistics. The sequence is extracted in small blocks, as for the statistics, so no array the size
+                 of the sequence is created other than the mask itself.
+          \param positive Whether elements whose value is not greater than 0, which cannot be plotted on logarithmic
+                 axes, are also invalid. Separate masks are cached for each case.
+      */
+      std::shared_ptr<const ValidityMask> getValidityMask(bool positive = false) const;
+
       /** \brief Return the number of elements in the sequence.
       */
       size_type size() const { return m_num_points; }
@@ -50,10 +949,354 @@ namespace st_graph {
       */
       virtual ISequence * clone() const = 0;
 
+    protected:
+      /** \brief Compute the properties of a range of elements, as described for getRange, which has already checked
+                 that the range lies within the sequence and is not empty. The default implementation extracts the
+                 whole sequence with getColumns and copies the range; subclasses override it to read only the range,
+                 and override hasEfficientRanges to report that they do.
+          \param offset The index of the first element in the range.
+          \param count The number of elements in the range.
+          \param out_val The output values.
+          \param out_low The output lower bounds.
+          \param out_high The output upper bounds.
+          \param out_low_spread The output lower spreads.
+          \param out_high_spread The output upper spreads.
+      */
+      virtual void fillRange(size_type offset, size_type count, double * out_val, double * out_low, double * out_high,
+        double * out_low_spread, double * out_high_spread) const;
+
+      /** \brief Compute the properties of elements [begin, end) into arrays which hold the properties of the whole
+                 sequence, i.e. element ii is stored at index ii. This is called by fillInParallel for each chunk of
+                 the sequence, from several threads at once. The default implementation calls fillRange.
+          \param begin The index of the first element in the chunk.
+          \param end One past the index of the last element in the chunk.
+          \param out_val The output values.
+          \param out_low The output lower bounds.
+          \param out_high The output upper bounds.
+          \param out_low_spread The output lower spreads.
+          \param out_high_spread The output upper spreads.
+      */
+      virtual void fillChunk(size_type begin, size_type end, double * out_val, double * out_low, double * out_high,
+        double * out_low_spread, double * out_high_spread) const;
+
+      /** \brief Compute the properties of all elements into caller-supplied arrays, each of which must have room for
+                 size() elements, by filling chunks of the sequence in parallel on the shared ThreadPool. Returns false
+                 without filling anything if the sequence is smaller than the parallel threshold or has only one chunk,
+                 in which case the caller extracts it serially. Only subclasses whose fillChunk may be called from
+                 several threads at once may use this.
+          \param out_val The output values.
+          \param out_low The output lower bounds.
+          \param out_high The output upper bounds.
+          \param out_low_spread The output lower spreads.
+          \param out_high_spread The output upper spreads.
+      */
+      bool fillInParallel(double * out_val, double * out_low, double * out_high, double * out_low_spread,
+        double * out_high_spread) const;
+
+      /** \brief Fill the requested columns of a structure-of-arrays block for the whole sequence using fillInParallel.
+                 Returns false without touching the block if the sequence is smaller than the parallel threshold.
+          \param mask Bitwise combination of SequenceColumns::Column_e values selecting the columns to fill.
+          \param columns The output block.
+      */
+      bool getColumnsInParallel(unsigned int mask, SequenceColumns & columns) const;
+
+      /** \brief Fill the requested columns of a structure-of-arrays block for the whole sequence through fillChunk,
+                 in parallel if the sequence is at least as large as the parallel threshold, and otherwise as a single
+                 chunk. Subclasses whose fillChunk computes whole columns faster than fillRange use this in getColumns.
+          \param mask Bitwise combination of SequenceColumns::Column_e values selecting the columns to fill.
+          \param columns The output block.
+      */
+      void getColumnsByChunks(unsigned int mask, SequenceColumns & columns) const;
+
     private:
+      class ChunkTask;
+
+      // Number of elements extracted at a time by convertRange and computeStatistics.
+      static const size_type s_block_size = 512;
+
+      // Number of elements in each chunk extracted by fillInParallel, and the default parallel threshold.
+      static const size_type s_chunk_size = 65536;
+      static const size_type s_parallel_threshold = 262144;
+
+      static std::atomic<size_type> & parallelThreshold() {
+        static std::atomic<size_type> s_threshold(s_parallel_threshold);
+        return s_threshold;
+      }
+
+      template <typename T>
+      static void convertView(const DataView & view, std::vector<T> & out) {
+        for (size_type ii = 0; ii != out.size(); ++ii) out[ii] = SequenceValueConverter<T>::convert(view[ii]);
+      }
+
+      template <typename T>
+      void convertRange(SequenceColumns::Column_e columns, T * first, T * second) const;
+
+      SequenceStatistics computeStatistics() const;
+
+      std::shared_ptr<const BinIndex> getBinIndex() const;
+
       size_type m_num_points;
+      mutable std::shared_ptr<const SequenceStatistics> m_statistics;
+      mutable std::shared_ptr<const BinIndex> m_bin_index;
+      mutable std::shared_ptr<const GapMask> m_gap_mask;
+      mutable std::shared_ptr<const ValidityMask> m_validity_mask;
+      mutable std::shared_ptr<const ValidityMask> m_positive_validity_mask;
+  };
+
+  inline void ISequence::getColumns(unsigned int mask, SequenceColumns & columns) const {
+    // Generic implementation in terms of the other extraction methods. Subclasses override it to work in one pass.
+    // Both columns of a pair are filled even if only one was requested, so that no temporary storage is needed.
+    if (0 != (mask & SequenceColumns::eValue)) getValues(columns.getStorage(SequenceColumns::eValue));
+    if (0 != (mask & SequenceColumns::eIntervals))
+      getIntervals(columns.getStorage(SequenceColumns::eLowerBound), columns.getStorage(SequenceColumns::eUpperBound));
+    if (0 != (mask & SequenceColumns::eSpreads))
+      getSpreads(columns.getStorage(SequenceColumns::eLowerSpread), columns.getStorage(SequenceColumns::eUpperSpread));
+  }
+
+  inline void ISequence::getRange(size_type offset, size_type count, double * out_val, double * out_low,
+    double * out_high, double * out_low_spread, double * out_high_spread) const {
+    if (offset > size() || count > size() - offset)
+      throw std::out_of_range("ISequence::getRange: range extends past the end of the sequence");
+    if (0 != count) fillRange(offset, count, out_val, out_low, out_high, out_low_spread, out_high_spread);
+  }
+
+  inline void ISequence::getColumnRange(unsigned int mask, size_type offset, size_type count,
+    SequenceColumns & columns) const {
+    double * out_val = 0 != (mask & SequenceColumns::eValue) ? columns.resize(SequenceColumns::eValue, count) : 0;
+    double * out_low = 0 != (mask & SequenceColumns::eLowerBound) ? columns.resize(SequenceColumns::eLowerBound, count) : 0;
+    double * out_high = 0 != (mask & SequenceColumns::eUpperBound) ? columns.resize(SequenceColumns::eUpperBound, count) : 0;
+    double * out_low_spread = 0 != (mask & SequenceColumns::eLowerSpread) ?
+      columns.resize(SequenceColumns::eLowerSpread, count) : 0;
+    double * out_high_spread = 0 != (mask & SequenceColumns::eUpperSpread) ?
+      columns.resize(SequenceColumns::eUpperSpread, count) : 0;
+    getRange(offset, count, out_val, out_low, out_high, out_low_spread, out_high_spread);
+  }
+
+  inline void ISequence::fillRange(size_type offset, size_type count, double * out_val, double * out_low,
+    double * out_high, double * out_low_spread, double * out_high_spread) const {
+    double * out[] = { out_val, out_low, out_high, out_low_spread, out_high_spread };
+    const SequenceColumns::Column_e column[] = { SequenceColumns::eValue, SequenceColumns::eLowerBound,
+      SequenceColumns::eUpperBound, SequenceColumns::eLowerSpread, SequenceColumns::eUpperSpread };
+    unsigned int mask = 0;
+    for (int ii = 0; ii != 5; ++ii) if (0 != out[ii]) mask |= column[ii];
+    SequenceColumns columns;
+    getColumns(mask, columns);
+    for (int ii = 0; ii != 5; ++ii) {
+      if (0 != out[ii]) std::copy(columns.data(column[ii]) + offset, columns.data(column[ii]) + offset + count, out[ii]);
+    }
+  }
+
+  /** \class ISequence::ChunkTask
+      \brief ThreadPool task which fills one chunk of a sequence, numbered from 0, for fillInParallel.
+  */
+  class ISequence::ChunkTask : public ThreadPool::ITask {
+    public:
+      ChunkTask(const ISequence & seq, double * out_val, double * out_low, double * out_high, double * out_low_spread,
+        double * out_high_spread): m_seq(seq), m_out_val(out_val), m_out_low(out_low), m_out_high(out_high),
+        m_out_low_spread(out_low_spread), m_out_high_spread(out_high_spread) {}
+
+      virtual void operator ()(ThreadPool::size_type index) const {
+        size_type begin = index * s_chunk_size;
+        size_type end = m_seq.size() - begin > s_chunk_size ? begin + s_chunk_size : m_seq.size();
+        m_seq.fillChunk(begin, end, m_out_val, m_out_low, m_out_high, m_out_low_spread, m_out_high_spread);
+      }
+
+    private:
+      const ISequence & m_seq;
+      double * m_out_val;
+      double * m_out_low;
+      double * m_out_high;
+      double * m_out_low_spread;
+      double * m_out_high_spread;
   };
 
+  inline void ISequence::fillChunk(size_type begin, size_type end, double * out_val, double * out_low,
+    double * out_high, double * out_low_spread, double * out_high_spread) const {
+    fillRange(begin, end - begin, 0 != out_val ? out_val + begin : 0, 0 != out_low ? out_low + begin : 0,
+      0 != out_high ? out_high + begin : 0, 0 != out_low_spread ? out_low_spread + begin : 0,
+      0 != out_high_spread ? out_high_spread + begin : 0);
+  }
+
+  inline bool ISequence::fillInParallel(double * out_val, double * out_low, double * out_high, double * out_low_spread,
+    double * out_high_spread) const {
+    size_type seq_size = size();
+    if (seq_size < getParallelThreshold() || seq_size <= s_chunk_size) return false;
+    ThreadPool & pool(ThreadPool::instance());
+    if (2 > pool.getNumThreads()) return false;
+    pool.run((seq_size - 1) / s_chunk_size + 1, ChunkTask(*this, out_val, out_low, out_high, out_low_spread,
+      out_high_spread));
+    return true;
+  }
+
+  inline bool ISequence::getColumnsInParallel(unsigned int mask, SequenceColumns & columns) const {
+    size_type seq_size = size();
+    if (seq_size < getParallelThreshold() || seq_size <= s_chunk_size) return false;
+    getColumnsByChunks(mask, columns);
+    return true;
+  }
+
+  inline void ISequence::getColumnsByChunks(unsigned int mask, SequenceColumns & columns) const {
+    size_type seq_size = size();
+    double * out_val = 0 != (mask & SequenceColumns::eValue) ? columns.resize(SequenceColumns::eValue, seq_size) : 0;
+    double * out_low = 0 != (mask & SequenceColumns::eLowerBound) ?
+      columns.resize(SequenceColumns::eLowerBound, seq_size) : 0;
+    double * out_high = 0 != (mask & SequenceColumns::eUpperBound) ?
+      columns.resize(SequenceColumns::eUpperBound, seq_size) : 0;
+    double * out_low_spread = 0 != (mask & SequenceColumns::eLowerSpread) ?
+      columns.resize(SequenceColumns::eLowerSpread, seq_size) : 0;
+    double * out_high_spread = 0 != (mask & SequenceColumns::eUpperSpread) ?
+      columns.resize(SequenceColumns::eUpperSpread, seq_size) : 0;
+    if (0 != seq_size && !fillInParallel(out_val, out_low, out_high, out_low_spread, out_high_spread))
+      fillChunk(0, seq_size, out_val, out_low, out_high, out_low_spread, out_high_spread);
+  }
+
+  template <typename T>
+  inline void ISequence::convertRange(SequenceColumns::Column_e columns, T * first, T * second) const {
+    if (!hasEfficientRanges()) {
+      // Each block would extract the whole sequence, so extract the requested columns once and convert them.
+      SequenceColumns data;
+      getColumnData(columns, data);
+      const double * first_data = data.data(SequenceColumns::eValue == columns ? SequenceColumns::eValue :
+        SequenceColumns::eIntervals == columns ? SequenceColumns::eLowerBound : SequenceColumns::eLowerSpread);
+      const double * second_data = data.data(SequenceColumns::eIntervals == columns ? SequenceColumns::eUpperBound :
+        SequenceColumns::eUpperSpread);
+      for (size_type ii = 0; ii != size(); ++ii) first[ii] = SequenceValueConverter<T>::convert(first_data[ii]);
+      if (0 != second) {
+        for (size_type ii = 0; ii != size(); ++ii) second[ii] = SequenceValueConverter<T>::convert(second_data[ii]);
+      }
+      return;
+    }
+
+    // Extract the requested column or pair of columns a block at a time into buffers on the stack, and convert each block.
+    double first_buf[s_block_size];
+    double second_buf[s_block_size];
+    for (size_type offset = 0; offset != size(); ) {
+      size_type count = size() - offset;
+      if (s_block_size < count) count = s_block_size;
+      if (SequenceColumns::eValue == columns) getRange(offset, count, first_buf, 0, 0, 0, 0);
+      else if (SequenceColumns::eIntervals == columns) getRange(offset, count, 0, first_buf, second_buf, 0, 0);
+      else getRange(offset, count, 0, 0, 0, first_buf, second_buf);
+      for (size_type ii = 0; ii != count; ++ii) first[offset + ii] = SequenceValueConverter<T>::convert(first_buf[ii]);
+      if (0 != second) {
+        for (size_type ii = 0; ii != count; ++ii) second[offset + ii] = SequenceValueConverter<T>::convert(second_buf[ii]);
+      }
+      offset += count;
+    }
+  }
+
+  inline SequenceStatistics ISequence::computeStatistics() const {
+    SequenceStatistics statistics;
+    if (!hasEfficientRanges()) {
+      // Each block would extract the whole sequence, so extract it once instead.
+      SequenceColumns columns;
+      getColumnData(SequenceColumns::eValue | SequenceColumns::eIntervals, columns);
+      if (0 != size()) statistics.accumulate(columns.data(SequenceColumns::eValue),
+        columns.data(SequenceColumns::eLowerBound), columns.data(SequenceColumns::eUpperBound), size());
+      return statistics;
+    }
+    double value[s_block_size];
+    double lower[s_block_size];
+    double upper[s_block_size];
+    for (size_type offset = 0; offset != size(); ) {
+      size_type count = size() - offset;
+      if (s_block_size < count) count = s_block_size;
+      getRange(offset, count, value, lower, upper, 0, 0);
+      statistics.accumulate(value, lower, upper, count);
+      offset += count;
+    }
+    return statistics;
+  }
+
+  inline std::shared_ptr<const BinIndex> ISequence::getBinIndex() const {
+    std::shared_ptr<const BinIndex> bin_index(std::atomic_load(&m_bin_index));
+    if (!bin_index) {
+      std::vector<double> lower_buffer;
+      std::vector<double> upper_buffer;
+      const double * lower = 0;
+      const double * upper = 0;
+      getIntervalData(lower, upper, lower_buffer, upper_buffer);
+      bin_index = std::make_shared<const BinIndex>(lower, upper, size());
+      std::atomic_store(&m_bin_index, bin_index);
+    }
+    return bin_index;
+  }
+
+  inline std::shared_ptr<const GapMask> ISequence::getGapMask() const {
+    std::shared_ptr<const GapMask> gap_mask(std::atomic_load(&m_gap_mask));
+    if (!gap_mask) {
+      std::vector<double> lower_buffer;
+      std::vector<double> upper_buffer;
+      const double * lower = 0;
+      const double * upper = 0;
+      getIntervalData(lower, upper, lower_buffer, upper_buffer);
+      gap_mask = std::make_shared<const GapMask>(lower, upper, size());
+      std::atomic_store(&m_gap_mask, gap_mask);
+    }
+    return gap_mask;
+  }
+
+  inline std::shared_ptr<const ValidityMask> ISequence::getValidityMask(bool positive) const {
+    std::shared_ptr<const ValidityMask> & cache(positive ? m_positive_validity_mask : m_validity_mask);
+    std::shared_ptr<const ValidityMask> validity_mask(std::atomic_load(&cache));
+    if (!validity_mask) {
+      // The bounds are the value offset by the spreads, so only the value and spreads need be checked.
+      std::shared_ptr<ValidityMask> new_mask(std::make_shared<ValidityMask>(size()));
+      if (!hasEfficientRanges()) {
+        // Each block would extract the whole sequence, so extract it once instead.
+        SequenceColumns columns;
+        getColumnData(SequenceColumns::eValue | SequenceColumns::eSpreads, columns);
+        new_mask->markInvalid(columns.data(SequenceColumns::eValue), positive);
+        new_mask->markInvalid(columns.data(SequenceColumns::eLowerSpread));
+        new_mask->markInvalid(columns.data(SequenceColumns::eUpperSpread));
+      } else {
+        // The block size is a multiple of 64, so each block fills whole words of the mask.
+        double value[s_block_size];
+        double low_spread[s_block_size];
+        double high_spread[s_block_size];
+        for (size_type offset = 0; offset != size(); ) {
+          size_type count = size() - offset;
+          if (s_block_size < count) count = s_block_size;
+          getRange(offset, count, value, 0, 0, low_spread, high_spread);
+          new_mask->markInvalid(offset, count, value, positive);
+          new_mask->markInvalid(offset, count, low_spread);
+          new_mask->markInvalid(offset, count, high_spread);
+          offset += count;
+        }
+      }
+      validity_mask = new_mask;
+      std::atomic_store(&cache, validity_mask);
+    }
+    return validity_mask;
+  }
+
+  inline void ISequence::getBinEdges(std::vector<double> & edges) const {
+    std::vector<double> upper;
+    getIntervals(edges, upper);
+    if (!upper.empty()) edges.push_back(upper.back());
+  }
+
+  inline void ISequence::getColumnData(unsigned int mask, SequenceColumns & columns) const {
+    DataView low;
+    DataView high;
+    if (0 != (mask & SequenceColumns::eValue) && getValueView(low) && low.isContiguous()) {
+      columns.setView(SequenceColumns::eValue, low.data());
+      mask &= ~SequenceColumns::eValue;
+    }
+    if (0 != (mask & SequenceColumns::eIntervals) && getIntervalView(low, high) && low.isContiguous() &&
+      high.isContiguous()) {
+      if (0 != (mask & SequenceColumns::eLowerBound)) columns.setView(SequenceColumns::eLowerBound, low.data());
+      if (0 != (mask & SequenceColumns::eUpperBound)) columns.setView(SequenceColumns::eUpperBound, high.data());
+      mask &= ~SequenceColumns::eIntervals;
+    }
+    if (0 != (mask & SequenceColumns::eSpreads) && getSpreadView(low, high) && low.isContiguous() &&
+      high.isContiguous()) {
+      if (0 != (mask & SequenceColumns::eLowerSpread)) columns.setView(SequenceColumns::eLowerSpread, low.data());
+      if (0 != (mask & SequenceColumns::eUpperSpread)) columns.setView(SequenceColumns::eUpperSpread, high.data());
+      mask &= ~SequenceColumns::eSpreads;
+    }
+    if (0 != mask) getColumns(mask, columns);
+  }
+
   /** \class ScalarSequence
       \brief An ISequence in which the individual sequence elements are given by a range of single iterators.
   */
@@ -113,7 +1356,22 @@ namespace st_graph {
       */
       virtual void getSpreads(std::vector<double> & lower, std::vector<double> & upper) const;
 
+      /** \brief Fill the requested columns of a structure-of-arrays block in a single pass over the sequence.
+          \param mask Bitwise combination of SequenceColumns::Column_e values selecting the columns to fill.
+          \param columns The output block.
+      */
+      virtual void getColumns(unsigned int mask, SequenceColumns & columns) const {
+        if (!IsRandomAccess<Itor_t>::value || !this->getColumnsInParallel(mask, columns))
+          this->getColumnRange(mask, 0, this->size(), columns);
+      }
+
+      /// \brief Return true if ranges are computed in time proportional to their length, i.e. for random-access iterators.
+      virtual bool hasEfficientRanges() const { return IsRandomAccess<Itor_t>::value; }
+
     protected:
+      virtual void fillRange(size_type offset, size_type count, double * out_val, double * out_low, double * out_high,
+        double * out_low_spread, double * out_high_spread) const;
+
       virtual double nextElement(const Itor_t & itor) const;
       virtual double prevElement(const Itor_t & itor) const;
 
@@ -126,6 +1384,7 @@ namespace st_graph {
   inline void ScalarSequence<Itor_t>::getValues(std::vector<double> & val) const {
     using namespace std;
     val.resize(size());
+    if (IsRandomAccess<Itor_t>::value && this->fillInParallel(val.data(), 0, 0, 0, 0)) return;
     vector<double>::iterator val_itor = val.begin();
     for (Itor_t in_itor = m_begin; in_itor != m_end; ++in_itor, ++val_itor) {
       *val_itor = value(in_itor);
@@ -138,6 +1397,7 @@ namespace st_graph {
     size_type seq_size = size();
     lower.resize(seq_size);
     upper.resize(seq_size);
+    if (IsRandomAccess<Itor_t>::value && this->fillInParallel(0, lower.data(), upper.data(), 0, 0)) return;
     vector<double>::iterator low_itor = lower.begin();
     vector<double>::iterator high_itor = upper.begin();
     for (Itor_t in_itor = m_begin; in_itor != m_end; ++in_itor, ++low_itor, ++high_itor) {
@@ -152,6 +1412,7 @@ namespace st_graph {
     size_type seq_size = size();
     lower.resize(seq_size);
     upper.resize(seq_size);
+    if (IsRandomAccess<Itor_t>::value && this->fillInParallel(0, 0, 0, lower.data(), upper.data())) return;
     vector<double>::iterator low_itor = lower.begin();
     vector<double>::iterator high_itor = upper.begin();
     for (Itor_t in_itor = m_begin; in_itor != m_end; ++in_itor, ++low_itor, ++high_itor) {
@@ -160,6 +1421,20 @@ namespace st_graph {
     }
   }
 
+  template <typename Itor_t>
+  inline void ScalarSequence<Itor_t>::fillRange(size_type offset, size_type count, double * out_val, double * out_low,
+    double * out_high, double * out_low_spread, double * out_high_spread) const {
+    Itor_t in_itor = m_begin;
+    std::advance(in_itor, offset);
+    for (size_type ii = 0; ii != count; ++ii, ++in_itor) {
+      if (0 != out_val) out_val[ii] = value(in_itor);
+      if (0 != out_low) out_low[ii] = lowerBound(in_itor);
+      if (0 != out_high) out_high[ii] = upperBound(in_itor);
+      if (0 != out_low_spread) out_low_spread[ii] = lowerSpread(in_itor);
+      if (0 != out_high_spread) out_high_spread[ii] = upperSpread(in_itor);
+    }
+  }
+
   template <typename Itor_t>
   inline double ScalarSequence<Itor_t>::nextElement(const Itor_t & itor) const {
     Itor_t next(itor + 1);
@@ -183,12 +1458,304 @@ namespace st_graph {
     return *itor;
   }
 
+  /** \class ScalarKernelSequence
+      \brief A ScalarSequence whose element properties are given by the static formulas of a kernel class, in terms
+             of each element and its previous and next neighbors. Because the formulas are known at compile time,
+             the bulk extraction methods compute all interior elements in a single loop without virtual calls or
+             extrapolation branches, which the compiler can inline and vectorize. Only the first and last elements,
+             whose neighbors may need to be extrapolated, are handled individually.
+
+             Kernel_t must provide static methods value, lowerBound, upperBound, lowerSpread, upperSpread and width,
+             each of which takes the previous, current and next element, in that order. It must also provide
+             static methods computeInteriorIntervals and computeInteriorSpreads, which may compute the bounds or
+             spreads of all interior elements of a contiguous array at once, returning false if they do not.
+  */
+  template <typename Itor_t, typename Kernel_t>
+  class ScalarKernelSequence : public ScalarSequence<Itor_t> {
+    public:
+      typedef typename ScalarSequence<Itor_t>::size_type size_type;
+
+      /** \brief Create a ScalarKernelSequence spanning the given range.
+          \param begin Iterator pointing to the first element in the sequence.
+          \param end Iterator pointing to one position past the last element in the sequence.
+      */
+      ScalarKernelSequence(const Itor_t & begin, const Itor_t & end): ScalarSequence<Itor_t>(begin, end) {}
+
+      virtual double value(const Itor_t & itor) const { return Kernel_t::value(prev(itor), *itor, next(itor)); }
+
+      virtual double lowerBound(const Itor_t & itor) const { return Kernel_t::lowerBound(prev(itor), *itor, next(itor)); }
+
+      virtual double upperBound(const Itor_t & itor) const { return Kernel_t::upperBound(prev(itor), *itor, next(itor)); }
+
+      virtual double lowerSpread(const Itor_t & itor) const { return Kernel_t::lowerSpread(prev(itor), *itor, next(itor)); }
+
+      virtual double upperSpread(const Itor_t & itor) const { return Kernel_t::upperSpread(prev(itor), *itor, next(itor)); }
+
+      virtual double width(const Itor_t & itor) const { return Kernel_t::width(prev(itor), *itor, next(itor)); }
+
+      /** \brief Fill the output container with the values of the sequence.
+          \param val The output container.
+      */
+      virtual void getValues(std::vector<double> & val) const;
+
+      /** \brief Fill the output containers with the upper and lower bounds of each element in the sequence.
+          \param lower The lower bounds of the sequence elements.
+          \param upper The upper bounds of the sequence elements.
+      */
+      virtual void getIntervals(std::vector<double> & lower, std::vector<double> & upper) const;
+
+      /** \brief Fill the output containers with the upper and lower spreads of each element in the sequence.
+          \param lower The lower spreads of the sequence elements.
+          \param upper The upper spreads of the sequence elements.
+      */
+      virtual void getSpreads(std::vector<double> & lower, std::vector<double> & upper) const;
+
+      /** \brief Fill the requested columns of a structure-of-arrays block in a single pass over the sequence.
+          \param mask Bitwise combination of SequenceColumns::Column_e values selecting the columns to fill.
+          \param columns The output block.
+      */
+      virtual void getColumns(unsigned int mask, SequenceColumns & columns) const {
+        // Whole columns go through fillChunk even when extracted serially, so that pairs of bounds or spreads of
+        // contiguous data are computed by the kernel's array methods.
+        if (IsRandomAccess<Itor_t>::value) this->getColumnsByChunks(mask, columns);
+        else this->getColumnRange(mask, 0, this->size(), columns);
+      }
+
+    protected:
+      virtual void fillRange(size_type offset, size_type count, double * out_val, double * out_low, double * out_high,
+        double * out_low_spread, double * out_high_spread) const;
+
+      virtual void fillChunk(size_type begin, size_type end, double * out_val, double * out_low, double * out_high,
+        double * out_low_spread, double * out_high_spread) const;
+
+      // Non-virtual access to the neighbors of an element, so that neighbors the kernel does not use are optimized away.
+      double prev(const Itor_t & itor) const { return ScalarSequence<Itor_t>::prevElement(itor); }
+      double next(const Itor_t & itor) const { return ScalarSequence<Itor_t>::nextElement(itor); }
+
+      /** \brief Compute the requested properties of the interior elements [begin, end), which must satisfy
+                 0 < begin and end < size(). The elements are read through a single iterator which slides along the
+                 sequence, keeping the previous, current and next element, so that each is read once, rather than
+                 indexing each element's neighbors, which costs a lookup per access for iterators such as those of
+                 std::deque. Element ii is stored at index ii - offset of each output which is not 0.
+          \param offset The index of the element stored first in the outputs.
+          \param begin The index of the first element to compute.
+          \param end One past the index of the last element to compute.
+      */
+      void fillInterior(size_type offset, size_type begin, size_type end, double * out_val, double * out_low,
+        double * out_high, double * out_low_spread, double * out_high_spread) const;
+
+      /** \brief Compute the requested properties of the first or last element, whose missing neighbor is
+                 extrapolated, storing them at index index - offset of each output which is not 0.
+          \param offset The index of the element stored first in the outputs.
+          \param index The index of the element.
+      */
+      void fillEdge(size_type offset, size_type index, double * out_val, double * out_low, double * out_high,
+        double * out_low_spread, double * out_high_spread) const;
+  };
+
+  template <typename Itor_t, typename Kernel_t>
+  inline void ScalarKernelSequence<Itor_t, Kernel_t>::getValues(std::vector<double> & val) const {
+    size_type seq_size = this->size();
+    val.resize(seq_size);
+    if (0 == seq_size || (IsRandomAccess<Itor_t>::value && this->fillInParallel(&val[0], 0, 0, 0, 0))) return;
+    const Itor_t & in = this->m_begin;
+    double * out = &val[0];
+    out[0] = ScalarKernelSequence::value(in);
+    if (2 < seq_size) fillInterior(0, 1, seq_size - 1, out, 0, 0, 0, 0);
+    if (1 < seq_size) out[seq_size - 1] = ScalarKernelSequence::value(in + (seq_size - 1));
+  }
+
+  template <typename Itor_t, typename Kernel_t>
+  inline void ScalarKernelSequence<Itor_t, Kernel_t>::getIntervals(std::vector<double> & lower, std::vector<double> & upper) const {
+    size_type seq_size = this->size();
+    lower.resize(seq_size);
+    upper.resize(seq_size);
+    if (0 == seq_size || (IsRandomAccess<Itor_t>::value && this->fillInParallel(0, &lower[0], &upper[0], 0, 0))) return;
+    const Itor_t & in = this->m_begin;
+    double * out_low = &lower[0];
+    double * out_high = &upper[0];
+    out_low[0] = ScalarKernelSequence::lowerBound(in);
+    out_high[0] = ScalarKernelSequence::upperBound(in);
+    DataView view;
+    if (!makeDataView(in, seq_size, view) || !view.isContiguous() ||
+      !Kernel_t::computeInteriorIntervals(view.data(), seq_size, out_low, out_high)) {
+      if (2 < seq_size) fillInterior(0, 1, seq_size - 1, 0, out_low, out_high, 0, 0);
+    }
+    if (1 < seq_size) {
+      Itor_t last = in + (seq_size - 1);
+      out_low[seq_size - 1] = ScalarKernelSequence::lowerBound(last);
+      out_high[seq_size - 1] = ScalarKernelSequence::upperBound(last);
+    }
+  }
+
+  template <typename Itor_t, typename Kernel_t>
+  inline void ScalarKernelSequence<Itor_t, Kernel_t>::getSpreads(std::vector<double> & lower, std::vector<double> & upper) const {
+    size_type seq_size = this->size();
+    lower.resize(seq_size);
+    upper.resize(seq_size);
+    if (0 == seq_size || (IsRandomAccess<Itor_t>::value && this->fillInParallel(0, 0, 0, &lower[0], &upper[0]))) return;
+    const Itor_t & in = this->m_begin;
+    double * out_low = &lower[0];
+    double * out_high = &upper[0];
+    out_low[0] = ScalarKernelSequence::lowerSpread(in);
+    out_high[0] = ScalarKernelSequence::upperSpread(in);
+    DataView view;
+    if (!makeDataView(in, seq_size, view) || !view.isContiguous() ||
+      !Kernel_t::computeInteriorSpreads(view.data(), seq_size, out_low, out_high)) {
+      if (2 < seq_size) fillInterior(0, 1, seq_size - 1, 0, 0, 0, out_low, out_high);
+    }
+    if (1 < seq_size) {
+      Itor_t last = in + (seq_size - 1);
+      out_low[seq_size - 1] = ScalarKernelSequence::lowerSpread(last);
+      out_high[seq_size - 1] = ScalarKernelSequence::upperSpread(last);
+    }
+  }
+
+  template <typename Itor_t, typename Kernel_t>
+  inline void ScalarKernelSequence<Itor_t, Kernel_t>::fillRange(size_type offset, size_type count, double * out_val,
+    double * out_low, double * out_high, double * out_low_spread, double * out_high_spread) const {
+    // Each element and its neighbors are read once for all requested columns. Only the first and last elements need
+    // extrapolated neighbors; the interior is read through a sliding window.
+    size_type seq_size = this->size();
+    size_type end = offset + count;
+    size_type first = 0 != offset ? offset : 1;
+    size_type last = seq_size - 1 < end ? seq_size - 1 : end;
+    if (0 == offset) fillEdge(offset, 0, out_val, out_low, out_high, out_low_spread, out_high_spread);
+    if (first < last) fillInterior(offset, first, last, out_val, out_low, out_high, out_low_spread, out_high_spread);
+    if (1 < seq_size && seq_size == end)
+      fillEdge(offset, seq_size - 1, out_val, out_low, out_high, out_low_spread, out_high_spread);
+  }
+
+  template <typename Itor_t, typename Kernel_t>
+  inline void ScalarKernelSequence<Itor_t, Kernel_t>::fillEdge(size_type offset, size_type index, double * out_val,
+    double * out_low, double * out_high, double * out_low_spread, double * out_high_spread) const {
+    Itor_t itor = this->m_begin + index;
+    double prev_val = this->prev(itor);
+    double cur_val = *itor;
+    double next_val = this->next(itor);
+    size_type jj = index - offset;
+    if (0 != out_val) out_val[jj] = Kernel_t::value(prev_val, cur_val, next_val);
+    if (0 != out_low) out_low[jj] = Kernel_t::lowerBound(prev_val, cur_val, next_val);
+    if (0 != out_high) out_high[jj] = Kernel_t::upperBound(prev_val, cur_val, next_val);
+    if (0 != out_low_spread) out_low_spread[jj] = Kernel_t::lowerSpread(prev_val, cur_val, next_val);
+    if (0 != out_high_spread) out_high_spread[jj] = Kernel_t::upperSpread(prev_val, cur_val, next_val);
+  }
+
+  template <typename Itor_t, typename Kernel_t>
+  inline void ScalarKernelSequence<Itor_t, Kernel_t>::fillInterior(size_type offset, size_type begin, size_type end,
+    double * out_val, double * out_low, double * out_high, double * out_low_spread, double * out_high_spread) const {
+    // The iterator is advanced once per element, and always points at the element after the next one, which is at
+    // most one past the end of the sequence.
+    Itor_t itor = this->m_begin + (begin - 1);
+    double prev_val = *itor;
+    double cur_val = *++itor;
+    ++itor;
+    for (size_type ii = begin; ii != end; ++ii, ++itor) {
+      double next_val = *itor;
+      size_type jj = ii - offset;
+      if (0 != out_val) out_val[jj] = Kernel_t::value(prev_val, cur_val, next_val);
+      if (0 != out_low) out_low[jj] = Kernel_t::lowerBound(prev_val, cur_val, next_val);
+      if (0 != out_high) out_high[jj] = Kernel_t::upperBound(prev_val, cur_val, next_val);
+      if (0 != out_low_spread) out_low_spread[jj] = Kernel_t::lowerSpread(prev_val, cur_val, next_val);
+      if (0 != out_high_spread) out_high_spread[jj] = Kernel_t::upperSpread(prev_val, cur_val, next_val);
+      prev_val = cur_val;
+      cur_val = next_val;
+    }
+  }
+
+  template <typename Itor_t, typename Kernel_t>
+  inline void ScalarKernelSequence<Itor_t, Kernel_t>::fillChunk(size_type begin, size_type end, double * out_val,
+    double * out_low, double * out_high, double * out_low_spread, double * out_high_spread) const {
+    // As in the serial extraction methods, pairs of bounds or spreads of the interior elements of contiguous data
+    // are computed by the kernel's array methods, and everything else by fillRange.
+    size_type seq_size = this->size();
+    size_type first = 0 != begin ? begin : 1;
+    size_type last = seq_size != end ? end : seq_size - 1;
+    DataView view;
+    if (first < last && makeDataView(this->m_begin, seq_size, view) && view.isContiguous()) {
+      // The kernels compute the interior of the array they are given, so the chunk is extended by one neighbor
+      // on each side.
+      const double * in = view.data() + (first - 1);
+      size_type in_size = last - first + 2;
+      if (0 != out_low && 0 != out_high &&
+        Kernel_t::computeInteriorIntervals(in, in_size, out_low + (first - 1), out_high + (first - 1))) {
+        if (first != begin) ISequence::fillChunk(begin, first, 0, out_low, out_high, 0, 0);
+        if (last != end) ISequence::fillChunk(last, end, 0, out_low, out_high, 0, 0);
+        out_low = 0;
+        out_high = 0;
+      }
+      if (0 != out_low_spread && 0 != out_high_spread &&
+        Kernel_t::computeInteriorSpreads(in, in_size, out_low_spread + (first - 1), out_high_spread + (first - 1))) {
+        if (first != begin) ISequence::fillChunk(begin, first, 0, 0, 0, out_low_spread, out_high_spread);
+        if (last != end) ISequence::fillChunk(last, end, 0, 0, 0, out_low_spread, out_high_spread);
+        out_low_spread = 0;
+        out_high_spread = 0;
+      }
+    }
+    if (0 != out_val || 0 != out_low || 0 != out_high || 0 != out_low_spread || 0 != out_high_spread)
+      ISequence::fillChunk(begin, end, out_val, out_low, out_high, out_low_spread, out_high_spread);
+  }
+
+  /** \class PointKernel
+      \brief Element formulas for PointSequence: every element is a sharp point, independent of its neighbors.
+  */
+  struct PointKernel {
+    static double value(double, double cur, double) { return cur; }
+    static double lowerBound(double, double cur, double) { return cur; }
+    static double upperBound(double, double cur, double) { return cur; }
+    static double lowerSpread(double, double, double) { return 0.; }
+    static double upperSpread(double, double, double) { return 0.; }
+    static double width(double, double, double) { return 0.; }
+    static bool computeInteriorIntervals(const double *, unsigned long, double *, double *) { return false; }
+    static bool computeInteriorSpreads(const double *, unsigned long, double *, double *) { return false; }
+  };
+
+  /** \class ValueKernel
+      \brief Element formulas for ValueSequence: bounds are the midpoints between an element and its neighbors.
+  */
+  struct ValueKernel {
+    static double value(double, double cur, double) { return cur; }
+    static double lowerBound(double prev, double cur, double) { return cur - .5 * (cur - prev); }
+    static double upperBound(double, double cur, double next) { return cur + .5 * (next - cur); }
+    static double lowerSpread(double prev, double cur, double) { return .5 * (cur - prev); }
+    static double upperSpread(double, double cur, double next) { return .5 * (next - cur); }
+    static double width(double prev, double, double next) { return .5 * (next - prev); }
+    static bool computeInteriorIntervals(const double * in, unsigned long size, double * lower, double * upper) {
+      SimdKernel::computeInterior(SimdKernel::eValueBounds, in, size, lower, upper);
+      return true;
+    }
+    static bool computeInteriorSpreads(const double * in, unsigned long size, double * lower, double * upper) {
+      SimdKernel::computeInterior(SimdKernel::eValueSpreads, in, size, lower, upper);
+      return true;
+    }
+  };
+
+  /** \class LowerBoundKernel
+      \brief Element formulas for LowerBoundSequence: each element extends from itself to the next element.
+  */
+  struct LowerBoundKernel {
+    static double value(double, double cur, double next) { return .5 * (cur + next); }
+    static double lowerBound(double, double cur, double) { return cur; }
+    static double upperBound(double, double, double next) { return next; }
+    static double lowerSpread(double, double cur, double next) { return .5 * (next - cur); }
+    static double upperSpread(double, double cur, double next) { return .5 * (next - cur); }
+    static double width(double, double cur, double next) { return next - cur; }
+    static bool computeInteriorIntervals(const double * in, unsigned long size, double * lower, double * upper) {
+      SimdKernel::computeInterior(SimdKernel::eLowerBoundBounds, in, size, lower, upper);
+      return true;
+    }
+    static bool computeInteriorSpreads(const double * in, unsigned long size, double * lower, double * upper) {
+      SimdKernel::computeInterior(SimdKernel::eLowerBoundSpreads, in, size, lower, upper);
+      return true;
+    }
+  };
+
   /** \class PointSequence
       \brief A ScalarSequence in which the iterators are assumed to represent perfectly sharp points,
              with no spreads.
   */
   template <typename Itor_t>
-  class PointSequence : public ScalarSequence<Itor_t> {
+  class PointSequence : public ScalarKernelSequence<Itor_t, PointKernel> {
     public:
       /** \brief Create a PointSequence spanning the given range of iterators. The iterators
                  represent points which are perfectly defined, with no spreads. The upper and
@@ -196,19 +1763,15 @@ namespace st_graph {
           \param begin Iterator pointing to the first element in the sequence.
           \param end Iterator pointing to one position past the last element in the sequence.
       */
-      PointSequence(const Itor_t & begin, const Itor_t & end): ScalarSequence<Itor_t>(begin, end) {}
-
-      virtual double value(const Itor_t & itor) const { return *itor; }
-
-      virtual double lowerBound(const Itor_t & itor) const { return *itor; }
-
-      virtual double upperBound(const Itor_t & itor) const { return *itor; }
+      PointSequence(const Itor_t & begin, const Itor_t & end): ScalarKernelSequence<Itor_t, PointKernel>(begin, end) {}
 
-      virtual double lowerSpread(const Itor_t &) const { return 0.; }
+      virtual bool getValueView(DataView & val) const { return makeDataView(this->m_begin, this->size(), val); }
 
-      virtual double upperSpread(const Itor_t &) const { return 0.; }
-
-      virtual double width(const Itor_t &) const { return 0.; }
+      virtual bool getIntervalView(DataView & lower, DataView & upper) const {
+        if (!makeDataView(this->m_begin, this->size(), lower)) return false;
+        upper = lower;
+        return true;
+      }
 
       /** \brief Return a new copy of the current ISequence subclass.
       */
@@ -220,7 +1783,7 @@ namespace st_graph {
              and bounds for each element determined from adjacent elements.
   */
   template <typename Itor_t>
-  class ValueSequence : public ScalarSequence<Itor_t> {
+  class ValueSequence : public ScalarKernelSequence<Itor_t, ValueKernel> {
     public:
       /** \brief Create a ValueSequence spanning the given range of iterators. The iterators
                  point to the values of the sequence. The lower/upper bound of each element is taken
@@ -229,19 +1792,9 @@ namespace st_graph {
           \param begin Iterator pointing to the first element in the sequence.
           \param end Iterator pointing to one position past the last element in the sequence.
       */
-      ValueSequence(const Itor_t & begin, const Itor_t & end): ScalarSequence<Itor_t>(begin, end) {}
-
-      virtual double value(const Itor_t & itor) const { return *itor; }
-
-      virtual double lowerBound(const Itor_t & itor) const { return *itor - lowerSpread(itor); }
-
-      virtual double upperBound(const Itor_t & itor) const { return *itor + upperSpread(itor); }
+      ValueSequence(const Itor_t & begin, const Itor_t & end): ScalarKernelSequence<Itor_t, ValueKernel>(begin, end) {}
 
-      virtual double lowerSpread(const Itor_t & itor) const { return .5 * (*itor - this->prevElement(itor)); }
-
-      virtual double upperSpread(const Itor_t & itor) const { return .5 * (this->nextElement(itor) - *itor); }
-
-      virtual double width(const Itor_t & itor) const { return .5 * (this->nextElement(itor) - this->prevElement(itor)); }
+      virtual bool getValueView(DataView & val) const { return makeDataView(this->m_begin, this->size(), val); }
 
       /** \brief Return a new copy of the current ISequence subclass.
       */
@@ -253,7 +1806,7 @@ namespace st_graph {
              with the spreads, values and upper bound for each element determined from adjacent elements.
   */
   template <typename Itor_t>
-  class LowerBoundSequence : public ScalarSequence<Itor_t> {
+  class LowerBoundSequence : public ScalarKernelSequence<Itor_t, LowerBoundKernel> {
     public:
       /** \brief Create a LowerBoundSequence spanning the given range of iterators. The iterators
                  point to the lower bounds of the sequence. The upper bound of each element is taken
@@ -262,19 +1815,7 @@ namespace st_graph {
           \param begin Iterator pointing to the first element in the sequence.
           \param end Iterator pointing to one position past the last element in the sequence.
       */
-      LowerBoundSequence(const Itor_t & begin, const Itor_t & end): ScalarSequence<Itor_t>(begin, end) {}
-
-      virtual double value(const Itor_t & itor) const { return .5 * (*itor + this->nextElement(itor)); }
-
-      virtual double lowerBound(const Itor_t & itor) const { return *itor; }
-
-      virtual double upperBound(const Itor_t & itor) const { return this->nextElement(itor); }
-
-      virtual double lowerSpread(const Itor_t & itor) const { return .5 * width(itor); }
-
-      virtual double upperSpread(const Itor_t & itor) const { return .5 * width(itor); }
-
-      virtual double width(const Itor_t & itor) const { return this->nextElement(itor) - *itor; }
+      LowerBoundSequence(const Itor_t & begin, const Itor_t & end): ScalarKernelSequence<Itor_t, LowerBoundKernel>(begin, end) {}
 
       /** \brief Return a new copy of the current ISequence subclass.
       */
@@ -327,10 +1868,30 @@ namespace st_graph {
       */
       virtual void getSpreads(std::vector<double> & lower, std::vector<double> & upper) const;
 
+      /** \brief Fill the requested columns of a structure-of-arrays block in a single pass over the sequence.
+          \param mask Bitwise combination of SequenceColumns::Column_e values selecting the columns to fill.
+          \param columns The output block.
+      */
+      virtual void getColumns(unsigned int mask, SequenceColumns & columns) const {
+        if (!IsRandomAccess<Itor_t>::value || !this->getColumnsInParallel(mask, columns))
+          this->getColumnRange(mask, 0, this->size(), columns);
+      }
+
+      virtual bool getValueView(DataView & val) const { return makeDataView(m_value_begin, size(), val); }
+
+      virtual bool getSpreadView(DataView & lower, DataView & upper) const;
+
+      /// \brief Return true if ranges are computed in time proportional to their length, i.e. for random-access iterators.
+      virtual bool hasEfficientRanges() const { return IsRandomAccess<Itor_t>::value; }
+
       /** \brief Return a new copy of the current ISequence subclass.
       */
       virtual ISequence * clone() const { return new ValueSpreadSequence(*this); }
 
+    protected:
+      virtual void fillRange(size_type offset, size_type count, double * out_val, double * out_low, double * out_high,
+        double * out_low_spread, double * out_high_spread) const;
+
     private:
       Itor_t m_value_begin;
       Itor_t m_value_end;
@@ -341,6 +1902,7 @@ namespace st_graph {
   template <typename Itor_t>
   void ValueSpreadSequence<Itor_t>::getValues(std::vector<double> & val) const {
     val.resize(size());
+    if (IsRandomAccess<Itor_t>::value && fillInParallel(val.data(), 0, 0, 0, 0)) return;
     std::vector<double>::iterator out_val = val.begin();
     for (Itor_t in_val = m_value_begin; in_val != m_value_end; ++in_val, ++out_val) {
       *out_val = *in_val;
@@ -352,6 +1914,7 @@ namespace st_graph {
     size_type seq_size = size();
     lower.resize(seq_size);
     upper.resize(seq_size);
+    if (IsRandomAccess<Itor_t>::value && fillInParallel(0, lower.data(), upper.data(), 0, 0)) return;
     std::vector<double>::iterator out_low = lower.begin();
     std::vector<double>::iterator out_high = upper.begin();
     Itor_t in_low = m_low_spread_begin;
@@ -367,6 +1930,7 @@ namespace st_graph {
     size_type seq_size = size();
     lower.resize(seq_size);
     upper.resize(seq_size);
+    if (IsRandomAccess<Itor_t>::value && fillInParallel(0, 0, 0, lower.data(), upper.data())) return;
     std::vector<double>::iterator out_low = lower.begin();
     std::vector<double>::iterator out_high = upper.begin();
     Itor_t in_low = m_low_spread_begin;
@@ -377,6 +1941,33 @@ namespace st_graph {
     }
   }
 
+  template <typename Itor_t>
+  void ValueSpreadSequence<Itor_t>::fillRange(size_type offset, size_type count, double * out_val, double * out_low, double * out_high,
+    double * out_low_spread, double * out_high_spread) const {
+    Itor_t in_val = m_value_begin;
+    Itor_t in_low = m_low_spread_begin;
+    Itor_t in_high = m_high_spread_begin;
+    std::advance(in_val, offset);
+    std::advance(in_low, offset);
+    std::advance(in_high, offset);
+    for (size_type ii = 0; ii != count; ++ii, ++in_val, ++in_low, ++in_high) {
+      // Read each input stream once per element.
+      double val = *in_val;
+      double low_spread = *in_low;
+      double high_spread = *in_high;
+      if (0 != out_val) out_val[ii] = val;
+      if (0 != out_low) out_low[ii] = val - low_spread;
+      if (0 != out_high) out_high[ii] = val + high_spread;
+      if (0 != out_low_spread) out_low_spread[ii] = low_spread;
+      if (0 != out_high_spread) out_high_spread[ii] = high_spread;
+    }
+  }
+
+  template <typename Itor_t>
+  bool ValueSpreadSequence<Itor_t>::getSpreadView(DataView & lower, DataView & upper) const {
+    return makeDataView(m_low_spread_begin, size(), lower) && makeDataView(m_high_spread_begin, size(), upper);
+  }
+
   /** \class IntervalSequence
       \brief An ISequence in which two distinct iterators represent the lower and upper bounds of each element.
   */
@@ -411,19 +2002,65 @@ namespace st_graph {
       */
       virtual void getSpreads(std::vector<double> & lower, std::vector<double> & upper) const;
 
+      /** \brief Fill the requested columns of a structure-of-arrays block in a single pass over the sequence.
+          \param mask Bitwise combination of SequenceColumns::Column_e values selecting the columns to fill.
+          \param columns The output block.
+      */
+      virtual void getColumns(unsigned int mask, SequenceColumns & columns) const {
+        if (!IsRandomAccess<Itor_t>::value || !this->getColumnsInParallel(mask, columns))
+          this->getColumnRange(mask, 0, this->size(), columns);
+      }
+
+      virtual bool getIntervalView(DataView & lower, DataView & upper) const;
+
+      /// \brief Return true if ranges are computed in time proportional to their length, i.e. for random-access iterators.
+      virtual bool hasEfficientRanges() const { return IsRandomAccess<Itor_t>::value; }
+
       /** \brief Return a new copy of the current ISequence subclass.
       */
       virtual ISequence * clone() const { return new IntervalSequence(*this); }
 
+    protected:
+      virtual void fillRange(size_type offset, size_type count, double * out_val, double * out_low, double * out_high,
+        double * out_low_spread, double * out_high_spread) const;
+
     private:
       Itor_t m_low_begin;
       Itor_t m_low_end;
       Itor_t m_high_begin;
   };
 
+  template <typename Itor_t>
+  void IntervalSequence<Itor_t>::fillRange(size_type offset, size_type count, double * out_val, double * out_low, double * out_high,
+    double * out_low_spread, double * out_high_spread) const {
+    Itor_t in_low = m_low_begin;
+    Itor_t in_high = m_high_begin;
+    std::advance(in_low, offset);
+    std::advance(in_high, offset);
+    for (size_type ii = 0; ii != count; ++ii, ++in_low, ++in_high) {
+      // Read each input stream once per element.
+      double low = *in_low;
+      double high = *in_high;
+      if (0 != out_val) out_val[ii] = .5 * (low + high);
+      if (0 != out_low) out_low[ii] = low;
+      if (0 != out_high) out_high[ii] = high;
+      if (0 != out_low_spread || 0 != out_high_spread) {
+        double spread = .5 * (high - low);
+        if (0 != out_low_spread) out_low_spread[ii] = spread;
+        if (0 != out_high_spread) out_high_spread[ii] = spread;
+      }
+    }
+  }
+
+  template <typename Itor_t>
+  bool IntervalSequence<Itor_t>::getIntervalView(DataView & lower, DataView & upper) const {
+    return makeDataView(m_low_begin, size(), lower) && makeDataView(m_high_begin, size(), upper);
+  }
+
   template <typename Itor_t>
   void IntervalSequence<Itor_t>::getValues(std::vector<double> & val) const {
     val.resize(size());
+    if (IsRandomAccess<Itor_t>::value && fillInParallel(val.data(), 0, 0, 0, 0)) return;
     std::vector<double>::iterator out_val = val.begin();
     Itor_t in_high = m_high_begin;
     for (Itor_t in_low = m_low_begin; in_low != m_low_end; ++in_low, ++in_high, ++out_val) {
@@ -436,6 +2073,7 @@ namespace st_graph {
     size_type seq_size = size();
     lower.resize(seq_size);
     upper.resize(seq_size);
+    if (IsRandomAccess<Itor_t>::value && fillInParallel(0, lower.data(), upper.data(), 0, 0)) return;
     std::vector<double>::iterator out_low = lower.begin();
     std::vector<double>::iterator out_high = upper.begin();
     Itor_t in_high = m_high_begin;
@@ -450,6 +2088,7 @@ namespace st_graph {
     size_type seq_size = size();
     lower.resize(seq_size);
     upper.resize(seq_size);
+    if (IsRandomAccess<Itor_t>::value && fillInParallel(0, 0, 0, lower.data(), upper.data())) return;
     std::vector<double>::iterator out_low = lower.begin();
     std::vector<double>::iterator out_high = upper.begin();
     Itor_t in_high = m_high_begin;
@@ -460,6 +2099,266 @@ namespace st_graph {
     }
   }
 
+
+  /** \class LinearEdge
+      \brief Policy for AnalyticBinSequence giving edges which are equally spaced between two bounds.
+  */
+  class LinearEdge {
+    public:
+      typedef ISequence::size_type size_type;
+
+      LinearEdge(double lower, double upper, size_type num_bins): m_lower(lower), m_upper(upper),
+        m_step(0 != num_bins ? (upper - lower) / num_bins : 0.), m_num_bins(num_bins) {
+        if (!(lower < upper)) throw std::logic_error("LinearEdge: lower bound must be less than upper bound");
+      }
+
+      /// \brief Return the edge with the given index, from 0 (the lower bound) to the number of bins (the upper bound).
+      double operator ()(size_type index) const { return m_num_bins == index ? m_upper : m_lower + index * m_step; }
+
+      /// \brief Return the approximate position of a coordinate in units of bins, with 0 at the lower bound.
+      double locate(double x) const { return (x - m_lower) / m_step; }
+
+      double getLower() const { return m_lower; }
+
+      double getUpper() const { return m_upper; }
+
+    private:
+      double m_lower;
+      double m_upper;
+      double m_step;
+      size_type m_num_bins;
+  };
+
+  /** \class LogEdge
+      \brief Policy for AnalyticBinSequence giving edges which are equally spaced in the logarithm between two
+             positive bounds.
+  */
+  class LogEdge {
+    public:
+      typedef ISequence::size_type size_type;
+
+      LogEdge(double lower, double upper, size_type num_bins): m_lower(lower), m_upper(upper),
+        m_ratio(0 != num_bins ? std::pow(upper / lower, 1. / num_bins) : 1.), m_num_bins(num_bins) {
+        if (!(0. < lower)) throw std::logic_error("LogEdge: lower bound must be positive");
+        if (!(lower < upper)) throw std::logic_error("LogEdge: lower bound must be less than upper bound");
+      }
+
+      /// \brief Return the edge with the given index, from 0 (the lower bound) to the number of bins (the upper bound).
+      double operator ()(size_type index) const {
+        return m_num_bins == index ? m_upper : m_lower * std::pow(m_ratio, double(index));
+      }
+
+      /// \brief Return the approximate position of a coordinate in units of bins, with 0 at the lower bound.
+      double locate(double x) const { return std::log(x / m_lower) / std::log(m_ratio); }
+
+      double getLower() const { return m_lower; }
+
+      double getUpper() const { return m_upper; }
+
+    private:
+      double m_lower;
+      double m_upper;
+      double m_ratio;
+      size_type m_num_bins;
+  };
+
+  /** \class AnalyticBinSequence
+      \brief An ISequence of adjacent bins whose edges are computed on demand from a formula rather than stored,
+             so that the sequence occupies constant memory regardless of the number of bins. Elements behave like
+             those of an IntervalSequence: values are the midpoints of the bins and spreads are one half their widths.
+  */
+  template <typename Edge_t>
+  class AnalyticBinSequence : public ISequence {
+    public:
+      /** \brief Create a sequence of bins spanning the given range.
+          \param lower The lower bound of the first bin.
+          \param upper The upper bound of the last bin.
+          \param num_bins The number of bins.
+      */
+      AnalyticBinSequence(double lower, double upper, size_type num_bins): ISequence(num_bins),
+        m_edge(lower, upper, num_bins) {}
+
+      /** \brief Fill the output container with the values of the sequence.
+          \param val The output container.
+      */
+      virtual void getValues(std::vector<double> & val) const;
+
+      /** \brief Fill the output containers with the upper and lower bounds of each element in the sequence.
+          \param lower The lower bounds of the sequence elements.
+          \param upper The upper bounds of the sequence elements.
+      */
+      virtual void getIntervals(std::vector<double> & lower, std::vector<double> & upper) const;
+
+      /** \brief Fill the output containers with the upper and lower spreads of each element in the sequence.
+          \param lower The lower spreads of the sequence elements.
+          \param upper The upper spreads of the sequence elements.
+      */
+      virtual void getSpreads(std::vector<double> & lower, std::vector<double> & upper) const;
+
+      /** \brief Fill the requested columns of a structure-of-arrays block in a single pass over the sequence.
+          \param mask Bitwise combination of SequenceColumns::Column_e values selecting the columns to fill.
+          \param columns The output block.
+      */
+      virtual void getColumns(unsigned int mask, SequenceColumns & columns) const {
+        getColumnRange(mask, 0, size(), columns);
+      }
+
+      virtual void getBinEdges(std::vector<double> & edges) const;
+
+      /** \brief Find the bin containing the given coordinate in constant time, by computing its position from the
+                 edge formula. The result agrees exactly with the bounds returned by getIntervals.
+          \param x The coordinate.
+          \param index The output index of the bin containing x, or if x lies outside the bins, the number of bins
+                 below x.
+      */
+      virtual bool findBin(double x, size_type & index) const;
+
+      /** \brief Find the bins which overlap the half-open range [x0, x1) in constant time.
+          \param x0 The lower limit of the range.
+          \param x1 The upper limit of the range.
+          \param begin The output index of the first bin overlapping the range.
+          \param end The output index one past the last bin overlapping the range.
+      */
+      virtual void findRange(double x0, double x1, size_type & begin, size_type & end) const;
+
+      /// \brief Return the edge with the given index, from 0 (the lower bound) to size() (the upper bound).
+      double getEdge(size_type index) const { return m_edge(index); }
+
+      /// \brief Return true, because each element is computed from its index alone.
+      virtual bool hasEfficientRanges() const { return true; }
+
+      /// \brief Return true, because the edges are computed rather than read.
+      virtual bool hasFixedData() const { return true; }
+
+    protected:
+      virtual void fillRange(size_type offset, size_type count, double * out_val, double * out_low, double * out_high,
+        double * out_low_spread, double * out_high_spread) const;
+
+      Edge_t m_edge;
+  };
+
+  template <typename Edge_t>
+  void AnalyticBinSequence<Edge_t>::getValues(std::vector<double> & val) const {
+    val.resize(size());
+    if (!val.empty()) fillRange(0, val.size(), &val[0], 0, 0, 0, 0);
+  }
+
+  template <typename Edge_t>
+  void AnalyticBinSequence<Edge_t>::getIntervals(std::vector<double> & lower, std::vector<double> & upper) const {
+    lower.resize(size());
+    upper.resize(size());
+    if (!lower.empty()) fillRange(0, lower.size(), 0, &lower[0], &upper[0], 0, 0);
+  }
+
+  template <typename Edge_t>
+  void AnalyticBinSequence<Edge_t>::getSpreads(std::vector<double> & lower, std::vector<double> & upper) const {
+    lower.resize(size());
+    upper.resize(size());
+    if (!lower.empty()) fillRange(0, lower.size(), 0, 0, 0, &lower[0], &upper[0]);
+  }
+
+  template <typename Edge_t>
+  void AnalyticBinSequence<Edge_t>::fillRange(size_type offset, size_type count, double * out_val, double * out_low,
+    double * out_high, double * out_low_spread, double * out_high_spread) const {
+    // Each edge is computed once, serving as the upper bound of one bin and the lower bound of the next.
+    double high = m_edge(offset);
+    for (size_type ii = 0; ii != count; ++ii) {
+      double low = high;
+      high = m_edge(offset + ii + 1);
+      if (0 != out_val) out_val[ii] = .5 * (low + high);
+      if (0 != out_low) out_low[ii] = low;
+      if (0 != out_high) out_high[ii] = high;
+      if (0 != out_low_spread || 0 != out_high_spread) {
+        double spread = .5 * (high - low);
+        if (0 != out_low_spread) out_low_spread[ii] = spread;
+        if (0 != out_high_spread) out_high_spread[ii] = spread;
+      }
+    }
+  }
+
+  template <typename Edge_t>
+  void AnalyticBinSequence<Edge_t>::getBinEdges(std::vector<double> & edges) const {
+    size_type seq_size = size();
+    edges.resize(0 != seq_size ? seq_size + 1 : 0);
+    for (std::vector<double>::size_type ii = 0; ii != edges.size(); ++ii) edges[ii] = m_edge(ii);
+  }
+
+  template <typename Edge_t>
+  bool AnalyticBinSequence<Edge_t>::findBin(double x, size_type & index) const {
+    size_type num_bins = size();
+    index = 0;
+    if (0 == num_bins || !(m_edge(0) <= x)) return false;
+    if (!(x < m_edge(num_bins))) {
+      index = num_bins;
+      return false;
+    }
+    // The formula may be off by one bin due to rounding, so the estimate is corrected against the edges themselves.
+    double pos = m_edge.locate(x);
+    index = 0. < pos ? (pos < num_bins ? size_type(pos) : num_bins - 1) : 0;
+    while (0 != index && x < m_edge(index)) --index;
+    while (num_bins - 1 != index && !(x < m_edge(index + 1))) ++index;
+    return true;
+  }
+
+  template <typename Edge_t>
+  void AnalyticBinSequence<Edge_t>::findRange(double x0, double x1, size_type & begin, size_type & end) const {
+    // The first bin whose upper bound exceeds x0, and the first bin whose lower bound is at least x1.
+    if (x0 != x0) begin = size();
+    else findBin(x0, begin);
+    if (findBin(x1, end) && m_edge(end) < x1) ++end;
+    if (end < begin) end = begin;
+  }
+
+  /** \class LinearSequence
+      \brief An AnalyticBinSequence of bins of equal width, e.g. for time-binned data. The bins of a LinearSequence
+             with N bins from lower to upper are the same as those of an IntervalSequence whose bounds are
+             lower + i * (upper - lower) / N, but take no memory to store.
+  */
+  class LinearSequence : public AnalyticBinSequence<LinearEdge> {
+    public:
+      /** \brief Create a sequence of bins of equal width spanning the given range.
+          \param lower The lower bound of the first bin.
+          \param upper The upper bound of the last bin, which must be greater than lower.
+          \param num_bins The number of bins.
+      */
+      LinearSequence(double lower, double upper, size_type num_bins):
+        AnalyticBinSequence<LinearEdge>(lower, upper, num_bins) {}
+
+      virtual bool getUniformBins(double & lower, double & upper) const {
+        lower = m_edge.getLower();
+        upper = m_edge.getUpper();
+        return true;
+      }
+
+      /** \brief Return a new copy of the current ISequence subclass.
+      */
+      virtual ISequence * clone() const { return new LinearSequence(*this); }
+  };
+
+  /** \class LogSequence
+      \brief An AnalyticBinSequence of bins of equal width in the logarithm, e.g. for energy-binned data. The value of
+             each bin is its arithmetic midpoint, as for an IntervalSequence with the same bounds.
+  */
+  class LogSequence : public AnalyticBinSequence<LogEdge> {
+    public:
+      /** \brief Create a sequence of bins of equal logarithmic width spanning the given range.
+          \param lower The lower bound of the first bin, which must be positive.
+          \param upper The upper bound of the last bin, which must be greater than lower.
+          \param num_bins The number of bins.
+      */
+      LogSequence(double lower, double upper, size_type num_bins): AnalyticBinSequence<LogEdge>(lower, upper, num_bins) {}
+
+      virtual bool getLogUniformBins(double & lower, double & upper) const {
+        lower = m_edge.getLower();
+        upper = m_edge.getUpper();
+        return true;
+      }
+
+      /** \brief Return a new copy of the current ISequence subclass.
+      */
+      virtual ISequence * clone() const { return new LogSequence(*this); }
+  };
+
 }
 
 #endif
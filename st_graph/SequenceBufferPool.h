@@ -0,0 +1,79 @@
+/** \file SequenceBufferPool.h
+    \brief Declaration of SequenceBufferPool class.
+*/
+#ifndef st_graph_SequenceBufferPool_h
+#define st_graph_SequenceBufferPool_h
+
+#include <deque>
+#include <vector>
+
+#include "st_graph/Sequence.h"
+
+namespace st_graph {
+
+  /** \class SequenceBufferPool
+      \brief Pool of column blocks and scratch buffers which frames use to extract data from sequences while
+             displaying plots. Blocks and buffers are handed out in turn, and all become available again when the pool
+             is reset at the start of each display. Because memory held by the pool is never released, redisplaying
+             plots whose sequences have not grown does not allocate memory while extracting data.
+  */
+  class SequenceBufferPool {
+    public:
+      SequenceBufferPool();
+
+      /** \brief Make every block and buffer available for reuse. All pointers previously obtained from the pool
+                 must be considered invalid afterwards.
+      */
+      void reset();
+
+      /// \brief Get a column block not already handed out since the last reset.
+      SequenceColumns & getColumns();
+
+      /// \brief Get a scratch buffer not already handed out since the last reset.
+      std::vector<double> & getBuffer();
+
+      /** \brief Build the vertices of a step curve (histogram outline) from a sequence of bins and their values. Each
+                 bin contributes two vertices, at its lower and upper bound. Bins which cannot be plotted, as recorded
+                 by the ValidityMask of x or y, are left out, and neither they nor the gaps between bins, as recorded
+                 by the GapMask of x, are drawn: one vertex whose coordinates are both NaN is placed at each break in
+                 the curve instead, so that backends which break lines at NaN draw the curve as a single line, and
+                 others may draw each run of vertices between breaks separately. Returns the number of vertices.
+          \param x The bins, interpreted as intervals.
+          \param y The value in each bin, with as many elements as x.
+          \param x_positive Whether bins whose value is not greater than 0 are left out, e.g. for a logarithmic axis.
+          \param y_positive Whether bins whose value in y is not greater than 0 are left out.
+          \param x_vals (Output) Address of the abscissae of the vertices, valid until the pool is reset.
+          \param y_vals (Output) Address of the ordinates of the vertices, valid until the pool is reset.
+      */
+      unsigned long createStepCurve(const ISequence & x, const ISequence & y, bool x_positive, bool y_positive,
+        const double * & x_vals, const double * & y_vals);
+
+      /** \brief Extract the values and spreads of the points of a scatter plot, leaving out the points which cannot
+                 be plotted, as recorded by the ValidityMask of each sequence, in bulk. The columns of both blocks
+                 hold the remaining points at their start, in order. Returns the number of points remaining.
+          \param x The abscissae of the points.
+          \param y The ordinates of the points, with as many elements as x.
+          \param x_positive Whether abscissae which are not greater than 0 are left out, e.g. for a logarithmic axis.
+          \param y_positive Whether ordinates which are not greater than 0 are left out.
+          \param x_columns (Output) The block holding the abscissae, valid until the pool is reset.
+          \param y_columns (Output) The block holding the ordinates, valid until the pool is reset.
+      */
+      unsigned long createScatterColumns(const ISequence & x, const ISequence & y, bool x_positive, bool y_positive,
+        const SequenceColumns * & x_columns, const SequenceColumns * & y_columns);
+
+      /// \brief Return the number of column blocks handed out since the last reset.
+      unsigned long getNumColumnsUsed() const;
+
+      /// \brief Return the number of scratch buffers handed out since the last reset.
+      unsigned long getNumBuffersUsed() const;
+
+    private:
+      std::deque<SequenceColumns> m_columns;
+      std::deque<std::vector<double> > m_buffers;
+      unsigned long m_num_columns_used;
+      unsigned long m_num_buffers_used;
+  };
+
+}
+
+#endif
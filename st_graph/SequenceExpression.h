@@ -0,0 +1,355 @@
+/** \file SequenceExpression.h
+    \brief Declaration of lazy arithmetic expressions over sequences, with propagation of spreads.
+*/
+#ifndef st_graph_SequenceExpression_h
+#define st_graph_SequenceExpression_h
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "st_graph/Sequence.h"
+
+namespace st_graph {
+
+  /** \class SequenceExpression
+      \brief Base class for lazy arithmetic expressions over sequences, such as background-subtracted counts or rates.
+             An expression holds clones of its operands and computes nothing until its properties are extracted.
+             Elements are then evaluated in small blocks, each of which passes through the whole expression at once,
+             so no array the size of the sequence is created for any intermediate result. The only exception is an
+             operand which cannot compute ranges efficiently (see ISequence::hasEfficientRanges), which is extracted
+             once for each range instead of once per block.
+
+             Each element has a value and lower and upper spreads, which are propagated from the spreads of the
+             operands to first order, treating the operands as independent. The bounds of an element are its value
+             minus/plus its spreads, as in a ValueSpreadSequence.
+  */
+  class SequenceExpression : public ISequence {
+    public:
+      /** \brief Fill the output container with the values of the sequence.
+          \param val The output container.
+      */
+      virtual void getValues(std::vector<double> & val) const {
+        val.resize(size());
+        if (!val.empty()) getRange(0, size(), &val[0], 0, 0, 0, 0);
+      }
+
+      /** \brief Fill the output containers with the upper and lower bounds of each element in the sequence.
+          \param lower The lower bounds of the sequence elements.
+          \param upper The upper bounds of the sequence elements.
+      */
+      virtual void getIntervals(std::vector<double> & lower, std::vector<double> & upper) const {
+        lower.resize(size());
+        upper.resize(size());
+        if (!lower.empty()) getRange(0, size(), 0, &lower[0], &upper[0], 0, 0);
+      }
+
+      /** \brief Fill the output containers with the upper and lower spreads of each element in the sequence.
+          \param lower The lower spreads of the sequence elements.
+          \param upper The upper spreads of the sequence elements.
+      */
+      virtual void getSpreads(std::vector<double> & lower, std::vector<double> & upper) const {
+        lower.resize(size());
+        upper.resize(size());
+        if (!lower.empty()) getRange(0, size(), 0, 0, 0, &lower[0], &upper[0]);
+      }
+
+      /** \brief Fill the requested columns of a structure-of-arrays block in a single pass over the expression.
+          \param mask Bitwise combination of SequenceColumns::Column_e values selecting the columns to fill.
+          \param columns The output block.
+      */
+      virtual void getColumns(unsigned int mask, SequenceColumns & columns) const {
+        getColumnRange(mask, 0, size(), columns);
+      }
+
+      /// \brief Return true if every operand computes ranges efficiently, in which case the expression does too.
+      virtual bool hasEfficientRanges() const {
+        for (int ii = 0; ii != getNumOperands(); ++ii) if (!getOperand(ii).hasEfficientRanges()) return false;
+        return true;
+      }
+
+      /// \brief Return true if the data read by every operand cannot change, in which case the expression's cannot.
+      virtual bool hasFixedData() const {
+        for (int ii = 0; ii != getNumOperands(); ++ii) if (!getOperand(ii).hasFixedData()) return false;
+        return true;
+      }
+
+    protected:
+      /// \brief The largest number of elements evaluated at a time.
+      static const size_type s_block_size = 256;
+
+      /// \brief The largest number of operands of an expression.
+      static const int s_max_operands = 2;
+
+      SequenceExpression(size_type num_points): ISequence(num_points) {}
+
+      /// \brief Return the number of operands of the expression, no more than s_max_operands.
+      virtual int getNumOperands() const = 0;
+
+      /** \brief Return one operand of the expression.
+          \param index The index of the operand, less than getNumOperands().
+      */
+      virtual const ISequence & getOperand(int index) const = 0;
+
+      /** \brief Compute the values and spreads of a block of elements from those of the same elements of each
+                 operand. Implemented by each kind of expression.
+          \param count The number of elements in the block, no more than s_block_size.
+          \param operand_value The values of the elements of each operand.
+          \param operand_low The lower spreads of the elements of each operand.
+          \param operand_high The upper spreads of the elements of each operand.
+          \param value The output values.
+          \param low_spread The output lower spreads.
+          \param high_spread The output upper spreads.
+      */
+      virtual void evaluate(size_type count, const double * const * operand_value, const double * const * operand_low,
+        const double * const * operand_high, double * value, double * low_spread, double * high_spread) const = 0;
+
+      virtual void fillRange(size_type offset, size_type count, double * out_val, double * out_low, double * out_high,
+        double * out_low_spread, double * out_high_spread) const;
+  };
+
+  inline void SequenceExpression::fillRange(size_type offset, size_type count, double * out_val, double * out_low,
+    double * out_high, double * out_low_spread, double * out_high_spread) const {
+    // Operands which compute ranges efficiently are read a block at a time. The others would extract their whole
+    // sequence for every block, so they are read once for the whole range.
+    const int num_operands = getNumOperands();
+    std::vector<double> whole[s_max_operands][3];
+    for (int op = 0; op != num_operands; ++op) {
+      if (0 == count || getOperand(op).hasEfficientRanges()) continue;
+      for (int ii = 0; ii != 3; ++ii) whole[op][ii].resize(count);
+      getOperand(op).getRange(offset, count, &whole[op][0][0], 0, 0, &whole[op][1][0], &whole[op][2][0]);
+    }
+
+    double operand_block[s_max_operands][3][s_block_size];
+    double value[s_block_size];
+    double low_spread[s_block_size];
+    double high_spread[s_block_size];
+    for (size_type done = 0; done != count; ) {
+      size_type num_elements = count - done;
+      if (s_block_size < num_elements) num_elements = s_block_size;
+      const double * operand[3][s_max_operands];
+      for (int op = 0; op != num_operands; ++op) {
+        if (whole[op][0].empty()) {
+          getOperand(op).getRange(offset + done, num_elements, operand_block[op][0], 0, 0, operand_block[op][1],
+            operand_block[op][2]);
+          for (int ii = 0; ii != 3; ++ii) operand[ii][op] = operand_block[op][ii];
+        } else {
+          for (int ii = 0; ii != 3; ++ii) operand[ii][op] = &whole[op][ii][done];
+        }
+      }
+      evaluate(num_elements, operand[0], operand[1], operand[2], value, low_spread, high_spread);
+      for (size_type ii = 0, jj = done; ii != num_elements; ++ii, ++jj) {
+        if (0 != out_val) out_val[jj] = value[ii];
+        if (0 != out_low) out_low[jj] = value[ii] - low_spread[ii];
+        if (0 != out_high) out_high[jj] = value[ii] + high_spread[ii];
+        if (0 != out_low_spread) out_low_spread[jj] = low_spread[ii];
+        if (0 != out_high_spread) out_high_spread[jj] = high_spread[ii];
+      }
+      done += num_elements;
+    }
+  }
+
+  /** \class ScaledSequence
+      \brief The expression a * x + b for a sequence x and constants a and b. Spreads are scaled by |a|; when a is
+             negative, the lower and upper spreads of x exchange roles. Scaling a ScaledSequence again is folded into
+             a single expression over the original sequence.
+  */
+  class ScaledSequence : public SequenceExpression {
+    public:
+      /** \brief Create the expression a * x + b.
+          \param x The sequence.
+          \param a The factor.
+          \param b The offset.
+      */
+      ScaledSequence(const ISequence & x, double a, double b);
+
+      /// \brief Return the factor.
+      double getFactor() const { return m_factor; }
+
+      /// \brief Return the offset.
+      double getOffset() const { return m_offset; }
+
+      /** \brief Return a new copy of the current ISequence subclass.
+      */
+      virtual ISequence * clone() const { return new ScaledSequence(*this); }
+
+    protected:
+      virtual int getNumOperands() const { return 1; }
+
+      virtual const ISequence & getOperand(int) const { return *m_x; }
+
+      virtual void evaluate(size_type count, const double * const * operand_value, const double * const * operand_low,
+        const double * const * operand_high, double * value, double * low_spread, double * high_spread) const;
+
+    private:
+      std::shared_ptr<const ISequence> m_x;
+      double m_factor;
+      double m_offset;
+  };
+
+  inline ScaledSequence::ScaledSequence(const ISequence & x, double a, double b): SequenceExpression(x.size()), m_x(),
+    m_factor(a), m_offset(b) {
+    const ScaledSequence * scaled = dynamic_cast<const ScaledSequence *>(&x);
+    if (0 != scaled) {
+      // a * (a' * x' + b') + b == (a * a') * x' + (a * b' + b).
+      m_x = scaled->m_x;
+      m_factor = a * scaled->m_factor;
+      m_offset = a * scaled->m_offset + b;
+    } else {
+      m_x.reset(x.clone());
+    }
+  }
+
+  inline void ScaledSequence::evaluate(size_type count, const double * const * operand_value,
+    const double * const * operand_low, const double * const * operand_high, double * value, double * low_spread,
+    double * high_spread) const {
+    double factor = std::fabs(m_factor);
+    for (size_type ii = 0; ii != count; ++ii) {
+      value[ii] = m_factor * operand_value[0][ii] + m_offset;
+      double low = factor * operand_low[0][ii];
+      double high = factor * operand_high[0][ii];
+      low_spread[ii] = 0. > m_factor ? high : low;
+      high_spread[ii] = 0. > m_factor ? low : high;
+    }
+  }
+
+  /** \class AddOperation
+      \brief Value and partial derivatives of x + y, for BinarySequence.
+  */
+  struct AddOperation {
+    static double value(double x, double y) { return x + y; }
+    static double derivativeX(double, double) { return 1.; }
+    static double derivativeY(double, double) { return 1.; }
+  };
+
+  /** \class SubtractOperation
+      \brief Value and partial derivatives of x - y, for BinarySequence.
+  */
+  struct SubtractOperation {
+    static double value(double x, double y) { return x - y; }
+    static double derivativeX(double, double) { return 1.; }
+    static double derivativeY(double, double) { return -1.; }
+  };
+
+  /** \class MultiplyOperation
+      \brief Value and partial derivatives of x * y, for BinarySequence.
+  */
+  struct MultiplyOperation {
+    static double value(double x, double y) { return x * y; }
+    static double derivativeX(double, double y) { return y; }
+    static double derivativeY(double x, double) { return x; }
+  };
+
+  /** \class DivideOperation
+      \brief Value and partial derivatives of x / y, for BinarySequence.
+  */
+  struct DivideOperation {
+    static double value(double x, double y) { return x / y; }
+    static double derivativeX(double, double y) { return 1. / y; }
+    static double derivativeY(double x, double y) { return -x / (y * y); }
+  };
+
+  /** \class BinarySequence
+      \brief The element-wise combination of two sequences of the same size by an arithmetic operation, given by
+             Op_t. The spreads of the result are the first-order propagated spreads of the operands, added in
+             quadrature: each operand contributes its spread times the magnitude of the partial derivative of the
+             operation, taking its upper spread towards the upper spread of the result where the derivative is
+             positive, and towards the lower spread where the derivative is negative.
+  */
+  template <typename Op_t>
+  class BinarySequence : public SequenceExpression {
+    public:
+      /** \brief Create the expression combining x and y, which must have the same size.
+          \param x The first operand.
+          \param y The second operand.
+      */
+      BinarySequence(const ISequence & x, const ISequence & y): SequenceExpression(x.size()), m_x(x.clone()),
+        m_y(y.clone()) {
+        if (x.size() != y.size()) throw std::logic_error("BinarySequence: operands do not have the same size");
+      }
+
+      /** \brief Return a new copy of the current ISequence subclass.
+      */
+      virtual ISequence * clone() const { return new BinarySequence(*this); }
+
+    protected:
+      virtual int getNumOperands() const { return 2; }
+
+      virtual const ISequence & getOperand(int index) const { return 0 == index ? *m_x : *m_y; }
+
+      virtual void evaluate(size_type count, const double * const * operand_value, const double * const * operand_low,
+        const double * const * operand_high, double * value, double * low_spread, double * high_spread) const;
+
+    private:
+      std::shared_ptr<const ISequence> m_x;
+      std::shared_ptr<const ISequence> m_y;
+  };
+
+  template <typename Op_t>
+  inline void BinarySequence<Op_t>::evaluate(size_type count, const double * const * operand_value,
+    const double * const * operand_low, const double * const * operand_high, double * value, double * low_spread,
+    double * high_spread) const {
+    const double * x_low = operand_low[0];
+    const double * x_high = operand_high[0];
+    const double * y_low = operand_low[1];
+    const double * y_high = operand_high[1];
+    for (size_type ii = 0; ii != count; ++ii) {
+      double x = operand_value[0][ii];
+      double y = operand_value[1][ii];
+      double dx = Op_t::derivativeX(x, y);
+      double dy = Op_t::derivativeY(x, y);
+      double x_to_low = std::fabs(dx) * (0. > dx ? x_high[ii] : x_low[ii]);
+      double x_to_high = std::fabs(dx) * (0. > dx ? x_low[ii] : x_high[ii]);
+      double y_to_low = std::fabs(dy) * (0. > dy ? y_high[ii] : y_low[ii]);
+      double y_to_high = std::fabs(dy) * (0. > dy ? y_low[ii] : y_high[ii]);
+      value[ii] = Op_t::value(x, y);
+      low_spread[ii] = std::sqrt(x_to_low * x_to_low + y_to_low * y_to_low);
+      high_spread[ii] = std::sqrt(x_to_high * x_to_high + y_to_high * y_to_high);
+    }
+  }
+
+  typedef BinarySequence<AddOperation> SumSequence;
+  typedef BinarySequence<SubtractOperation> DifferenceSequence;
+  typedef BinarySequence<MultiplyOperation> ProductSequence;
+  typedef BinarySequence<DivideOperation> RatioSequence;
+
+  /// \brief Return the lazy element-wise sum of two sequences.
+  inline SumSequence operator +(const ISequence & x, const ISequence & y) { return SumSequence(x, y); }
+
+  /// \brief Return the lazy element-wise difference of two sequences.
+  inline DifferenceSequence operator -(const ISequence & x, const ISequence & y) { return DifferenceSequence(x, y); }
+
+  /// \brief Return the lazy element-wise product of two sequences.
+  inline ProductSequence operator *(const ISequence & x, const ISequence & y) { return ProductSequence(x, y); }
+
+  /// \brief Return the lazy element-wise ratio of two sequences.
+  inline RatioSequence operator /(const ISequence & x, const ISequence & y) { return RatioSequence(x, y); }
+
+  /// \brief Return the lazy expression a * x.
+  inline ScaledSequence operator *(double a, const ISequence & x) { return ScaledSequence(x, a, 0.); }
+
+  /// \brief Return the lazy expression x * a.
+  inline ScaledSequence operator *(const ISequence & x, double a) { return ScaledSequence(x, a, 0.); }
+
+  /// \brief Return the lazy expression x / a.
+  inline ScaledSequence operator /(const ISequence & x, double a) { return ScaledSequence(x, 1. / a, 0.); }
+
+  /// \brief Return the lazy expression x + b.
+  inline ScaledSequence operator +(const ISequence & x, double b) { return ScaledSequence(x, 1., b); }
+
+  /// \brief Return the lazy expression b + x.
+  inline ScaledSequence operator +(double b, const ISequence & x) { return ScaledSequence(x, 1., b); }
+
+  /// \brief Return the lazy expression x - b.
+  inline ScaledSequence operator -(const ISequence & x, double b) { return ScaledSequence(x, 1., -b); }
+
+  /// \brief Return the lazy expression b - x.
+  inline ScaledSequence operator -(double b, const ISequence & x) { return ScaledSequence(x, -1., b); }
+
+  /// \brief Return the lazy expression -x.
+  inline ScaledSequence operator -(const ISequence & x) { return ScaledSequence(x, -1., 0.); }
+
+}
+
+#endif
@@ -0,0 +1,104 @@
+/** \file SimdKernel.h
+    \brief Declaration of explicitly vectorized kernels used by the sequence templates for contiguous data.
+*/
+#ifndef st_graph_SimdKernel_h
+#define st_graph_SimdKernel_h
+
+namespace st_graph {
+
+  /** \class SimdKernel
+      \brief Explicitly vectorized (SSE2/AVX2) computation of the neighbor-midpoint properties of ValueSequence and
+             LowerBoundSequence over contiguous arrays of doubles, of the gaps between intervals, of elements which
+             cannot be plotted, and of the ranges and orderings of blocks of elements. The instruction set is chosen
+             at run time from those supported by the processor. Results are bit-for-bit identical to the scalar
+             formulas in ValueKernel and LowerBoundKernel.
+  */
+  class SimdKernel {
+    public:
+      /// \brief The properties which may be computed.
+      enum Operation_e { eValueBounds, eValueSpreads, eLowerBoundBounds, eLowerBoundSpreads };
+
+      /// \brief Instruction sets, in increasing order of preference.
+      enum InstructionSet_e { eScalar, eSse2, eAvx2, eBest };
+
+      /** \brief Compute the lower and upper properties of the interior elements of an array, i.e. all elements
+                 except the first and the last, which need extrapolated neighbors and are left untouched.
+          \param op The property to compute.
+          \param in The input array.
+          \param size The number of elements in the input array.
+          \param lower Output array for the lower bounds/spreads, with at least size elements.
+          \param upper Output array for the upper bounds/spreads, with at least size elements.
+          \param iset The most capable instruction set to use. The best one supported by the processor is used if
+                 the requested one is not available.
+      */
+      static void computeInterior(Operation_e op, const double * in, unsigned long size, double * lower, double * upper,
+        InstructionSet_e iset = eBest);
+
+      /** \brief Find the gaps between adjacent intervals, i.e. the elements whose upper bound is less than the lower
+                 bound of the next element, and record them as a bit mask. Returns the number of gaps.
+          \param lower The lower bounds of the intervals.
+          \param upper The upper bounds of the intervals.
+          \param size The number of intervals.
+          \param mask Output array of (size + 63) / 64 words. Bit ii % 64 of word ii / 64 is set if there is a gap
+                 after interval ii; all other bits are cleared.
+          \param iset The most capable instruction set to use, as for computeInterior.
+      */
+      static unsigned long findGaps(const double * lower, const double * upper, unsigned long size,
+        unsigned long long * mask, InstructionSet_e iset = eBest);
+
+      /** \brief Find the elements of an array which are not finite, or, optionally, not greater than 0, and set
+                 their bits in a mask. Bits of the other elements are left unchanged, so that the invalid elements of
+                 several arrays may be collected in one mask. Only the bit patterns of the elements are examined, so
+                 no floating point exceptions are raised.
+          \param data The array.
+          \param size The number of elements in the array.
+          \param positive Whether elements which are not greater than 0 are also invalid.
+          \param mask Array of (size + 63) / 64 words, in which bit ii % 64 of word ii / 64 is set if element ii is invalid.
+          \param iset The most capable instruction set to use, as for computeInterior.
+      */
+      static void findInvalid(const double * data, unsigned long size, bool positive, unsigned long long * mask,
+        InstructionSet_e iset = eBest);
+
+      /** \struct Summary
+          \brief Ranges and orderings of a block of elements whose values and bounds are all finite.
+      */
+      struct Summary {
+        double m_min_value;
+        double m_max_value;
+        double m_min_positive_value;
+        double m_min_lower;
+        double m_max_upper;
+        double m_min_positive_lower;
+        bool m_non_decreasing;
+        bool m_non_increasing;
+        bool m_ordered_bins;
+      };
+
+      /** \brief Summarize a block of elements as described for SequenceStatistics, comparing each element with the one
+                 before it in the block. Returns false, leaving the summary unchanged, if any value or bound is not
+                 finite. Only the bit patterns of the elements are examined for this test, so no floating point
+                 exceptions are raised. Results are the same for all instruction sets, except that the sign of an
+                 extremum equal to 0 may differ.
+          \param value The values of the elements.
+          \param lower The lower bounds of the elements.
+          \param upper The upper bounds of the elements.
+          \param size The number of elements, which must be at least 1.
+          \param summary The output summary.
+          \param iset The most capable instruction set to use, as for computeInterior.
+      */
+      static bool summarizeFinite(const double * value, const double * lower, const double * upper, unsigned long size,
+        Summary & summary, InstructionSet_e iset = eBest);
+
+      /** \brief Return the most capable instruction set supported both by this build and by the processor.
+      */
+      static InstructionSet_e bestInstructionSet();
+
+      /** \brief Return the name of the given instruction set.
+          \param iset The instruction set.
+      */
+      static const char * getName(InstructionSet_e iset);
+  };
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+/** \file StridedSequence.h
+    \brief Declaration of StridedIterator and sequences which read one field of an array of structures in place.
+*/
+#ifndef st_graph_StridedSequence_h
+#define st_graph_StridedSequence_h
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "st_graph/Sequence.h"
+
+namespace st_graph {
+
+  /** \class StridedIterator
+      \brief Random-access iterator over values of type T separated by a constant number of bytes, e.g. one member
+             of every record in an array of structures. Each dereference also prefetches the value a fixed number of
+             strides ahead, so that sequences reading records in order do not wait for memory when records are larger
+             than a cache line and each value read touches a separate line.
+  */
+  template <typename T>
+  class StridedIterator {
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef T value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const T * pointer;
+      typedef const T & reference;
+
+      /// \brief Number of strides ahead of each dereference at which values are prefetched.
+      static const difference_type s_prefetch_distance = 16;
+
+      StridedIterator(): m_ptr(0), m_stride(sizeof(T)) {}
+
+      /** \brief Create an iterator pointing to the given value.
+          \param ptr The address of the value.
+          \param stride The distance in bytes between successive values, which must not be 0.
+      */
+      StridedIterator(const T * ptr, difference_type stride): m_ptr(reinterpret_cast<const char *>(ptr)),
+        m_stride(stride) {}
+
+      reference operator *() const {
+#ifdef __GNUC__
+        // Prefetching never faults, so the address may lie past the end of the records.
+        __builtin_prefetch(reinterpret_cast<const void *>(reinterpret_cast<std::uintptr_t>(m_ptr) +
+          s_prefetch_distance * m_stride));
+#endif
+        return *reinterpret_cast<const T *>(m_ptr);
+      }
+      pointer operator ->() const { return &**this; }
+      reference operator [](difference_type offset) const { return *(*this + offset); }
+
+      StridedIterator & operator ++() { m_ptr += m_stride; return *this; }
+      StridedIterator operator ++(int) { StridedIterator prev(*this); m_ptr += m_stride; return prev; }
+      StridedIterator & operator --() { m_ptr -= m_stride; return *this; }
+      StridedIterator operator --(int) { StridedIterator prev(*this); m_ptr -= m_stride; return prev; }
+      StridedIterator & operator +=(difference_type offset) { m_ptr += offset * m_stride; return *this; }
+      StridedIterator & operator -=(difference_type offset) { m_ptr -= offset * m_stride; return *this; }
+      StridedIterator operator +(difference_type offset) const { StridedIterator itor(*this); return itor += offset; }
+      StridedIterator operator -(difference_type offset) const { StridedIterator itor(*this); return itor -= offset; }
+      difference_type operator -(const StridedIterator & other) const { return (m_ptr - other.m_ptr) / m_stride; }
+
+      bool operator ==(const StridedIterator & other) const { return m_ptr == other.m_ptr; }
+      bool operator !=(const StridedIterator & other) const { return m_ptr != other.m_ptr; }
+      bool operator <(const StridedIterator & other) const { return (m_ptr < other.m_ptr) == (0 < m_stride); }
+      bool operator >(const StridedIterator & other) const { return other < *this; }
+      bool operator <=(const StridedIterator & other) const { return !(other < *this); }
+      bool operator >=(const StridedIterator & other) const { return !(*this < other); }
+
+      /// \brief Return the address of the value to which the iterator points, without prefetching.
+      const T * get() const { return reinterpret_cast<const T *>(m_ptr); }
+
+      /// \brief Return the distance in bytes between successive values.
+      difference_type getStride() const { return m_stride; }
+
+    private:
+      const char * m_ptr;
+      difference_type m_stride;
+  };
+
+  template <typename T>
+  inline StridedIterator<T> operator +(typename StridedIterator<T>::difference_type offset,
+    const StridedIterator<T> & itor) {
+    return itor + offset;
+  }
+
+  /** \brief Return an iterator pointing to the given member of the first record in an array of structures.
+      \param records The address of the first record.
+      \param member The member to iterate over.
+  */
+  template <typename Struct_t, typename T>
+  inline StridedIterator<T> makeStridedIterator(const Struct_t * records, T Struct_t::* member) {
+    return StridedIterator<T>(&(records->*member), sizeof(Struct_t));
+  }
+
+  /** \brief Fill a view of a range of strided doubles. The view is contiguous only if the stride is sizeof(double);
+             otherwise backends which accept strides may still read the doubles in place.
+      \param begin The first iterator in the range.
+      \param count The number of elements in the range.
+      \param view The output view.
+  */
+  inline bool makeDataView(const StridedIterator<double> & begin, unsigned long count, DataView & view) {
+    if (0 == count) return false;
+    view = DataView(begin.get(), begin.getStride());
+    return true;
+  }
+
+  /** \class StridedSequence
+      \brief A sequence which reads its elements in place from memory in which they are separated by a constant
+             number of bytes, typically one member of an array of event records, so that a column of the records may
+             be plotted without first copying it into a container of its own. Seq_t is one of the sequence templates
+             (PointSequence, ValueSequence, LowerBoundSequence, ValueSpreadSequence or IntervalSequence), which
+             determines how elements are interpreted; T is the type of the member. The sequence does not own the
+             records, which must outlive it and its clones.
+
+             Templates which read two ranges (ValueSpreadSequence and IntervalSequence) are constructed from two
+             members of the same records, e.g. the start and stop times of each record.
+  */
+  template <template <typename> class Seq_t, typename T = double>
+  class StridedSequence : public Seq_t<StridedIterator<T> > {
+    public:
+      typedef StridedIterator<T> Itor_t;
+      typedef typename Seq_t<Itor_t>::size_type size_type;
+
+      /** \brief Create a sequence spanning values separated by the given number of bytes.
+          \param first The address of the first value.
+          \param count The number of values.
+          \param stride The distance in bytes between successive values.
+      */
+      StridedSequence(const T * first, size_type count, std::ptrdiff_t stride):
+        Seq_t<Itor_t>(Itor_t(first, stride), Itor_t(first, stride) + count) {}
+
+      /** \brief Create a sequence spanning one member of an array of records.
+          \param records The address of the first record.
+          \param count The number of records.
+          \param member The member to read.
+      */
+      template <typename Struct_t>
+      StridedSequence(const Struct_t * records, size_type count, T Struct_t::* member):
+        Seq_t<Itor_t>(makeStridedIterator(records, member), makeStridedIterator(records, member) + count) {}
+
+      /** \brief Create a sequence spanning two members of an array of records, for templates which read two ranges.
+          \param records The address of the first record.
+          \param count The number of records.
+          \param first_member The member read as the first range, e.g. values or lower bounds.
+          \param second_member The member read as the second range, e.g. spreads or upper bounds.
+      */
+      template <typename Struct_t>
+      StridedSequence(const Struct_t * records, size_type count, T Struct_t::* first_member,
+        T Struct_t::* second_member): Seq_t<Itor_t>(makeStridedIterator(records, first_member),
+        makeStridedIterator(records, first_member) + count, makeStridedIterator(records, second_member)) {}
+
+      /** \brief Return a new copy of the current ISequence subclass.
+      */
+      virtual ISequence * clone() const { return new StridedSequence(*this); }
+  };
+
+  typedef StridedSequence<PointSequence> StridedPointSequence;
+  typedef StridedSequence<ValueSequence> StridedValueSequence;
+  typedef StridedSequence<LowerBoundSequence> StridedLowerBoundSequence;
+  typedef StridedSequence<ValueSpreadSequence> StridedValueSpreadSequence;
+  typedef StridedSequence<IntervalSequence> StridedIntervalSequence;
+
+}
+
+#endif
@@ -0,0 +1,88 @@
+/** \file ThreadPool.h
+    \brief Declaration of ThreadPool class.
+*/
+#ifndef st_graph_ThreadPool_h
+#define st_graph_ThreadPool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace st_graph {
+
+  /** \class ThreadPool
+      \brief A fixed set of worker threads which run numbered tasks in parallel. The caller of run hands over a
+             number of tasks and works on them together with the workers until all are done, so a pool with N
+             threads has N - 1 workers. Tasks are numbered by the caller, and which thread runs which task does not
+             matter, so clients which give each task a fixed, disjoint part of their work get results which do not
+             depend on the number of threads.
+
+             The pool shared by the whole library, returned by instance, starts its workers the first time it is used.
+             Only one call to run at a time is served by the workers. Calls made while the workers are busy, including
+             calls from inside a task, run their tasks serially in the calling thread instead of waiting.
+  */
+  class ThreadPool {
+    public:
+      typedef unsigned long size_type;
+
+      /** \class ITask
+          \brief Interface for the work handed to a ThreadPool. Tasks may be run concurrently in any order.
+      */
+      class ITask {
+        public:
+          virtual ~ITask() {}
+
+          /** \brief Perform one task.
+              \param index The number of the task, from 0 up to the number of tasks given to run.
+          */
+          virtual void operator ()(size_type index) const = 0;
+      };
+
+      /// \brief Return the pool shared by the library, with one thread per processor.
+      static ThreadPool & instance();
+
+      /** \brief Create a pool with the given number of threads, including the calling thread of run.
+          \param num_threads The number of threads. 0 is treated as 1, i.e. no workers.
+      */
+      explicit ThreadPool(unsigned int num_threads);
+
+      ~ThreadPool();
+
+      /// \brief Return the number of threads which work on the tasks of a call to run, including the calling thread.
+      unsigned int getNumThreads() const { return m_workers.size() + 1; }
+
+      /** \brief Perform tasks 0 through num_tasks - 1 and return when all are done. If any task throws, tasks not
+                 yet started are skipped, and the first exception is rethrown once the running tasks are done.
+          \param num_tasks The number of tasks.
+          \param task The task to perform.
+      */
+      void run(size_type num_tasks, const ITask & task);
+
+    private:
+      // Pools own their threads, and are never copied.
+      ThreadPool(const ThreadPool &);
+      ThreadPool & operator =(const ThreadPool &);
+
+      void workerLoop();
+      void work();
+
+      std::vector<std::thread> m_workers;
+      std::mutex m_run_mutex;
+      std::mutex m_mutex;
+      std::condition_variable m_start;
+      std::condition_variable m_done;
+      const ITask * m_task;
+      size_type m_num_tasks;
+      std::atomic<size_type> m_next_task;
+      std::exception_ptr m_error;
+      unsigned long m_generation;
+      unsigned int m_num_busy;
+      bool m_stop;
+  };
+
+}
+
+#endif
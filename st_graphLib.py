@@ -5,6 +5,9 @@ def generate(env, **kw):
     env.Tool('st_streamLib')
     env.Tool('hoopsLib')
     env.Tool('embed_pythonLib')
+    env.Tool('addLibrary', library = env['cfitsioLibs'])
+    if env['PLATFORM'] == 'posix':
+        env.Tool('addLibrary', library = ['pthread'])
     if env.get('CONTAINERNAME', '') != 'ScienceTools_User':
         env.Tool('addLibrary', library = env['rootLibs'])
         env.Tool('addLibrary', library = env['rootGuiLibs'])